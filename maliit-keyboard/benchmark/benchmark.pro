@@ -1,16 +1,8 @@
-include(../config.pri)
-
-TOP_BUILDDIR = $${OUT_PWD}/../..
-TEMPLATE = app
-TARGET = maliit-keyboard-benchmark
-target.path = $$INSTALL_BIN
-
-INCLUDEPATH += ../lib
-LIBS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
-PRE_TARGETDEPS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
-SOURCES += main.cpp
-
-QT = core
-INSTALLS += target
-
-include(../word-prediction.pri)
+TEMPLATE = subdirs
+SUBDIRS = \
+    common \
+    layout-switching \
+    word-engine \
+    session-replay \
+
+CONFIG += ordered
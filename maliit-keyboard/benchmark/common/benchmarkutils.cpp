@@ -0,0 +1,257 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "benchmarkutils.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace BenchmarkUtils {
+
+namespace {
+
+QByteArray quoted(const QString &string)
+{
+    QByteArray result("\"");
+
+    Q_FOREACH (const QChar &c, string) {
+        switch (c.unicode()) {
+        case '"':  result.append("\\\""); break;
+        case '\\': result.append("\\\\"); break;
+        case '\n': result.append("\\n"); break;
+        case '\r': result.append("\\r"); break;
+        case '\t': result.append("\\t"); break;
+        default:
+            if (c.unicode() < 0x20) {
+                result.append(QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0')).toLatin1());
+            } else {
+                result.append(QString(c).toUtf8());
+            }
+        }
+    }
+
+    return result.append('"');
+}
+
+void appendJson(QByteArray *out,
+                const QVariant &value,
+                int indent)
+{
+    const QByteArray padding(indent * 2, ' ');
+    const QByteArray inner_padding((indent + 1) * 2, ' ');
+
+    switch (value.type()) {
+    case QVariant::Map: {
+        const QVariantMap map(value.toMap());
+        if (map.isEmpty()) {
+            out->append("{}");
+            break;
+        }
+
+        out->append("{\n");
+        for (QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+            if (it != map.constBegin()) {
+                out->append(",\n");
+            }
+            out->append(inner_padding).append(quoted(it.key())).append(": ");
+            appendJson(out, it.value(), indent + 1);
+        }
+        out->append('\n').append(padding).append('}');
+    } break;
+
+    case QVariant::List:
+    case QVariant::StringList: {
+        const QVariantList list(value.toList());
+        if (list.isEmpty()) {
+            out->append("[]");
+            break;
+        }
+
+        out->append("[\n");
+        for (int index = 0; index < list.count(); ++index) {
+            if (index > 0) {
+                out->append(",\n");
+            }
+            out->append(inner_padding);
+            appendJson(out, list.at(index), indent + 1);
+        }
+        out->append('\n').append(padding).append(']');
+    } break;
+
+    case QVariant::Bool:
+        out->append(value.toBool() ? "true" : "false");
+        break;
+
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        out->append(QByteArray::number(value.toLongLong()));
+        break;
+
+    case QVariant::Double:
+        out->append(QByteArray::number(value.toDouble(), 'f', 3));
+        break;
+
+    case QVariant::Invalid:
+        out->append("null");
+        break;
+
+    default:
+        out->append(quoted(value.toString()));
+        break;
+    }
+}
+
+} // unnamed namespace
+
+qint64 percentile(const QVector<qint64> &sorted_samples,
+                  qreal fraction)
+{
+    if (sorted_samples.isEmpty()) {
+        return 0;
+    }
+
+    const int rank(qCeil(qBound<qreal>(0, fraction, 1) * sorted_samples.count()));
+    return sorted_samples.at(qBound(0, rank - 1, sorted_samples.count() - 1));
+}
+
+QVariantMap latencySummary(const QVector<qint64> &samples_ns)
+{
+    QVector<qint64> sorted(samples_ns);
+    std::sort(sorted.begin(), sorted.end());
+
+    qint64 total(0);
+    Q_FOREACH (qint64 sample, sorted) {
+        total += sample;
+    }
+
+    QVariantMap summary;
+    summary.insert("samples", sorted.count());
+    summary.insert("p50_us", percentile(sorted, 0.50) / 1000.0);
+    summary.insert("p95_us", percentile(sorted, 0.95) / 1000.0);
+    summary.insert("p99_us", percentile(sorted, 0.99) / 1000.0);
+    summary.insert("max_us", (sorted.isEmpty() ? 0 : sorted.last()) / 1000.0);
+    summary.insert("mean_us", (sorted.isEmpty() ? 0 : total / sorted.count()) / 1000.0);
+
+    return summary;
+}
+
+qint64 peakResidentSetSize()
+{
+    // VmHWM is more precise than ru_maxrss, and can be reset:
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly)) {
+        Q_FOREACH (const QByteArray &line, status.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return usage.ru_maxrss;
+    }
+#endif
+
+    return -1;
+}
+
+void resetPeakResidentSetSize()
+{
+    QFile clear_refs("/proc/self/clear_refs");
+    if (clear_refs.open(QIODevice::WriteOnly)) {
+        clear_refs.write("5");
+    }
+}
+
+QByteArray toJson(const QVariant &value)
+{
+    QByteArray result;
+    appendJson(&result, value, 0);
+    return result.append('\n');
+}
+
+QString argumentValue(const QStringList &arguments,
+                      const QString &name,
+                      const QString &default_value)
+{
+    const int index(arguments.indexOf(name));
+    return (index >= 0 && index + 1 < arguments.count()) ? arguments.at(index + 1)
+                                                         : default_value;
+}
+
+bool writeOutput(const QString &file_name,
+                 const QByteArray &data)
+{
+    if (file_name.isEmpty()) {
+        return (std::fwrite(data.constData(), 1, data.size(), stdout) == static_cast<size_t>(data.size()));
+    }
+
+    QFile output(file_name);
+    if (not output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not write report:" << file_name;
+        return false;
+    }
+
+    return (output.write(data) == data.size());
+}
+
+QVariant readJson(const QString &file_name)
+{
+#if QT_VERSION >= 0x050000
+    QFile input(file_name);
+    if (not input.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not read:" << file_name;
+        return QVariant();
+    }
+
+    QJsonParseError error;
+    const QJsonDocument document(QJsonDocument::fromJson(input.readAll(), &error));
+    if (error.error != QJsonParseError::NoError) {
+        qWarning() << "Could not parse:" << file_name << error.errorString();
+        return QVariant();
+    }
+
+    return document.toVariant();
+#else
+    qWarning() << "Reading JSON requires Qt 5:" << file_name;
+    return QVariant();
+#endif
+}
+
+} // namespace BenchmarkUtils
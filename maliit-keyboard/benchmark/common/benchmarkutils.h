@@ -0,0 +1,73 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_BENCHMARKUTILS_H
+#define MALIIT_KEYBOARD_BENCHMARKUTILS_H
+
+#include <QtCore>
+
+namespace BenchmarkUtils {
+
+// Nearest-rank percentile of already sorted samples, fraction in [0, 1].
+qint64 percentile(const QVector<qint64> &sorted_samples,
+                  qreal fraction);
+
+// Returns p50, p95, p99, max and mean (in microseconds) of nanosecond samples.
+QVariantMap latencySummary(const QVector<qint64> &samples_ns);
+
+// Peak resident set size of this process, in kB. Returns -1 if unknown.
+qint64 peakResidentSetSize();
+
+// Resets the peak resident set size to the current one, where supported
+// (Linux >= 4.0). Allows measuring peak RSS of consecutive runs.
+void resetPeakResidentSetSize();
+
+// Serializes maps, lists, strings, numbers and booleans as JSON. Works
+// without QJsonDocument, which is not available for Qt 4.
+QByteArray toJson(const QVariant &value);
+
+// Returns the argument following name, e.g. FILE for "--output FILE", or
+// default_value if name was not given.
+QString argumentValue(const QStringList &arguments,
+                      const QString &name,
+                      const QString &default_value);
+
+// Writes data to the file, or to stdout if file_name is empty.
+bool writeOutput(const QString &file_name,
+                 const QByteArray &data);
+
+// Reads a JSON document, e.g. a previous report. Returns an invalid
+// QVariant on errors, and always with Qt 4.
+QVariant readJson(const QString &file_name);
+
+} // namespace BenchmarkUtils
+
+#endif // MALIIT_KEYBOARD_BENCHMARKUTILS_H
@@ -0,0 +1,4 @@
+# to be included by benchmark applications
+LIBS += ../common/$$maliitStaticLib(benchmark-common)
+POST_TARGETDEPS += ../common/$$maliitStaticLib(benchmark-common)
+INCLUDEPATH += ../common
@@ -0,0 +1,12 @@
+include(../../config.pri)
+
+TARGET = benchmark-common
+TEMPLATE = lib
+CONFIG += staticlib
+QT = core
+
+SOURCES += \
+    benchmarkutils.cpp \
+
+HEADERS += \
+    benchmarkutils.h \
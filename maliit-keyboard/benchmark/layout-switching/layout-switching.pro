@@ -0,0 +1,21 @@
+include(../../config.pri)
+include(../../config-plugin.pri)
+include(../common/common.pri)
+include(../../tests/common/allocationhooks.pri)
+
+TOP_BUILDDIR = $${OUT_PWD}/../../..
+TEMPLATE = app
+TARGET = maliit-keyboard-benchmark
+target.path = $$INSTALL_BIN
+
+DEFINES += MALIIT_DEFAULT_PROFILE=\\\"$$MALIIT_DEFAULT_PROFILE\\\"
+
+INCLUDEPATH += ../../lib
+LIBS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+PRE_TARGETDEPS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+SOURCES += main.cpp
+
+QT = core
+INSTALLS += target
+
+include(../../word-prediction.pri)
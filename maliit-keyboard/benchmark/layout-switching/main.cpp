@@ -0,0 +1,520 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: Mohammad Anwari <Mohammad.Anwari@nokia.com>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Times each stage of the layout pipeline separately, for every language
+// layout: parsing the layout file, converting tag trees into keyboards
+// (every KeyboardLoader variant), applying a style profile to them (every
+// KeyAreaConverter variant, in both orientations) and feeding the result
+// into the QML model. Reports latency percentiles and allocations per
+// stage as JSON. With --baseline, a previous report is compared against,
+// and the exit code is 2 if any stage's p95 regressed by more than
+// --threshold percent.
+//
+// Usage: maliit-keyboard-benchmark [--profile NAME] [--layouts ID,...]
+//                                  [--rounds N] [--output FILE]
+//                                  [--baseline FILE] [--threshold PERCENT]
+
+#include "benchmarkutils.h"
+#include "allocationhooks.h"
+
+#include "logic/keyboardloader.h"
+#include "logic/keyboardrepository.h"
+#include "logic/keyareaconverter.h"
+#include "logic/style.h"
+#include "models/layout.h"
+#include "parser/layoutparser.h"
+
+#include <QtCore>
+#include <QCoreApplication>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+enum Variant {
+    VariantMain,
+    VariantNext,
+    VariantPrevious,
+    VariantShifted,
+    VariantSymbols0,
+    VariantSymbols1,
+    VariantDead,
+    VariantShiftedDead,
+    VariantExtended,
+    VariantNumber,
+    VariantPhoneNumber,
+    VariantCount
+};
+
+const char *const VariantNames[VariantCount] = {
+    "main",
+    "next",
+    "previous",
+    "shifted",
+    "symbols0",
+    "symbols1",
+    "dead",
+    "shifted_dead",
+    "extended",
+    "number",
+    "phone_number"
+};
+
+//! Keys some variants are derived from, taken from the main keyboard.
+struct SourceKeys
+{
+    Key dead;
+    Key extended;
+    bool has_dead;
+    bool has_extended;
+
+    explicit SourceKeys(const Keyboard &keyboard)
+        : dead()
+        , extended()
+        , has_dead(false)
+        , has_extended(false)
+    {
+        Q_FOREACH (const Key &key, keyboard.keys) {
+            if (not has_dead && key.action() == Key::ActionDead) {
+                dead = key;
+                has_dead = true;
+            }
+
+            if (not has_extended && key.hasExtendedKeys()) {
+                extended = key;
+                has_extended = true;
+            }
+        }
+    }
+
+    bool supports(Variant variant) const
+    {
+        switch (variant) {
+        case VariantDead:
+        case VariantShiftedDead:
+            return has_dead;
+
+        case VariantExtended:
+            return has_extended;
+
+        default:
+            return true;
+        }
+    }
+};
+
+Keyboard loadVariant(const KeyboardLoader &loader,
+                     Variant variant,
+                     const SourceKeys &keys)
+{
+    switch (variant) {
+    case VariantMain: return loader.keyboard();
+    case VariantNext: return loader.nextKeyboard();
+    case VariantPrevious: return loader.previousKeyboard();
+    case VariantShifted: return loader.shiftedKeyboard();
+    case VariantSymbols0: return loader.symbolsKeyboard(0);
+    case VariantSymbols1: return loader.symbolsKeyboard(1);
+    case VariantDead: return loader.deadKeyboard(keys.dead);
+    case VariantShiftedDead: return loader.shiftedDeadKeyboard(keys.dead);
+    case VariantExtended: return loader.extendedKeyboard(keys.extended);
+    case VariantNumber: return loader.numberKeyboard();
+    case VariantPhoneNumber: return loader.phoneNumberKeyboard();
+    case VariantCount: break;
+    }
+
+    return Keyboard();
+}
+
+KeyArea convertVariant(const Logic::KeyAreaConverter &converter,
+                       Variant variant,
+                       const SourceKeys &keys)
+{
+    switch (variant) {
+    case VariantMain: return converter.keyArea();
+    case VariantNext: return converter.nextKeyArea();
+    case VariantPrevious: return converter.previousKeyArea();
+    case VariantShifted: return converter.shiftedKeyArea();
+    case VariantSymbols0: return converter.symbolsKeyArea(0);
+    case VariantSymbols1: return converter.symbolsKeyArea(1);
+    case VariantDead: return converter.deadKeyArea(keys.dead);
+    case VariantShiftedDead: return converter.shiftedDeadKeyArea(keys.dead);
+    case VariantExtended: return converter.extendedKeyArea(keys.extended);
+    case VariantNumber: return converter.numberKeyArea();
+    case VariantPhoneNumber: return converter.phoneNumberKeyArea();
+    case VariantCount: break;
+    }
+
+    return KeyArea();
+}
+
+QString orientationName(Logic::LayoutHelper::Orientation orientation)
+{
+    return (orientation == Logic::LayoutHelper::Landscape ? "landscape" : "portrait");
+}
+
+//! Samples of one stage, for one layout and optionally variant and
+//! orientation.
+class Measurement
+{
+public:
+    explicit Measurement(const QString &stage,
+                         const QString &layout,
+                         const QString &variant = QString(),
+                         const QString &orientation = QString())
+        : m_stage(stage)
+        , m_layout(layout)
+        , m_variant(variant)
+        , m_orientation(orientation)
+        , m_samples()
+        , m_allocations()
+        , m_timer()
+        , m_allocation_count(0)
+    {}
+
+    void begin()
+    {
+        m_allocation_count = AllocationHooks::totalAllocations();
+        m_timer.start();
+    }
+
+    void end()
+    {
+        m_samples.append(m_timer.nsecsElapsed());
+        m_allocations.append(AllocationHooks::totalAllocations() - m_allocation_count);
+    }
+
+    QString id() const
+    {
+        QStringList parts;
+        parts << m_stage << m_layout;
+
+        if (not m_variant.isEmpty()) {
+            parts << m_variant;
+        }
+
+        if (not m_orientation.isEmpty()) {
+            parts << m_orientation;
+        }
+
+        return parts.join("/");
+    }
+
+    QVariantMap result() const
+    {
+        qint64 total(0);
+        qint64 max(0);
+
+        Q_FOREACH (qint64 allocations, m_allocations) {
+            total += allocations;
+            max = qMax(max, allocations);
+        }
+
+        QVariantMap allocations;
+        allocations.insert("mean", m_allocations.isEmpty() ? 0.0 : qreal(total) / m_allocations.count());
+        allocations.insert("max", max);
+
+        QVariantMap result;
+        result.insert("id", id());
+        result.insert("stage", m_stage);
+        result.insert("layout", m_layout);
+
+        if (not m_variant.isEmpty()) {
+            result.insert("variant", m_variant);
+        }
+
+        if (not m_orientation.isEmpty()) {
+            result.insert("orientation", m_orientation);
+        }
+
+        result.insert("latency", BenchmarkUtils::latencySummary(m_samples));
+        result.insert("allocations", allocations);
+
+        return result;
+    }
+
+private:
+    const QString m_stage;
+    const QString m_layout;
+    const QString m_variant;
+    const QString m_orientation;
+    QVector<qint64> m_samples;
+    QVector<qint64> m_allocations;
+    QElapsedTimer m_timer;
+    qint64 m_allocation_count;
+};
+
+QVariantMap benchmarkParser(const QString &layout,
+                            int rounds)
+{
+    Measurement measurement("parse", layout);
+    QFile file(KeyboardRepository::languagesDirectory() + "/" + layout + ".xml");
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open layout:" << file.fileName();
+        return QVariantMap();
+    }
+
+    // Exclude file I/O:
+    const QByteArray contents(file.readAll());
+
+    for (int round = 0; round < rounds; ++round) {
+        QBuffer buffer;
+        buffer.setData(contents);
+        buffer.open(QIODevice::ReadOnly);
+        LayoutParser parser(&buffer);
+
+        measurement.begin();
+        parser.parse();
+        measurement.end();
+    }
+
+    return measurement.result();
+}
+
+QVariantList benchmarkLoader(KeyboardLoader *loader,
+                             const SourceKeys &keys,
+                             int rounds)
+{
+    QVariantList results;
+    const SharedKeyboardRepository repository(loader->repository());
+
+    for (int variant = 0; variant < VariantCount; ++variant) {
+        if (not keys.supports(Variant(variant))) {
+            continue;
+        }
+
+        Measurement measurement("loader", loader->activeId(), VariantNames[variant]);
+
+        for (int round = 0; round < rounds; ++round) {
+            // Layouts stay parsed, only the conversion is measured:
+            repository->clearKeyboards();
+
+            measurement.begin();
+            loadVariant(*loader, Variant(variant), keys);
+            measurement.end();
+        }
+
+        results.append(measurement.result());
+    }
+
+    return results;
+}
+
+QVariantList benchmarkConverter(KeyboardLoader *loader,
+                                Style *style,
+                                const SourceKeys &keys,
+                                Logic::LayoutHelper::Orientation orientation,
+                                int rounds)
+{
+    QVariantList results;
+
+    Logic::KeyAreaConverter converter(style->attributes(), loader);
+    Logic::KeyAreaConverter extended_converter(style->extendedKeysAttributes(), loader);
+    converter.setLayoutOrientation(orientation);
+    extended_converter.setLayoutOrientation(orientation);
+
+    for (int variant = 0; variant < VariantCount; ++variant) {
+        if (not keys.supports(Variant(variant))) {
+            continue;
+        }
+
+        // LayoutUpdater styles extended keys with their own attributes:
+        const Logic::KeyAreaConverter &used_converter(variant == VariantExtended ? extended_converter
+                                                                                 : converter);
+        Measurement measurement("converter", loader->activeId(), VariantNames[variant],
+                                orientationName(orientation));
+
+        // Keyboards are cached after the first call, leaving the styling:
+        convertVariant(used_converter, Variant(variant), keys);
+
+        for (int round = 0; round < rounds; ++round) {
+            measurement.begin();
+            convertVariant(used_converter, Variant(variant), keys);
+            measurement.end();
+        }
+
+        results.append(measurement.result());
+    }
+
+    return results;
+}
+
+QVariantMap benchmarkModel(KeyboardLoader *loader,
+                           Style *style,
+                           Logic::LayoutHelper::Orientation orientation,
+                           int rounds)
+{
+    Logic::KeyAreaConverter converter(style->attributes(), loader);
+    converter.setLayoutOrientation(orientation);
+
+    // Alternate between two key areas, like when shift is toggled:
+    const KeyArea key_areas[2] = {converter.keyArea(), converter.shiftedKeyArea()};
+    Model::Layout model;
+    Measurement measurement("model", loader->activeId(), QString(), orientationName(orientation));
+
+    for (int round = 0; round < rounds; ++round) {
+        measurement.begin();
+        model.setKeyArea(key_areas[round % 2]);
+        measurement.end();
+    }
+
+    return measurement.result();
+}
+
+//! Annotates results with their baseline numbers. Returns the number of
+//! results whose p95 latency regressed by more than threshold percent.
+int compareToBaseline(QVariantList *results,
+                      const QVariant &baseline,
+                      qreal threshold)
+{
+    QHash<QString, QVariantMap> baseline_latencies;
+
+    Q_FOREACH (const QVariant &result, baseline.toMap().value("results").toList()) {
+        const QVariantMap map(result.toMap());
+        baseline_latencies.insert(map.value("id").toString(), map.value("latency").toMap());
+    }
+
+    int regressions(0);
+
+    for (int index = 0; index < results->count(); ++index) {
+        QVariantMap result(results->at(index).toMap());
+        const QHash<QString, QVariantMap>::const_iterator found(
+            baseline_latencies.constFind(result.value("id").toString()));
+
+        if (found == baseline_latencies.constEnd()) {
+            continue;
+        }
+
+        const qreal p95(result.value("latency").toMap().value("p95_us").toDouble());
+        const qreal baseline_p95(found.value().value("p95_us").toDouble());
+        const qreal change(baseline_p95 > 0 ? (p95 - baseline_p95) * 100 / baseline_p95 : 0.0);
+        const bool regressed(change > threshold);
+
+        QVariantMap comparison;
+        comparison.insert("p50_us", found.value().value("p50_us"));
+        comparison.insert("p95_us", baseline_p95);
+        comparison.insert("p95_change_percent", change);
+        comparison.insert("regressed", regressed);
+        result.insert("baseline", comparison);
+        results->replace(index, result);
+
+        if (regressed) {
+            ++regressions;
+            qWarning() << "Regression:" << result.value("id").toString()
+                       << "p95" << baseline_p95 << "->" << p95 << "us";
+        }
+    }
+
+    return regressions;
+}
+
+} // unnamed namespace
+
+int main(int argc,
+         char ** argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList arguments(app.arguments());
+
+    const QString profile(BenchmarkUtils::argumentValue(arguments, "--profile", MALIIT_DEFAULT_PROFILE));
+    const QString output_path(BenchmarkUtils::argumentValue(arguments, "--output", QString()));
+    const QString baseline_path(BenchmarkUtils::argumentValue(arguments, "--baseline", QString()));
+    const qreal threshold(BenchmarkUtils::argumentValue(arguments, "--threshold", "10").toDouble());
+    const int rounds(qMax(1, BenchmarkUtils::argumentValue(arguments, "--rounds", "200").toInt()));
+
+    KeyboardLoader loader;
+    QStringList layouts(loader.ids());
+    const QString requested_layouts(BenchmarkUtils::argumentValue(arguments, "--layouts", QString()));
+
+    if (not requested_layouts.isEmpty()) {
+        layouts = requested_layouts.split(',');
+    }
+
+    if (layouts.isEmpty()) {
+        qWarning() << "No language files found.";
+        return 1;
+    }
+
+    Style style;
+    style.setProfile(profile);
+
+    QVariantList results;
+
+    Q_FOREACH (const QString &layout, layouts) {
+        results.append(benchmarkParser(layout, rounds));
+
+        loader.setActiveId(layout);
+        const SourceKeys keys(loader.keyboard());
+
+        results += benchmarkLoader(&loader, keys, rounds);
+
+        for (int orientation = Logic::LayoutHelper::Landscape;
+             orientation <= Logic::LayoutHelper::Portrait;
+             ++orientation) {
+            results += benchmarkConverter(&loader, &style, keys,
+                                          Logic::LayoutHelper::Orientation(orientation), rounds);
+            results.append(benchmarkModel(&loader, &style,
+                                          Logic::LayoutHelper::Orientation(orientation), rounds));
+        }
+    }
+
+    int regressions(0);
+
+    if (not baseline_path.isEmpty()) {
+        const QVariant baseline(BenchmarkUtils::readJson(baseline_path));
+
+        if (not baseline.isValid()) {
+            return 1;
+        }
+
+        regressions = compareToBaseline(&results, baseline, threshold);
+    }
+
+    QVariantMap report;
+    report.insert("benchmark", "layout-pipeline");
+    report.insert("profile", profile);
+    report.insert("rounds", rounds);
+    report.insert("results", results);
+
+    if (not baseline_path.isEmpty()) {
+        report.insert("baseline", baseline_path);
+        report.insert("threshold_percent", threshold);
+        report.insert("regressions", regressions);
+    }
+
+    if (not BenchmarkUtils::writeOutput(output_path, BenchmarkUtils::toJson(report))) {
+        return 1;
+    }
+
+    return (regressions > 0 ? 2 : 0);
+}
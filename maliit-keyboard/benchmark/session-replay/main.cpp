@@ -0,0 +1,312 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Replays a trace recorded by Logic::SessionRecorder (enabled in the plugin
+// through MALIIT_KEYBOARD_SESSION_TRACE) through LayoutUpdater,
+// EventHandler, Editor and WordEngine, without any UI and against
+// InputMethodHostProbe instead of an application. Reports the processing
+// time of each recorded event as JSON.
+//
+// By default, events are replayed back to back. With --realtime, the
+// recorded timing is kept, so that timers such as auto-repeat fire like
+// they did during recording.
+//
+// Usage: maliit-keyboard-session-replay TRACE [--profile NAME] [--settle MS]
+//                                             [--realtime] [--output FILE]
+
+#include "benchmarkutils.h"
+
+#include "models/layout.h"
+#include "models/text.h"
+#include "logic/layouthelper.h"
+#include "logic/layoutupdater.h"
+#include "logic/eventhandler.h"
+#include "logic/wordengine.h"
+#include "logic/languagefeatures.h"
+#include "logic/sessionrecorder.h"
+#include "logic/style.h"
+#include "plugin/editor.h"
+
+#include "inputmethodhostprobe.h"
+
+#include <QtCore>
+#include <QCoreApplication>
+
+#include <algorithm>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+//! Number of slowest events listed in the report.
+const int SlowestEventCount = 10;
+
+QString eventName(Logic::SessionRecorder::EventType type)
+{
+    switch (type) {
+    case Logic::SessionRecorder::EventPressed: return "pressed";
+    case Logic::SessionRecorder::EventReleased: return "released";
+    case Logic::SessionRecorder::EventEntered: return "entered";
+    case Logic::SessionRecorder::EventExited: return "exited";
+    case Logic::SessionRecorder::EventPressAndHold: return "press_and_hold";
+    case Logic::SessionRecorder::EventMoved: return "moved";
+    case Logic::SessionRecorder::EventCursorPositionChanged: return "cursor_position_changed";
+    case Logic::SessionRecorder::EventKeyboardChanged: return "keyboard_changed";
+    case Logic::SessionRecorder::EventOrientationChanged: return "orientation_changed";
+    case Logic::SessionRecorder::EventScreenSizeChanged: return "screen_size_changed";
+    case Logic::SessionRecorder::EventGestureTypingChanged: return "gesture_typing_changed";
+    }
+
+    return "unknown";
+}
+
+// Runs the event loop for the given time, so that background work (like
+// loading dictionaries) and timers can finish.
+void spinEventLoop(int msecs)
+{
+    QEventLoop loop;
+    QTimer::singleShot(msecs, &loop, SLOT(quit()));
+    loop.exec();
+}
+
+// The keyboard as set up by the plugin, minus the views.
+class ReplaySession
+{
+public:
+    Model::Layout model;
+    Logic::LayoutHelper helper;
+    Logic::LayoutUpdater updater;
+    Logic::EventHandler event_handler;
+    Editor editor;
+    InputMethodHostProbe host;
+    SharedStyle style;
+
+    explicit ReplaySession(const QString &profile)
+        : model()
+        , helper()
+        , updater()
+        , event_handler(&model, &updater)
+        , editor(new Model::Text, new Logic::WordEngine, new Logic::LanguageFeatures)
+        , host()
+        , style(new Style)
+    {
+        style->setProfile(profile);
+
+        editor.setHost(&host);
+        editor.setCoalescingEnabled(true);
+        editor.setAutoRepeatAccelerated(true);
+        editor.setPreeditEnabled(true);
+        editor.wordEngine()->setEnabled(true);
+
+        Logic::connectEventHandlerToTextEditor(&event_handler, &editor);
+        Logic::connectLayoutUpdaterToTextEditor(&updater, &editor);
+
+        QObject::connect(&helper, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)),
+                         &model,  SLOT(setKeyArea(KeyArea)));
+
+        QObject::connect(&updater,              SIGNAL(keyboardLanguageChanged(QString)),
+                         editor.wordEngine(), SLOT(setLanguage(QString)));
+
+        helper.setAlignment(Logic::LayoutHelper::Bottom);
+        updater.setLayout(&helper);
+        updater.setStyle(style);
+    }
+
+    void dispatch(const Logic::SessionRecorder::Event &event)
+    {
+        switch (event.type) {
+        case Logic::SessionRecorder::EventPressed:
+            event_handler.onPressed(event.index);
+            break;
+
+        case Logic::SessionRecorder::EventReleased:
+            event_handler.onReleased(event.index);
+            break;
+
+        case Logic::SessionRecorder::EventEntered:
+            event_handler.onEntered(event.index);
+            break;
+
+        case Logic::SessionRecorder::EventExited:
+            event_handler.onExited(event.index);
+            break;
+
+        case Logic::SessionRecorder::EventPressAndHold:
+            event_handler.onPressAndHold(event.index);
+            break;
+
+        case Logic::SessionRecorder::EventMoved:
+            event_handler.onMoved(event.index, event.position.x(), event.position.y());
+            break;
+
+        case Logic::SessionRecorder::EventCursorPositionChanged:
+            // Traces only keep the character classes of the surrounding text:
+            editor.onCursorPositionChanged(event.index, event.text);
+            break;
+
+        case Logic::SessionRecorder::EventKeyboardChanged:
+            updater.setActiveKeyboardId(event.text);
+            break;
+
+        case Logic::SessionRecorder::EventOrientationChanged:
+            updater.setOrientation(static_cast<Logic::LayoutHelper::Orientation>(event.index));
+            break;
+
+        case Logic::SessionRecorder::EventScreenSizeChanged:
+            helper.setScreenSize(QSize(event.position.x(), event.position.y()));
+            break;
+
+        case Logic::SessionRecorder::EventGestureTypingChanged:
+            event_handler.setGestureTypingEnabled(event.index != 0);
+            editor.wordEngine()->setGestureTypingEnabled(event.index != 0);
+            break;
+        }
+    }
+};
+
+struct Sample
+{
+    int index;
+    qint64 duration_ns;
+
+    bool operator<(const Sample &other) const
+    {
+        return duration_ns > other.duration_ns;
+    }
+};
+
+} // unnamed namespace
+
+int main(int argc,
+         char ** argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList arguments(app.arguments());
+
+    if (arguments.count() < 2 || arguments.at(1).startsWith("--")) {
+        qWarning() << "Usage:" << arguments.first()
+                   << "TRACE [--profile NAME] [--settle MS] [--realtime] [--output FILE]";
+        return 1;
+    }
+
+    const QString trace_path(arguments.at(1));
+    const QString profile(BenchmarkUtils::argumentValue(arguments, "--profile", MALIIT_DEFAULT_PROFILE));
+    const QString output_path(BenchmarkUtils::argumentValue(arguments, "--output", QString()));
+    const int settle(qMax(0, BenchmarkUtils::argumentValue(arguments, "--settle", "500").toInt()));
+    const bool realtime(arguments.contains("--realtime"));
+
+    QVector<Logic::SessionRecorder::Event> events;
+    if (not Logic::SessionRecorder::readTrace(trace_path, &events)) {
+        if (events.isEmpty()) {
+            return 1;
+        }
+
+        qWarning() << "Replaying" << events.count() << "events read before the error.";
+    }
+
+    ReplaySession session(profile);
+    QMap<QString, QVector<qint64> > samples_by_type;
+    QVector<qint64> all_samples;
+    QVector<Sample> samples;
+    QElapsedTimer replay_time;
+    QElapsedTimer timer;
+
+    all_samples.reserve(events.count());
+    samples.reserve(events.count());
+    replay_time.start();
+
+    for (int index = 0; index < events.count(); ++index) {
+        const Logic::SessionRecorder::Event &event(events.at(index));
+
+        if (realtime && event.time > replay_time.elapsed()) {
+            spinEventLoop(event.time - replay_time.elapsed());
+        }
+
+        // Includes work queued during the event, like coalesced host calls:
+        timer.start();
+        session.dispatch(event);
+        QCoreApplication::processEvents();
+        const qint64 duration(timer.nsecsElapsed());
+
+        samples_by_type[eventName(event.type)].append(duration);
+        all_samples.append(duration);
+
+        Sample sample;
+        sample.index = index;
+        sample.duration_ns = duration;
+        samples.append(sample);
+
+        // Dictionaries for the new language, and gesture lexicons, load in
+        // the background:
+        if (not realtime && (event.type == Logic::SessionRecorder::EventKeyboardChanged
+                             || event.type == Logic::SessionRecorder::EventGestureTypingChanged)) {
+            spinEventLoop(settle);
+        }
+    }
+
+    QVariantMap by_type;
+    for (QMap<QString, QVector<qint64> >::const_iterator it = samples_by_type.constBegin();
+         it != samples_by_type.constEnd();
+         ++it) {
+        by_type.insert(it.key(), BenchmarkUtils::latencySummary(it.value()));
+    }
+
+    std::stable_sort(samples.begin(), samples.end());
+    QVariantList slowest;
+    for (int index = 0; index < qMin(SlowestEventCount, samples.count()); ++index) {
+        const Logic::SessionRecorder::Event &event(events.at(samples.at(index).index));
+        QVariantMap entry;
+        entry.insert("event", samples.at(index).index);
+        entry.insert("type", eventName(event.type));
+        entry.insert("recorded_at_ms", event.time);
+        entry.insert("duration_us", samples.at(index).duration_ns / 1000.0);
+        slowest.append(entry);
+    }
+
+    QVariantMap host;
+    host.insert("commit_strings", session.host.commitStringCount());
+    host.insert("key_events", session.host.keyEventCount());
+    host.insert("saved_host_calls", session.editor.savedHostCalls());
+
+    QVariantMap report;
+    report.insert("benchmark", "session-replay");
+    report.insert("trace", trace_path);
+    report.insert("profile", profile);
+    report.insert("realtime", realtime);
+    report.insert("events", events.count());
+    report.insert("recorded_duration_ms", events.isEmpty() ? 0 : events.last().time);
+    report.insert("latency", BenchmarkUtils::latencySummary(all_samples));
+    report.insert("latency_by_type", by_type);
+    report.insert("slowest", slowest);
+    report.insert("host", host);
+
+    return BenchmarkUtils::writeOutput(output_path, BenchmarkUtils::toJson(report)) ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+include(../../config.pri)
+include(../../config-plugin.pri)
+include(../common/common.pri)
+
+TOP_BUILDDIR = $${OUT_PWD}/../../..
+TEMPLATE = app
+TARGET = maliit-keyboard-session-replay
+target.path = $$INSTALL_BIN
+
+DEFINES += MALIIT_DEFAULT_PROFILE=\\\"$$MALIIT_DEFAULT_PROFILE\\\"
+
+INCLUDEPATH += ../../lib ../../ ../../tests/common
+LIBS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_PLUGIN_LIB} $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_VIEW_LIB} $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+PRE_TARGETDEPS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_PLUGIN_LIB} $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_VIEW_LIB} $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+
+# The host probe of the tests records what would be sent to the application:
+HEADERS += \
+    ../../tests/common/inputmethodhostprobe.h \
+
+SOURCES += \
+    ../../tests/common/inputmethodhostprobe.cpp \
+    main.cpp \
+
+QT = core gui
+INSTALLS += target
+
+include(../../word-prediction.pri)
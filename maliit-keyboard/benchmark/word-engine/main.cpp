@@ -0,0 +1,266 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Replays a text corpus through Model::Text and the word engine, one
+// character at a time, like AbstractTextEditor does for each key release,
+// and reports per-keystroke latency as JSON. The "none" run measures the
+// text model and candidate dispatch alone. The "presage" and "hunspell"
+// runs query a single backend through Logic::WordEngine, waiting for it
+// without a time budget, so they report what the backend itself costs.
+// The "word-engine" run queries all backends it was built with, under the
+// time budget the keyboard uses.
+//
+// Usage: maliit-keyboard-benchmark-word-engine [--corpus FILE] [--language ID]
+//                                              [--rounds N] [--output FILE]
+
+#include "benchmarkutils.h"
+
+#include "models/text.h"
+#include "logic/abstractwordengine.h"
+#include "logic/wordengine.h"
+
+#include <QtCore>
+#include <QCoreApplication>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+const char * const DefaultCorpus =
+    "The quick brown fox jumps over the lazy dog. Typing on a virtual keyboard "
+    "should feel instant, even when the word engine has to look up thousands of "
+    "dictionary entries for every single key press.\n"
+    "Spelling mistakes like teh, recieve and definately are corrected while "
+    "predictions complete longer words such as keyboard, dictionary and "
+    "application before they are typed in full.\n";
+
+// Measures the cost of the text model and candidate dispatch alone.
+class NullEngine
+    : public Logic::AbstractWordEngine
+{
+public:
+    explicit NullEngine()
+        : AbstractWordEngine()
+    {
+        AbstractWordEngine::setEnabled(true);
+    }
+
+private:
+    WordCandidateList fetchCandidates(Model::Text *text)
+    {
+        Q_UNUSED(text)
+        return WordCandidateList();
+    }
+};
+
+class CandidateCounter
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CandidateCounter(Logic::AbstractWordEngine *engine)
+        : QObject()
+        , m_count(0)
+    {
+        connect(engine, SIGNAL(candidatesChanged(WordCandidateList)),
+                this,   SLOT(onCandidatesChanged(WordCandidateList)));
+    }
+
+    qint64 count() const
+    {
+        return m_count;
+    }
+
+private:
+    Q_SLOT void onCandidatesChanged(const WordCandidateList &candidates)
+    {
+        m_count += candidates.count();
+    }
+
+    qint64 m_count;
+};
+
+// Replays the corpus, following what AbstractTextEditor::onKeyReleased does
+// for ActionInsert and ActionSpace, with the host echoing committed text
+// back as surrounding text. Returns the latency of every keystroke that
+// reached the word engine, in nanoseconds.
+QVector<qint64> replay(Logic::AbstractWordEngine *engine,
+                       const QString &corpus)
+{
+    QVector<qint64> samples;
+    samples.reserve(corpus.length());
+
+    Model::Text text;
+    QString document;
+    QElapsedTimer timer;
+
+    Q_FOREACH (const QChar &c, corpus) {
+        if (c == QChar('\n')) {
+            text.commitPreedit();
+            engine->clearCandidates();
+            document.clear();
+            text.setSurrounding(document);
+            text.setSurroundingOffset(0);
+            continue;
+        }
+
+        if (c.isSpace()) {
+            text.appendToPreedit(QString(c));
+            document.append(text.preedit());
+            text.commitPreedit();
+            engine->clearCandidates();
+            text.setSurrounding(document);
+            text.setSurroundingOffset(document.length());
+            continue;
+        }
+
+        timer.start();
+        text.appendToPreedit(QString(c));
+        engine->computeCandidates(&text);
+        samples.append(timer.nsecsElapsed());
+    }
+
+    return samples;
+}
+
+QVariantMap run(const QString &name,
+                Logic::AbstractWordEngine *engine,
+                const QString &corpus,
+                int rounds)
+{
+    BenchmarkUtils::resetPeakResidentSetSize();
+
+    const CandidateCounter counter(engine);
+    QVector<qint64> samples;
+    for (int round = 0; round < rounds; ++round) {
+        samples += replay(engine, corpus);
+    }
+
+    qint64 total_ns(0);
+    Q_FOREACH (qint64 sample, samples) {
+        total_ns += sample;
+    }
+
+    QVariantMap result;
+    result.insert("backend", name);
+    result.insert("enabled", engine->isEnabled());
+    result.insert("keystrokes", samples.count());
+    result.insert("candidates", counter.count());
+    result.insert("candidates_per_second",
+                  total_ns > 0 ? counter.count() * 1e9 / total_ns : 0.0);
+    result.insert("latency", BenchmarkUtils::latencySummary(samples));
+    result.insert("peak_rss_kb", BenchmarkUtils::peakResidentSetSize());
+
+    return result;
+}
+
+// Runs a word engine restricted to some backends, after its dictionary
+// finished loading. Dictionaries of languages other than the default one
+// load in the background, which must not end up in the measured latencies.
+QVariantMap runWordEngine(const QString &name,
+                          int backends,
+                          int time_budget,
+                          const QString &language,
+                          const QString &corpus,
+                          int rounds)
+{
+    Logic::WordEngine word_engine;
+    word_engine.setCandidateBackends(backends);
+    word_engine.setCandidatesTimeBudget(time_budget);
+    word_engine.setEnabled(true);
+    word_engine.setLanguage(language);
+
+    while (word_engine.isLoadingDictionary()) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+
+    if (not word_engine.loadedLanguages().contains(language)) {
+        qWarning() << "No dictionary for language" << language << "- measuring" << name
+                   << "without spell checking.";
+    }
+
+    QVariantMap result(run(name, &word_engine, corpus, rounds));
+    result.insert("time_budget_ms", time_budget);
+    return result;
+}
+
+} // unnamed namespace
+
+int main(int argc,
+         char ** argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList arguments(app.arguments());
+
+    const QString corpus_path(BenchmarkUtils::argumentValue(arguments, "--corpus", QString()));
+    const QString language(BenchmarkUtils::argumentValue(arguments, "--language", "en_gb"));
+    const QString output_path(BenchmarkUtils::argumentValue(arguments, "--output", QString()));
+    const int rounds(qMax(1, BenchmarkUtils::argumentValue(arguments, "--rounds", "1").toInt()));
+
+    QString corpus(DefaultCorpus);
+
+    if (not corpus_path.isEmpty()) {
+        QFile file(corpus_path);
+        if (not file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qWarning() << "Could not open corpus:" << corpus_path;
+            return 1;
+        }
+        corpus = QString::fromUtf8(file.readAll());
+    }
+
+    QVariantList backends;
+
+    NullEngine null_engine;
+    backends.append(run("none", &null_engine, corpus, rounds));
+
+#ifdef HAVE_PRESAGE
+    backends.append(runWordEngine("presage", 1 << Logic::CandidateFusion::BackendPresage,
+                                  -1, language, corpus, rounds));
+#endif
+    backends.append(runWordEngine("hunspell", 1 << Logic::CandidateFusion::BackendSpellChecker,
+                                  -1, language, corpus, rounds));
+    backends.append(runWordEngine("word-engine", Logic::WordEngine::AllCandidateBackends,
+                                  Logic::WordEngine::CandidatesTimeBudget,
+                                  language, corpus, rounds));
+
+    QVariantMap report;
+    report.insert("benchmark", "word-engine");
+    report.insert("corpus", corpus_path.isEmpty() ? QString("<builtin>") : corpus_path);
+    report.insert("corpus_characters", corpus.length());
+    report.insert("language", language);
+    report.insert("rounds", rounds);
+    report.insert("backends", backends);
+
+    return BenchmarkUtils::writeOutput(output_path, BenchmarkUtils::toJson(report)) ? 0 : 1;
+}
+
+#include "main.moc"
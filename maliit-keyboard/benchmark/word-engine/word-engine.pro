@@ -0,0 +1,17 @@
+include(../../config.pri)
+include(../common/common.pri)
+
+TOP_BUILDDIR = $${OUT_PWD}/../../..
+TEMPLATE = app
+TARGET = maliit-keyboard-benchmark-word-engine
+target.path = $$INSTALL_BIN
+
+INCLUDEPATH += ../../lib
+LIBS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+PRE_TARGETDEPS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+SOURCES += main.cpp
+
+QT = core
+INSTALLS += target
+
+include(../../word-prediction.pri)
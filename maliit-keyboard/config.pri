@@ -42,3 +42,7 @@ MALIIT_KEYBOARD_PLUGIN_TARGET = maliit-keyboard-plugin
 MALIIT_KEYBOARD_LIB = maliit-keyboard/lib/$$maliitStaticLib($${MALIIT_KEYBOARD_TARGET})
 MALIIT_KEYBOARD_VIEW_LIB = maliit-keyboard/view/$$maliitStaticLib($${MALIIT_KEYBOARD_VIEW_TARGET})
 MALIIT_KEYBOARD_PLUGIN_LIB = maliit-keyboard/plugin/$$maliitDynamicLib($${MALIIT_KEYBOARD_PLUGIN_TARGET})
+
+enable-tracing {
+    DEFINES += MALIIT_KEYBOARD_TRACING
+}
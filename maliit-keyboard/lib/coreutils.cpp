@@ -34,6 +34,8 @@
 
 #include "models/key.h"
 
+#include <QDir>
+
 namespace MaliitKeyboard {
 namespace CoreUtils {
 namespace {
@@ -68,6 +70,19 @@ const QString &maliitKeyboardStyleProfilesDirectory()
     return styles_profiles_directory;
 }
 
+const QString &maliitKeyboardCacheDirectory()
+{
+    static const QByteArray env_cache_directory = qgetenv("MALIIT_KEYBOARD_CACHEDIR");
+    static const QByteArray xdg_cache_home = qgetenv("XDG_CACHE_HOME");
+    static const QString cache_directory = (not env_cache_directory.isEmpty()
+                                            ? QString::fromUtf8(env_cache_directory)
+                                            : (not xdg_cache_home.isEmpty()
+                                               ? QString::fromUtf8(xdg_cache_home)
+                                               : QDir::homePath() + "/.cache") + "/maliit-keyboard");
+
+    return cache_directory;
+}
+
 QString idFromKey(const Key &key)
 {
     switch (key.action()) {
@@ -42,6 +42,7 @@ namespace CoreUtils {
 const QString &pluginDataDirectory();
 const QString &maliitKeyboardDataDirectory();
 const QString &maliitKeyboardStyleProfilesDirectory();
+const QString &maliitKeyboardCacheDirectory();
 QString idFromKey(const Key &key);
 }} // namespace MaliitKeyboard, CoreUtils
 
@@ -10,7 +10,7 @@ include(models/models.pri)
 include(logic/logic.pri)
 include(parser/parser.pri)
 
-HEADERS += coreutils.h
-SOURCES += coreutils.cpp
+HEADERS += coreutils.h tracer.h memoryusage.h
+SOURCES += coreutils.cpp tracer.cpp memoryusage.cpp
 
 include(../word-prediction.pri)
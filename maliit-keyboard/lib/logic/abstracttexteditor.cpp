@@ -172,9 +172,22 @@ inline bool isSeparator(const QChar &c)
     return (c.isPunct() or c.isSpace());
 }
 
+//! Number of characters on each side of the cursor compared when
+//! checking whether an update from the application is the expected one.
+const int ExpectedSurroundingWindow = 32;
+
+//! \brief Returns character of surrounding text, or a space if \a index
+//! is right after the last character.
+inline QChar surroundingAtOrSpace(const Model::Text &text,
+                                  int index)
+{
+    return (index < text.surroundingLength() ? text.surroundingAt(index) : QChar(' '));
+}
+
+} // unnamed namespace
+
 //! \brief Extracts a word boundaries at cursor position.
-//! \param surrounding_text Text from which extraction will happen.
-//! \param cursor_position Position of cursor within \a surrounding_text.
+//! \param text Text model from which extraction will happen.
 //! \param replacement Place where replacement data will be stored.
 //!
 //! \return whether surrounding text was valid (not empty).
@@ -184,11 +197,11 @@ inline bool isSeparator(const QChar &c)
 //! word, then no word boundaries are stored - instead invalid
 //! replacement is stored. It might happen that cursor position is
 //! outside the string, so \a replacement will have fixed position.
-bool extractWordBoundariesAtCursor(const QString& surrounding_text,
-                                   int cursor_position,
+//! Only the word around the cursor is looked at.
+bool extractWordBoundariesAtCursor(const Model::Text &text,
                                    AbstractTextEditor::Replacement *replacement)
 {
-    const int text_length(surrounding_text.length());
+    const int text_length(text.surroundingLength());
 
     if (text_length == 0) {
         return false;
@@ -196,16 +209,14 @@ bool extractWordBoundariesAtCursor(const QString& surrounding_text,
 
     // just in case - if cursor is far after last char in surrounding
     // text we place it right after last char.
-    cursor_position = qBound(0, cursor_position, text_length);
+    const int cursor_position(qBound<int>(0, text.surroundingOffset(), text_length));
 
     // cursor might be placed in after last char (that is to say - its
     // index might be the one of string terminator) - for simplifying
-    // the algorithm below we fake it as cursor is put on delimiter:
+    // the algorithm below we treat it as if cursor is put on delimiter:
     // "abc" - surrounding text
     //     | - cursor placement
-    // "abc " - fake surrounding text
-    const QString fake_surrounding_text(surrounding_text + " ");
-    const QChar *const fake_data(fake_surrounding_text.constData());
+    // "abc " - seen surrounding text
     // begin is index of first char in a word
     int begin(-1);
     // end is index of a char after last char in a word.
@@ -214,9 +225,7 @@ bool extractWordBoundariesAtCursor(const QString& surrounding_text,
     int end(-2);
 
     for (int iter(cursor_position); iter >= 0; --iter) {
-        const QChar &c(fake_data[iter]);
-
-        if (isSeparator(c)) {
+        if (isSeparator(surroundingAtOrSpace(text, iter))) {
             if (iter != cursor_position) {
                 break;
             }
@@ -226,12 +235,10 @@ bool extractWordBoundariesAtCursor(const QString& surrounding_text,
     }
 
     if (begin >= 0) {
-        // take note that fake_data's last QChar is always a space.
+        // take note that the char after the last one is always a space.
         for (int iter(cursor_position); iter <= text_length; ++iter) {
-            const QChar &c(fake_data[iter]);
-
             end = iter;
-            if (isSeparator(c)) {
+            if (isSeparator(surroundingAtOrSpace(text, iter))) {
                 break;
             }
         }
@@ -246,6 +253,8 @@ bool extractWordBoundariesAtCursor(const QString& surrounding_text,
     return true;
 }
 
+namespace {
+
 Qt::Key toRepeatableQtKey(Key::Action action)
 {
     switch(action) {
@@ -259,6 +268,48 @@ Qt::Key toRepeatableQtKey(Key::Action action)
     }
 }
 
+//! Hold time after the first repeat from which on accelerated auto-repeat
+//! handles more than one character per repeat, in milliseconds.
+const int AccelerationStart = 1000;
+
+//! Additional hold time needed for each further character per repeat.
+const int AccelerationStep = 250;
+
+//! Maximum number of characters handled per repeat.
+const int MaxRepeatSteps = 8;
+
+//! Hold time after the first repeat from which on accelerated auto-repeat
+//! handles whole words, in milliseconds.
+const int WordRepeatStart = 2500;
+
+//! \brief Returns number of characters from cursor to the previous
+//! (\a direction < 0) or next word boundary in surrounding text.
+int distanceToWordBoundary(const Model::Text &text,
+                           int direction)
+{
+    const int length(text.surroundingLength());
+    const int offset(qBound<int>(0, text.surroundingOffset(), length));
+    int iter(offset);
+
+    if (direction < 0) {
+        while (iter > 0 and isSeparator(text.surroundingAt(iter - 1))) {
+            --iter;
+        }
+        while (iter > 0 and not isSeparator(text.surroundingAt(iter - 1))) {
+            --iter;
+        }
+    } else {
+        while (iter < length and isSeparator(text.surroundingAt(iter))) {
+            ++iter;
+        }
+        while (iter < length and not isSeparator(text.surroundingAt(iter))) {
+            ++iter;
+        }
+    }
+
+    return qAbs(iter - offset);
+}
+
 } // unnamed namespace
 
 //! \brief Connects event handler to editor.
@@ -278,6 +329,9 @@ void connectEventHandlerToTextEditor(EventHandler *event_handler,
 
     QObject::connect(event_handler, SIGNAL(keyExited(Key)),
                      editor,        SLOT(onKeyExited(Key)));
+
+    QObject::connect(event_handler, SIGNAL(gestureCompleted(QVector<QPoint>,KeyArea)),
+                     editor,        SLOT(onGestureCompleted(QVector<QPoint>,KeyArea)));
 }
 
 //! \brief Connects layout updater to editor.
@@ -315,6 +369,8 @@ public:
         bool key_sent;
         int delay;
         int interval;
+        bool accelerated;
+        QElapsedTimer hold_time; //!< Started when first repeat is due.
 
         AutoRepeat()
             : timer()
@@ -322,9 +378,17 @@ public:
             , key_sent(false)
             , delay(500)
             , interval(50)
+            , accelerated(false)
+            , hold_time()
         {
             timer.setSingleShot(true);
         }
+
+        void start()
+        {
+            timer.start(delay);
+            hold_time.invalidate();
+        }
     } auto_repeat;
 
     QScopedPointer<Model::Text> text;
@@ -334,7 +398,9 @@ public:
     bool auto_correct_enabled;
     bool auto_caps_enabled;
     int ignore_next_cursor_position;
-    QString ignore_next_surrounding_text;
+    int ignore_next_surrounding_length;
+    QString ignore_next_surrounding_window; //!< Expected text around ignore_next_cursor_position.
+    QString gesture_preedit; //!< Preedit set by the last gesture.
 
     explicit AbstractTextEditorPrivate(Model::Text *new_text,
                                        Logic::AbstractWordEngine *new_word_engine,
@@ -353,7 +419,9 @@ AbstractTextEditorPrivate::AbstractTextEditorPrivate(Model::Text *new_text,
     , auto_correct_enabled(false)
     , auto_caps_enabled(false)
     , ignore_next_cursor_position(-1)
-    , ignore_next_surrounding_text()
+    , ignore_next_surrounding_length(-1)
+    , ignore_next_surrounding_window()
+    , gesture_preedit()
 {
     (void) valid();
 }
@@ -419,6 +487,28 @@ void AbstractTextEditor::setAutoRepeatBehaviour(int auto_repeat_delay,
     d->auto_repeat.interval = auto_repeat_interval;
 }
 
+//! \brief Returns whether auto-repeat accelerates while a key is held.
+bool AbstractTextEditor::isAutoRepeatAccelerated() const
+{
+    Q_D(const AbstractTextEditor);
+    return d->auto_repeat.accelerated;
+}
+
+//! \brief Sets whether auto-repeat accelerates while a key is held.
+//! \param accelerated Whether to accelerate.
+//!
+//! Accelerated auto-repeat of backspace, left and right keys handles an
+//! increasing number of characters per repeat, and whole words after a
+//! while. Each repeat of more than one character results in a single
+//! deleteSurroundingText() or moveCursor() call instead of one key event
+//! per character. Single steps, and hosts without surrounding text, still
+//! get key events.
+void AbstractTextEditor::setAutoRepeatAccelerated(bool accelerated)
+{
+    Q_D(AbstractTextEditor);
+    d->auto_repeat.accelerated = accelerated;
+}
+
 //! \brief Reacts to key press.
 //! \param key Pressed key.
 //!
@@ -436,7 +526,7 @@ void AbstractTextEditor::onKeyPressed(const Key &key)
     d->auto_repeat.key = toRepeatableQtKey(key.action());
     if (d->auto_repeat.key != Qt::Key_unknown) {
         commitPreedit();
-        d->auto_repeat.timer.start(d->auto_repeat.delay);
+        d->auto_repeat.start();
         d->auto_repeat.key_sent = true;
     }
 
@@ -515,6 +605,7 @@ void AbstractTextEditor::onKeyReleased(const Key &key)
             d->text->appendToPreedit(" ");
         }
         commitPreedit();
+        d->word_engine->computeNextWordCandidates(d->text.data());
 
         if (auto_caps_activated && d->auto_caps_enabled) {
             Q_EMIT autoCapsActivated();
@@ -594,7 +685,7 @@ void AbstractTextEditor::onKeyEntered(const Key &key)
     d->auto_repeat.key = toRepeatableQtKey(key.action());
     if (d->auto_repeat.key != Qt::Key_unknown) {
         d->auto_repeat.key_sent = false;
-        d->auto_repeat.timer.start(d->auto_repeat.delay);
+        d->auto_repeat.start();
     }
 }
 
@@ -611,6 +702,50 @@ void AbstractTextEditor::onKeyExited(const Key &key)
     }
 }
 
+//! \brief Reacts to a completed shape-writing gesture.
+//! \param trajectory The touch points of the gesture, in key area coordinates.
+//! \param key_area The key area the gesture was drawn on.
+//!
+//! Turns the best matching word into the new preedit, replacing a word
+//! typed key by key. A word from a previous gesture gets committed first,
+//! followed by a space. Alternatives are shown as word candidates, selecting
+//! one replaces the preedit. Without preedit, the best match is committed
+//! right away.
+void AbstractTextEditor::onGestureCompleted(const QVector<QPoint> &trajectory,
+                                            const KeyArea &key_area)
+{
+    Q_D(AbstractTextEditor);
+
+    if (not d->valid()) {
+        return;
+    }
+
+    const WordCandidateList candidates(d->word_engine->computeGestureCandidates(trajectory, key_area));
+
+    if (candidates.isEmpty()) {
+        return;
+    }
+
+    // Spaces cannot be drawn, so gestured words are separated implicitly:
+    if (not d->text->preedit().isEmpty() && d->text->preedit() == d->gesture_preedit) {
+        d->text->appendToPreedit(" ");
+        commitPreedit();
+    }
+
+    d->text->setPreedit(candidates.first().word());
+    d->gesture_preedit = d->text->preedit();
+
+    if (not d->preedit_enabled) {
+        commitPreedit();
+        return;
+    }
+
+    d->text->setPrimaryCandidate(d->text->preedit());
+    d->text->setPreeditFace(Model::Text::PreeditActive);
+    sendPreeditString(d->text->preedit(), d->text->preeditFace(),
+                      Replacement(d->text->cursorPosition()));
+}
+
 //! \brief Replaces current preedit with given replacement
 //! \param replacement New preedit.
 void AbstractTextEditor::replacePreedit(const QString &replacement)
@@ -644,6 +779,7 @@ void AbstractTextEditor::replaceAndCommitPreedit(const QString &replacement)
     d->text->setPreedit(replacement);
     d->text->appendToPreedit(appendix);
     commitPreedit();
+    d->word_engine->computeNextWordCandidates(d->text.data());
 
     if (auto_caps_activated && d->auto_caps_enabled) {
         Q_EMIT autoCapsActivated();
@@ -751,8 +887,46 @@ void AbstractTextEditor::autoRepeatKey()
 
     commitPreedit();
 
+    if (not d->auto_repeat.hold_time.isValid()) {
+        d->auto_repeat.hold_time.start();
+    }
+
+    const int direction(d->auto_repeat.key == Qt::Key_Right ? 1 : -1);
+    const int length(d->text->surroundingLength());
+    const int offset(qBound<int>(0, d->text->surroundingOffset(), length));
+    int steps = 1;
+
+    // Without surrounding text (terminals, plain X clients) there is nothing
+    // to batch against, so such hosts keep getting one key event per repeat:
+    if (d->auto_repeat.accelerated
+        and length > 0
+        and (d->auto_repeat.key == Qt::Key_Backspace
+             or d->auto_repeat.key == Qt::Key_Left
+             or d->auto_repeat.key == Qt::Key_Right)) {
+        const qint64 hold_time(d->auto_repeat.hold_time.elapsed());
+        steps = qBound<int>(1, 1 + (hold_time - AccelerationStart) / AccelerationStep, MaxRepeatSteps);
+
+        if (hold_time >= WordRepeatStart) {
+            steps = qMax(1, distanceToWordBoundary(*d->text, direction));
+        }
+
+        steps = qMin(steps, direction > 0 ? length - offset : offset);
+    }
+
     if (d->auto_repeat.key == Qt::Key_Space) {
         sendCommitString(" ");
+    } else if (steps > 1) {
+        if (direction > 0) {
+            moveCursor(steps);
+            d->text->setSurroundingOffset(offset + steps);
+        } else if (d->auto_repeat.key == Qt::Key_Left) {
+            moveCursor(-steps);
+            d->text->setSurroundingOffset(offset - steps);
+        } else {
+            deleteSurroundingText(steps);
+            // Keep text model in sync until application reports back:
+            d->text->replaceSurrounding(offset - steps, steps, QString());
+        }
     } else {
         sendKeyEvent(KeyStatePressed, d->auto_repeat.key, Qt::NoModifier);
     }
@@ -761,6 +935,32 @@ void AbstractTextEditor::autoRepeatKey()
     d->auto_repeat.timer.start(d->auto_repeat.interval);
 }
 
+//! \brief Deletes text left of the cursor in application.
+//! \param length Number of characters to delete.
+//!
+//! The default implementation sends one backspace key event per
+//! character. Reimplement to delete with a single call.
+void AbstractTextEditor::deleteSurroundingText(int length)
+{
+    for (int index = 0; index < length; ++index) {
+        sendKeyEvent(KeyStatePressed, Qt::Key_Backspace, Qt::NoModifier);
+    }
+}
+
+//! \brief Moves the cursor in application.
+//! \param steps Number of characters to move, negative values move left.
+//!
+//! The default implementation sends one arrow key event per character.
+//! Reimplement to move with a single call.
+void AbstractTextEditor::moveCursor(int steps)
+{
+    const Qt::Key key(steps < 0 ? Qt::Key_Left : Qt::Key_Right);
+
+    for (int index = 0; index < qAbs(steps); ++index) {
+        sendKeyEvent(KeyStatePressed, key, Qt::NoModifier);
+    }
+}
+
 //! \brief Emits wordCandidatesChanged() signal with current preedit
 //! as a candidate.
 void AbstractTextEditor::showUserCandidate()
@@ -813,15 +1013,27 @@ void AbstractTextEditor::onCursorPositionChanged(int cursor_position,
     Q_D(AbstractTextEditor);
     Replacement r;
 
-    if (not extractWordBoundariesAtCursor(surrounding_text, cursor_position, &r)) {
+    // Only look at the text around the cursor to find out whether this is
+    // the update we expect after activating a preedit:
+    const bool expected_update(d->ignore_next_cursor_position == cursor_position
+                               and d->ignore_next_surrounding_length == surrounding_text.length()
+                               and d->ignore_next_surrounding_window
+                                   == surrounding_text.mid(cursor_position - ExpectedSurroundingWindow,
+                                                           2 * ExpectedSurroundingWindow));
+
+    // Only copies the part that differs from the text model:
+    d->text->setSurrounding(surrounding_text);
+    d->text->setSurroundingOffset(qMax(0, cursor_position));
+
+    if (not extractWordBoundariesAtCursor(*d->text, &r)) {
         return;
     }
 
     if (r.start < 0 or r.length < 0) {
-        if (d->ignore_next_surrounding_text == surrounding_text and
-            d->ignore_next_cursor_position == cursor_position) {
-            d->ignore_next_surrounding_text.clear();
+        if (expected_update) {
             d->ignore_next_cursor_position = -1;
+            d->ignore_next_surrounding_length = -1;
+            d->ignore_next_surrounding_window.clear();
         } else {
             d->text->setPreedit("");
             d->text->setCursorPosition(0);
@@ -829,7 +1041,7 @@ void AbstractTextEditor::onCursorPositionChanged(int cursor_position,
     } else {
         const int cursor_pos_relative_word_begin(r.start - r.cursor_position);
         const int word_begin_relative_cursor_pos(r.cursor_position - r.start);
-        const QString word(surrounding_text.mid(r.start, r.length));
+        const QString word(d->text->surroundingMid(r.start, r.length));
         Replacement word_r(cursor_pos_relative_word_begin, r.length,
                            word_begin_relative_cursor_pos);
 
@@ -840,9 +1052,14 @@ void AbstractTextEditor::onCursorPositionChanged(int cursor_position,
         sendPreeditString(d->text->preedit(), d->text->preeditFace(), word_r);
         // Qt is going to send us an event with cursor position places
         // at the beginning of replaced word and surrounding text
-        // without the replaced word. We want to ignore it.
+        // without the replaced word. We want to ignore it. The word
+        // is in preedit now, so remove it from the surrounding text,
+        // too:
+        d->text->replaceSurrounding(r.start, r.length, QString());
         d->ignore_next_cursor_position = r.start;
-        d->ignore_next_surrounding_text = QString(surrounding_text).remove(r.start, r.length);
+        d->ignore_next_surrounding_length = d->text->surroundingLength();
+        d->ignore_next_surrounding_window = d->text->surroundingMid(r.start - ExpectedSurroundingWindow,
+                                                                    2 * ExpectedSurroundingWindow);
     }
 }
 
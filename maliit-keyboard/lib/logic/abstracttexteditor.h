@@ -117,11 +117,15 @@ public:
 
     void setAutoRepeatBehaviour(int auto_repeat_delay,
                                 int auto_repeat_interval);
+    bool isAutoRepeatAccelerated() const;
+    void setAutoRepeatAccelerated(bool accelerated);
 
     Q_SLOT void onKeyPressed(const Key &key);
     Q_SLOT void onKeyReleased(const Key &key);
     Q_SLOT void onKeyEntered(const Key &key);
     Q_SLOT void onKeyExited(const Key &key);
+    Q_SLOT void onGestureCompleted(const QVector<QPoint> &trajectory,
+                                   const KeyArea &key_area);
     Q_SLOT void onCursorPositionChanged(int cursor_position,
                                         const QString &surrounding_text);
     Q_SLOT void replacePreedit(const QString &replacement);
@@ -161,11 +165,16 @@ private:
     virtual void sendCommitString(const QString &commit) = 0;
     virtual void sendKeyEvent(KeyState state, Qt::Key key, Qt::KeyboardModifier modifier) = 0;
     virtual void invokeAction(const QString &action, const QString &key_sequence) = 0;
+    virtual void deleteSurroundingText(int length);
+    virtual void moveCursor(int steps);
 
     void commitPreedit();
     Q_SLOT void autoRepeatKey();
 };
 
+bool extractWordBoundariesAtCursor(const Model::Text &text,
+                                   AbstractTextEditor::Replacement *replacement);
+
 }} // namespace Logic, MaliitKeyboard
 
 #endif // MALIIT_KEYBOARD_ABSTRACTTEXTEDITOR_H
@@ -56,21 +56,68 @@ namespace Logic {
 //! Needs to be implemented by derived classes. Will not be called if engine
 //! is disabled or text model has no preedit.
 
+//! \fn WordCandidateList AbstractWordEngine::fetchGestureCandidates(const QVector<QPoint> &trajectory, const KeyArea &key_area)
+//! \brief Returns a list of words matching a shape-writing gesture.
+//! \param trajectory The touch points of the gesture, in key area coordinates.
+//! \param key_area The key area the gesture was drawn on.
+//!
+//! Can be implemented by derived classes, the default implementation
+//! returns no candidates. Will not be called if engine is disabled.
+
+//! \fn void AbstractWordEngine::fetchNextWordCandidates(Model::Text *text)
+//! \brief Starts predicting the word following the committed text.
+//! \param text The text model, without preedit.
+//!
+//! Can be implemented by derived classes, which then should report their
+//! results through setNextWordCandidates(), possibly asynchronously. The
+//! default implementation does nothing. Will not be called if engine or
+//! next word prediction is disabled.
+
 //! \property AbstractWordEngine::enabled
 //! \brief Whether the engine provides updates for word candidates.
 
+//! \property AbstractWordEngine::nextWordPredictionEnabled
+//! \brief Whether the engine offers candidates for the next word right
+//! after a word was committed.
+
+//! \property AbstractWordEngine::gestureTypingEnabled
+//! \brief Whether shape-writing gestures are in use. Engines can use it to
+//! only prepare their gesture lexicons when needed.
+
 class AbstractWordEnginePrivate
 {
 public:
     bool enabled;
+    bool next_word_prediction_enabled;
+    bool next_word_candidates_shown;
+    bool gesture_typing_enabled;
+    int computation_count;
+    qint64 computation_time; //!< In microseconds.
+    qint64 max_computation_time; //!< In microseconds.
 
     explicit AbstractWordEnginePrivate();
+    void addComputation(const QElapsedTimer &timer);
 };
 
 AbstractWordEnginePrivate::AbstractWordEnginePrivate()
     : enabled(false)
+    , next_word_prediction_enabled(false)
+    , next_word_candidates_shown(false)
+    , gesture_typing_enabled(false)
+    , computation_count(0)
+    , computation_time(0)
+    , max_computation_time(0)
 {}
 
+void AbstractWordEnginePrivate::addComputation(const QElapsedTimer &timer)
+{
+    const qint64 elapsed(timer.nsecsElapsed() / 1000);
+
+    ++computation_count;
+    computation_time += elapsed;
+    max_computation_time = qMax(max_computation_time, elapsed);
+}
+
 
 //! \brief Constructor.
 //! \param parent The owner of this instance. Can be 0, in case QObject
@@ -112,12 +159,59 @@ void AbstractWordEngine::setEnabled(bool enabled)
 }
 
 
+//! \brief Returns whether next word prediction is enabled.
+//! \sa AbstractWordEngine::nextWordPredictionEnabled
+bool AbstractWordEngine::isNextWordPredictionEnabled() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->next_word_prediction_enabled;
+}
+
+
+//! \brief Set whether the engine should predict the next word after commits.
+//! \sa AbstractWordEngine::nextWordPredictionEnabled
+void AbstractWordEngine::setNextWordPredictionEnabled(bool enabled)
+{
+    Q_D(AbstractWordEngine);
+
+    if (d->next_word_prediction_enabled != enabled) {
+        d->next_word_prediction_enabled = enabled;
+        Q_EMIT nextWordPredictionEnabledChanged(enabled);
+    }
+}
+
+
+//! \brief Returns whether gesture typing is enabled.
+//! \sa AbstractWordEngine::gestureTypingEnabled
+bool AbstractWordEngine::isGestureTypingEnabled() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->gesture_typing_enabled;
+}
+
+
+//! \brief Set whether gesture typing is enabled.
+//! \sa AbstractWordEngine::gestureTypingEnabled
+void AbstractWordEngine::setGestureTypingEnabled(bool enabled)
+{
+    Q_D(AbstractWordEngine);
+
+    if (d->gesture_typing_enabled != enabled) {
+        d->gesture_typing_enabled = enabled;
+        Q_EMIT gestureTypingEnabledChanged(enabled);
+    }
+}
+
+
 //! \brief Clears the current candidates.
 //!
 //! Only has an effect when word engine is enabled, in which case
 //! candidatesCanged() is emitted.
 void AbstractWordEngine::clearCandidates()
 {
+    Q_D(AbstractWordEngine);
+    d->next_word_candidates_shown = false;
+
     if (isEnabled()) {
         Q_EMIT candidatesChanged(WordCandidateList());
     }
@@ -130,6 +224,12 @@ void AbstractWordEngine::clearCandidates()
 //! Can trigger emission of candidatesChanged().
 void AbstractWordEngine::computeCandidates(Model::Text *text)
 {
+    Q_D(AbstractWordEngine);
+
+    // Next word candidates only make sense until the user starts typing:
+    const bool clear_next_word_candidates(d->next_word_candidates_shown);
+    d->next_word_candidates_shown = false;
+
     // FIXME: add possiblity to turn off the error correction for
     // entries that does not need it (like password entries).  Also,
     // with that we probably will want to turn off preedit styling at
@@ -144,10 +244,94 @@ void AbstractWordEngine::computeCandidates(Model::Text *text)
         // editor to send no formatting informations along with
         // preedit string. When this is done, preedit-string test
         // needs to be adapted.
+        if (clear_next_word_candidates) {
+            clearCandidates();
+        }
+
         return;
     }
 
-    Q_EMIT candidatesChanged(fetchCandidates(text));
+    QElapsedTimer timer;
+    timer.start();
+    const WordCandidateList candidates(fetchCandidates(text));
+    d->addComputation(timer);
+
+    Q_EMIT candidatesChanged(candidates);
+}
+
+//! \brief Computes candidates for a shape-writing gesture.
+//! \param trajectory The touch points of the gesture, in key area coordinates.
+//! \param key_area The key area the gesture was drawn on.
+//! \return the candidates, best match first.
+//!
+//! Can trigger emission of candidatesChanged().
+WordCandidateList AbstractWordEngine::computeGestureCandidates(const QVector<QPoint> &trajectory,
+                                                               const KeyArea &key_area)
+{
+    Q_D(AbstractWordEngine);
+
+    if (not isEnabled()) {
+        return WordCandidateList();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const WordCandidateList candidates(fetchGestureCandidates(trajectory, key_area));
+    d->addComputation(timer);
+
+    if (not candidates.isEmpty()) {
+        Q_EMIT candidatesChanged(candidates);
+    }
+
+    return candidates;
+}
+
+//! \brief Predicts candidates for the word following the committed text.
+//! \param text The text model, without preedit.
+//!
+//! Candidates are reported through candidatesChanged(), possibly after this
+//! method returned.
+void AbstractWordEngine::computeNextWordCandidates(Model::Text *text)
+{
+    if (not isEnabled()
+        || not isNextWordPredictionEnabled()
+        || not text
+        || not text->preedit().isEmpty()) {
+        return;
+    }
+
+    fetchNextWordCandidates(text);
+}
+
+//! \brief Shows candidates for the next word.
+//! \param candidates The predicted words.
+//!
+//! To be used by derived classes. Candidates are cleared again as soon as
+//! the user types something which does not produce new candidates.
+void AbstractWordEngine::setNextWordCandidates(const WordCandidateList &candidates)
+{
+    Q_D(AbstractWordEngine);
+
+    if (not isEnabled() || candidates.isEmpty()) {
+        return;
+    }
+
+    d->next_word_candidates_shown = true;
+    Q_EMIT candidatesChanged(candidates);
+}
+
+void AbstractWordEngine::fetchNextWordCandidates(Model::Text *text)
+{
+    Q_UNUSED(text);
+}
+
+WordCandidateList AbstractWordEngine::fetchGestureCandidates(const QVector<QPoint> &trajectory,
+                                                             const KeyArea &key_area)
+{
+    Q_UNUSED(trajectory);
+    Q_UNUSED(key_area);
+
+    return WordCandidateList();
 }
 
 //! \brief Adds a word to user dictionary.
@@ -159,4 +343,46 @@ void AbstractWordEngine::addToUserDictionary(const QString &word)
     Q_UNUSED(word);
 }
 
+//! \brief Switches the engine to another language.
+//! \param language The language attribute of the active layout.
+//!
+//! Needs to be implemented in derived classes. This does nothing.
+void AbstractWordEngine::setLanguage(const QString &language)
+{
+    Q_UNUSED(language);
+}
+
+//! \brief Returns how often candidates were computed for preedits and
+//! gestures.
+int AbstractWordEngine::candidateComputationCount() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->computation_count;
+}
+
+//! \brief Returns the total time spent computing candidates, in
+//! microseconds.
+qint64 AbstractWordEngine::candidateComputationTime() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->computation_time;
+}
+
+//! \brief Returns the longest single candidate computation, in
+//! microseconds.
+qint64 AbstractWordEngine::maxCandidateComputationTime() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->max_computation_time;
+}
+
+//! \brief Returns the estimated heap usage of dictionaries and prediction
+//! backends, in bytes.
+//!
+//! Can be implemented by derived classes, this returns 0.
+qint64 AbstractWordEngine::memoryUsage() const
+{
+    return 0;
+}
+
 }} // namespace MaliitKeyboard, Logic
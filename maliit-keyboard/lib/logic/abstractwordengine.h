@@ -34,6 +34,7 @@
 
 #include "models/text.h"
 #include "models/wordcandidate.h"
+#include "models/keyarea.h"
 #include <QtCore>
 
 namespace MaliitKeyboard {
@@ -51,6 +52,12 @@ class AbstractWordEngine
     Q_PROPERTY(bool enabled READ isEnabled
                             WRITE setEnabled
                             NOTIFY enabledChanged)
+    Q_PROPERTY(bool nextWordPredictionEnabled READ isNextWordPredictionEnabled
+                                              WRITE setNextWordPredictionEnabled
+                                              NOTIFY nextWordPredictionEnabledChanged)
+    Q_PROPERTY(bool gestureTypingEnabled READ isGestureTypingEnabled
+                                         WRITE setGestureTypingEnabled
+                                         NOTIFY gestureTypingEnabledChanged)
 
 public:
     explicit AbstractWordEngine(QObject *parent = 0);
@@ -60,14 +67,39 @@ public:
     Q_SLOT virtual void setEnabled(bool enabled);
     Q_SIGNAL void enabledChanged(bool enabled);
 
+    bool isNextWordPredictionEnabled() const;
+    Q_SLOT void setNextWordPredictionEnabled(bool enabled);
+    Q_SIGNAL void nextWordPredictionEnabledChanged(bool enabled);
+
+    bool isGestureTypingEnabled() const;
+    Q_SLOT virtual void setGestureTypingEnabled(bool enabled);
+    Q_SIGNAL void gestureTypingEnabledChanged(bool enabled);
+
     void clearCandidates();
     void computeCandidates(Model::Text *text);
     Q_SIGNAL void candidatesChanged(const WordCandidateList &candidates);
 
+    WordCandidateList computeGestureCandidates(const QVector<QPoint> &trajectory,
+                                               const KeyArea &key_area);
+    void computeNextWordCandidates(Model::Text *text);
+
     virtual void addToUserDictionary(const QString &word);
+    Q_SLOT virtual void setLanguage(const QString &language);
+
+    int candidateComputationCount() const;
+    qint64 candidateComputationTime() const;
+    qint64 maxCandidateComputationTime() const;
+
+    virtual qint64 memoryUsage() const;
+
+protected:
+    void setNextWordCandidates(const WordCandidateList &candidates);
 
 private:
     virtual WordCandidateList fetchCandidates(Model::Text *text) = 0;
+    virtual void fetchNextWordCandidates(Model::Text *text);
+    virtual WordCandidateList fetchGestureCandidates(const QVector<QPoint> &trajectory,
+                                                     const KeyArea &key_area);
     const QScopedPointer<AbstractWordEnginePrivate> d_ptr;
 };
 
@@ -0,0 +1,411 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "candidatefusion.h"
+
+#include <algorithm>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+// Relative trust in each backend, used to normalize scores across them.
+// A word suggested by several backends accumulates their scores.
+const qreal BackendWeights[CandidateFusion::BackendCount] = {
+    0.8, // Presage
+    0.9, // Hunspell, only consulted for misspelled words
+    1.0, // User dictionary
+};
+
+const WordCandidate::Source BackendSources[CandidateFusion::BackendCount] = {
+    WordCandidate::SourcePrediction,
+    WordCandidate::SourceSpellChecking,
+    WordCandidate::SourceUserDictionary,
+};
+
+//! Results of one query. Shared with the backend jobs, as those might
+//! finish after the time budget ran out.
+class Query
+{
+public:
+    QMutex mutex;
+    QSemaphore finished;
+    const QString preedit;
+    QStringList words[CandidateFusion::BackendCount];
+    bool done[CandidateFusion::BackendCount];
+    bool misspelled;
+
+    explicit Query(const QString &preedit);
+    void publish(CandidateFusion::Backend backend,
+                 const QStringList &result,
+                 bool is_misspelled);
+};
+
+typedef QSharedPointer<Query> SharedQuery;
+
+Query::Query(const QString &new_preedit)
+    : mutex()
+    , finished()
+    , preedit(new_preedit)
+    , misspelled(false)
+{
+    for (int index = 0; index < CandidateFusion::BackendCount; ++index) {
+        done[index] = false;
+    }
+}
+
+void Query::publish(CandidateFusion::Backend backend,
+                    const QStringList &result,
+                    bool is_misspelled)
+{
+    QMutexLocker locker(&mutex);
+
+    words[backend] = result;
+    done[backend] = true;
+
+    if (backend == CandidateFusion::BackendSpellChecker) {
+        misspelled = is_misspelled;
+    }
+
+    finished.release();
+}
+
+//! Most recent result of a backend, possibly for an earlier keystroke.
+struct LateResult
+{
+    bool available;
+    QString preedit;
+    QStringList words;
+
+    LateResult()
+        : available(false)
+        , preedit()
+        , words()
+    {}
+};
+
+struct ScoredCandidate
+{
+    CandidateFusion::Candidate candidate;
+    qreal best_contribution;
+};
+
+bool higherScore(const ScoredCandidate &lhs,
+                 const ScoredCandidate &rhs)
+{
+    return lhs.candidate.score > rhs.candidate.score;
+}
+
+// Rank-based scores normalized to [0, weight] per backend, summed per word.
+QList<CandidateFusion::Candidate> fuseResults(const QStringList *results)
+{
+    QList<ScoredCandidate> scored;
+    QHash<QString, int> index_of;
+
+    for (int backend = 0; backend < CandidateFusion::BackendCount; ++backend) {
+        const QStringList &words(results[backend]);
+
+        for (int rank = 0; rank < words.count(); ++rank) {
+            const qreal contribution(BackendWeights[backend] * (words.count() - rank) / words.count());
+            const QString key(words.at(rank).toLower());
+            QHash<QString, int>::const_iterator it(index_of.constFind(key));
+
+            if (it == index_of.constEnd()) {
+                ScoredCandidate scored_candidate;
+                scored_candidate.candidate.word = words.at(rank);
+                scored_candidate.candidate.score = contribution;
+                scored_candidate.candidate.source = BackendSources[backend];
+                scored_candidate.best_contribution = contribution;
+                index_of.insert(key, scored.count());
+                scored.append(scored_candidate);
+            } else {
+                ScoredCandidate &scored_candidate(scored[it.value()]);
+                scored_candidate.candidate.score += contribution;
+
+                if (contribution > scored_candidate.best_contribution) {
+                    scored_candidate.best_contribution = contribution;
+                    scored_candidate.candidate.source = BackendSources[backend];
+                }
+            }
+        }
+    }
+
+    std::stable_sort(scored.begin(), scored.end(), higherScore);
+
+    QList<CandidateFusion::Candidate> candidates;
+    Q_FOREACH (const ScoredCandidate &scored_candidate, scored) {
+        candidates.append(scored_candidate.candidate);
+    }
+
+    return candidates;
+}
+
+} // unnamed namespace
+
+class CandidateFusionPrivate
+{
+public:
+    int time_budget; //!< In milliseconds, negative for no limit.
+    QThreadPool pool;
+    QAtomicInt busy[CandidateFusion::BackendCount]; //!< Whether a backend still works on a previous query.
+    SharedQuery query;
+    QElapsedTimer timer;
+    int started;
+    bool requested[CandidateFusion::BackendCount];
+    QMutex late_mutex; //!< Guards late_results.
+    LateResult late_results[CandidateFusion::BackendCount];
+
+    explicit CandidateFusionPrivate(int new_time_budget);
+};
+
+CandidateFusionPrivate::CandidateFusionPrivate(int new_time_budget)
+    : time_budget(new_time_budget)
+    , pool()
+    , query()
+    , timer()
+    , started(0)
+    , late_mutex()
+{
+    // Busy flags guarantee at most one job per backend:
+    pool.setMaxThreadCount(CandidateFusion::BackendCount);
+
+    for (int index = 0; index < CandidateFusion::BackendCount; ++index) {
+        requested[index] = false;
+    }
+}
+
+namespace {
+
+//! Runs a backend job on the thread pool. Keeps its result for later
+//! keystrokes and clears the busy flag of its backend when done.
+class FusionRunnable
+    : public QRunnable
+{
+public:
+    explicit FusionRunnable(CandidateFusionPrivate *fusion,
+                            CandidateFusion::Backend backend,
+                            const SharedQuery &query,
+                            CandidateFusion::Job *job);
+    void run();
+
+private:
+    CandidateFusionPrivate *const m_fusion;
+    const CandidateFusion::Backend m_backend;
+    const SharedQuery m_query;
+    const QScopedPointer<CandidateFusion::Job> m_job;
+};
+
+FusionRunnable::FusionRunnable(CandidateFusionPrivate *fusion,
+                               CandidateFusion::Backend backend,
+                               const SharedQuery &query,
+                               CandidateFusion::Job *job)
+    : QRunnable()
+    , m_fusion(fusion)
+    , m_backend(backend)
+    , m_query(query)
+    , m_job(job)
+{}
+
+void FusionRunnable::run()
+{
+    bool misspelled = false;
+    const QStringList words(m_job->run(&misspelled));
+
+    {
+        QMutexLocker locker(&m_fusion->late_mutex);
+        LateResult &late_result(m_fusion->late_results[m_backend]);
+        late_result.available = true;
+        late_result.preedit = m_query->preedit;
+        late_result.words = words;
+    }
+
+    m_query->publish(m_backend, words, misspelled);
+    m_fusion->busy[m_backend].fetchAndStoreRelease(0);
+}
+
+} // unnamed namespace
+
+//! \class CandidateFusion
+//! \brief Queries word backends in parallel and merges their results by
+//! score.
+//!
+//! Each keystroke starts a query with begin(), submits one job per backend
+//! with start() and collects the fused candidates with finish(), which
+//! waits at most for the time budget. A backend still working on an
+//! earlier query is not queried again; its most recent result is used
+//! instead, as long as it was for a prefix of the current preedit. That
+//! way, a backend which is always slower than the time budget still
+//! contributes, one keystroke late.
+
+//! \class CandidateFusion::Job
+//! \brief A query of one backend, run on a worker thread.
+
+//! \fn QStringList CandidateFusion::Job::run(bool *misspelled)
+//! \brief Returns the words suggested by the backend, best first.
+//! \param misspelled Spell checking backends set it to true if the
+//!                   preedit is misspelled.
+
+CandidateFusion::Job::~Job()
+{}
+
+//! \param time_budget How long finish() waits for backends, in
+//!                    milliseconds, counted from begin().
+CandidateFusion::CandidateFusion(int time_budget)
+    : d_ptr(new CandidateFusionPrivate(time_budget))
+{}
+
+CandidateFusion::~CandidateFusion()
+{
+    // Running jobs refer to the private instance:
+    waitForDone();
+}
+
+//! \brief Changes how long finish() waits for backends.
+//! \param time_budget In milliseconds, counted from begin(). A negative
+//!                    budget waits for all started backends, which
+//!                    benchmarks use to time the backends themselves.
+void CandidateFusion::setTimeBudget(int time_budget)
+{
+    Q_D(CandidateFusion);
+    d->time_budget = time_budget;
+}
+
+//! \brief Starts a new query, for one keystroke.
+//! \param preedit The word being typed.
+void CandidateFusion::begin(const QString &preedit)
+{
+    Q_D(CandidateFusion);
+
+    d->query = SharedQuery(new Query(preedit));
+    d->timer.start();
+    d->started = 0;
+
+    for (int index = 0; index < BackendCount; ++index) {
+        d->requested[index] = false;
+    }
+}
+
+//! \brief Queries a backend for the current query.
+//! \param backend The backend the job belongs to.
+//! \param job The query to run, ownership is taken.
+//! \return false if the backend is still busy with an earlier query, in
+//!         which case the job is dropped.
+bool CandidateFusion::start(Backend backend,
+                            Job *job)
+{
+    Q_D(CandidateFusion);
+
+    if (d->query.isNull()) {
+        delete job;
+        return false;
+    }
+
+    d->requested[backend] = true;
+
+    if (not d->busy[backend].testAndSetAcquire(0, 1)) {
+        delete job;
+        return false;
+    }
+
+    d->pool.start(new FusionRunnable(d, backend, d->query, job));
+    ++d->started;
+    return true;
+}
+
+//! \brief Waits for the started backends, up to the time budget, and
+//! returns the fused candidates, best first.
+//! \param misspelled Set to whether the spell checker found the preedit
+//!                   to be misspelled, within the time budget.
+QList<CandidateFusion::Candidate> CandidateFusion::finish(bool *misspelled)
+{
+    Q_D(CandidateFusion);
+
+    if (misspelled) {
+        *misspelled = false;
+    }
+
+    if (d->query.isNull()) {
+        return QList<Candidate>();
+    }
+
+    if (d->time_budget < 0) {
+        d->query->finished.acquire(d->started);
+    }
+
+    for (int index = 0; d->time_budget >= 0 && index < d->started; ++index) {
+        const int remaining(d->time_budget - static_cast<int>(d->timer.elapsed()));
+        if (remaining <= 0 || not d->query->finished.tryAcquire(1, remaining)) {
+            break;
+        }
+    }
+
+    QStringList results[BackendCount];
+    bool done[BackendCount];
+
+    {
+        QMutexLocker locker(&d->query->mutex);
+
+        for (int backend = 0; backend < BackendCount; ++backend) {
+            done[backend] = d->query->done[backend];
+            results[backend] = d->query->words[backend];
+        }
+
+        if (misspelled) {
+            *misspelled = d->query->misspelled;
+        }
+    }
+
+    {
+        QMutexLocker locker(&d->late_mutex);
+
+        for (int backend = 0; backend < BackendCount; ++backend) {
+            const LateResult &late_result(d->late_results[backend]);
+
+            if (d->requested[backend] && not done[backend] && late_result.available
+                && d->query->preedit.startsWith(late_result.preedit)) {
+                results[backend] = late_result.words;
+            }
+        }
+    }
+
+    d->query.clear();
+    return fuseResults(results);
+}
+
+//! \brief Waits until all backend jobs, including late ones, are done.
+void CandidateFusion::waitForDone()
+{
+    Q_D(CandidateFusion);
+    d->pool.waitForDone();
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,87 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_CANDIDATEFUSION_H
+#define MALIIT_KEYBOARD_CANDIDATEFUSION_H
+
+#include "models/wordcandidate.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+class CandidateFusionPrivate;
+
+class CandidateFusion
+{
+    Q_DISABLE_COPY(CandidateFusion)
+    Q_DECLARE_PRIVATE(CandidateFusion)
+
+public:
+    enum Backend {
+        BackendPresage,
+        BackendSpellChecker,
+        BackendUserDictionary,
+        BackendCount
+    };
+
+    class Job
+    {
+    public:
+        virtual ~Job();
+        virtual QStringList run(bool *misspelled) = 0;
+    };
+
+    struct Candidate
+    {
+        QString word;
+        qreal score;
+        WordCandidate::Source source;
+    };
+
+    explicit CandidateFusion(int time_budget);
+    ~CandidateFusion();
+
+    void setTimeBudget(int time_budget);
+    void begin(const QString &preedit);
+    bool start(Backend backend,
+               Job *job);
+    QList<Candidate> finish(bool *misspelled = 0);
+    void waitForDone();
+
+private:
+    const QScopedPointer<CandidateFusionPrivate> d_ptr;
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_CANDIDATEFUSION_H
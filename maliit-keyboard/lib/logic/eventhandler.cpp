@@ -31,7 +31,10 @@
 
 #include "eventhandler.h"
 #include "layoutupdater.h"
+#include "gesturedecoder.h"
+#include "sessionrecorder.h"
 #include "models/layout.h"
+#include "tracer.h"
 
 namespace MaliitKeyboard {
 namespace Logic {
@@ -41,9 +44,16 @@ class EventHandlerPrivate
 public:
     Model::Layout * const layout;
     LayoutUpdater * const updater;
+    bool gesture_typing_enabled;
+    SessionRecorder *recorder;
+    int pressed_index; //!< Key that started the current touch, or -1.
+    bool gesture_active;
+    QVector<QPoint> trajectory;
+    int hit_test_count;
 
     explicit EventHandlerPrivate(Model::Layout * const new_layout,
                                  LayoutUpdater * const new_updater);
+    void resetGesture();
 };
 
 
@@ -51,11 +61,24 @@ EventHandlerPrivate::EventHandlerPrivate(Model::Layout *const new_layout,
                                          LayoutUpdater *const new_updater)
     : layout(new_layout)
     , updater(new_updater)
+    , gesture_typing_enabled(false)
+    , recorder(0)
+    , pressed_index(-1)
+    , gesture_active(false)
+    , trajectory()
+    , hit_test_count(0)
 {
     Q_ASSERT(new_layout != 0);
     Q_ASSERT(new_updater != 0);
 }
 
+void EventHandlerPrivate::resetGesture()
+{
+    pressed_index = -1;
+    gesture_active = false;
+    trajectory.clear();
+}
+
 
 //! \brief Performs event handling for Model::Layout instance, using a LayoutUpdater instance.
 //!
@@ -83,6 +106,11 @@ void EventHandler::onEntered(int index)
 {
     Q_D(EventHandler);
 
+    if (d->recorder) {
+        d->recorder->recordKeyEvent(SessionRecorder::EventEntered, index);
+    }
+
+    ++d->hit_test_count;
     const QVector<Key> &keys(d->layout->keyArea().keys());
 
     if (index >= keys.count()) {
@@ -92,7 +120,8 @@ void EventHandler::onEntered(int index)
         return;
     }
 
-    const Key &key(keys.at(index));
+    // Copied, as replaceKey() modifies the layout's keys in place:
+    const Key key(keys.at(index));
 
     const Key pressed_key(d->updater->modifyKey(key, KeyDescription::PressedState));
     d->layout->replaceKey(index, pressed_key);
@@ -106,6 +135,11 @@ void EventHandler::onExited(int index)
 {
     Q_D(EventHandler);
 
+    if (d->recorder) {
+        d->recorder->recordKeyEvent(SessionRecorder::EventExited, index);
+    }
+
+    ++d->hit_test_count;
     const QVector<Key> &keys(d->layout->keyArea().keys());
 
     if (index >= keys.count()) {
@@ -115,7 +149,8 @@ void EventHandler::onExited(int index)
         return;
     }
 
-    const Key &key(keys.at(index));
+    // Copied, as replaceKey() modifies the layout's keys in place:
+    const Key key(keys.at(index));
 
     const Key normal_key(d->updater->modifyKey(key, KeyDescription::NormalState));
     d->layout->replaceKey(index, normal_key);
@@ -127,8 +162,14 @@ void EventHandler::onExited(int index)
 
 void EventHandler::onPressed(int index)
 {
+    MALIIT_TRACE_SCOPE("EventHandler::onPressed");
     Q_D(EventHandler);
 
+    if (d->recorder) {
+        d->recorder->recordKeyEvent(SessionRecorder::EventPressed, index);
+    }
+
+    ++d->hit_test_count;
     const QVector<Key> &keys(d->layout->keyArea().keys());
 
     if (index >= keys.count()) {
@@ -140,6 +181,13 @@ void EventHandler::onPressed(int index)
 
     const Key &key(keys.at(index));
 
+    d->resetGesture();
+    if (d->gesture_typing_enabled && key.action() == Key::ActionInsert) {
+        d->pressed_index = index;
+        d->trajectory.append(key.rect().center());
+    }
+
+    // Last use of key, replaceKey() modifies the layout's keys in place:
     const Key pressed_key(d->updater->modifyKey(key, KeyDescription::PressedState));
     d->layout->replaceKey(index, pressed_key);
     d->updater->onKeyPressed(pressed_key);
@@ -150,8 +198,14 @@ void EventHandler::onPressed(int index)
 
 void EventHandler::onReleased(int index)
 {
+    MALIIT_TRACE_SCOPE("EventHandler::onReleased");
     Q_D(EventHandler);
 
+    if (d->recorder) {
+        d->recorder->recordKeyEvent(SessionRecorder::EventReleased, index);
+    }
+
+    ++d->hit_test_count;
     const QVector<Key> &keys(d->layout->keyArea().keys());
 
     if (index >= keys.count()) {
@@ -163,6 +217,17 @@ void EventHandler::onReleased(int index)
 
     const Key &key(keys.at(index));
 
+    if (d->gesture_active) {
+        // Key was already reset to normal state when gesture started.
+        const QVector<QPoint> trajectory(d->trajectory);
+        d->resetGesture();
+
+        Q_EMIT gestureCompleted(trajectory, d->layout->keyArea());
+        return;
+    }
+
+    d->resetGesture();
+
     const Key normal_key(d->updater->modifyKey(key, KeyDescription::NormalState));
     d->layout->replaceKey(index, normal_key);
     d->updater->onKeyReleased(normal_key);
@@ -175,6 +240,11 @@ void EventHandler::onPressAndHold(int index)
 {
     Q_D(EventHandler);
 
+    if (d->recorder) {
+        d->recorder->recordKeyEvent(SessionRecorder::EventPressAndHold, index);
+    }
+
+    ++d->hit_test_count;
     const QVector<Key> &keys(d->layout->keyArea().keys());
 
     if (index >= keys.count()) {
@@ -184,7 +254,8 @@ void EventHandler::onPressAndHold(int index)
         return;
     }
 
-    const Key &key(keys.at(index));
+    // Copied, as the slots may rebuild layouts:
+    const Key key(keys.at(index));
 
     // FIXME: long-press on space needs to work again to save words to dictionary!
     if (key.hasExtendedKeys()) {
@@ -195,4 +266,84 @@ void EventHandler::onPressAndHold(int index)
 }
 
 
+//! \brief Tracks the touch point while a key is held down.
+//! \param index The key that received the press.
+//! \param x Horizontal touch position, relative to the key.
+//! \param y Vertical touch position, relative to the key.
+//!
+//! With gesture typing enabled, a touch leaving the pressed key turns into a
+//! gesture: the key press is cancelled and, on release, gestureCompleted()
+//! is emitted instead of keyReleased().
+void EventHandler::onMoved(int index,
+                           int x,
+                           int y)
+{
+    Q_D(EventHandler);
+
+    if (d->pressed_index < 0 || index != d->pressed_index) {
+        return;
+    }
+
+    if (d->recorder) {
+        d->recorder->recordMoved(index, x, y);
+    }
+
+    ++d->hit_test_count;
+    const QVector<Key> &keys(d->layout->keyArea().keys());
+
+    if (index >= keys.count()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Invalid index:" << index
+                   << "Keys available:" << keys.count();
+        return;
+    }
+
+    const Key &key(keys.at(index));
+    d->trajectory.append(key.rect().topLeft() + QPoint(x, y));
+
+    if (not d->gesture_active && GestureDecoder::isGesture(d->trajectory, key.rect())) {
+        d->gesture_active = true;
+
+        const Key normal_key(d->updater->modifyKey(key, KeyDescription::NormalState));
+        d->layout->replaceKey(index, normal_key);
+        d->updater->clearActiveKeysAndMagnifier();
+    }
+}
+
+
+//! \brief Sets recorder for key events, or 0 to stop recording.
+//! Does not take ownership.
+void EventHandler::setSessionRecorder(SessionRecorder *recorder)
+{
+    Q_D(EventHandler);
+    d->recorder = recorder;
+}
+
+
+int EventHandler::hitTestCount() const
+{
+    Q_D(const EventHandler);
+    return d->hit_test_count;
+}
+
+
+bool EventHandler::isGestureTypingEnabled() const
+{
+    Q_D(const EventHandler);
+    return d->gesture_typing_enabled;
+}
+
+
+void EventHandler::setGestureTypingEnabled(bool enabled)
+{
+    Q_D(EventHandler);
+
+    if (d->gesture_typing_enabled != enabled) {
+        d->gesture_typing_enabled = enabled;
+        d->resetGesture();
+        Q_EMIT gestureTypingEnabledChanged(enabled);
+    }
+}
+
+
 }} // namespace Logic, MaliitKeyboard
@@ -32,12 +32,12 @@
 #ifndef MALIIT_KEYBOARD_EVENTHANDLER_H
 #define MALIIT_KEYBOARD_EVENTHANDLER_H
 
+#include "models/keyarea.h"
+
 #include <QtCore>
 
 namespace MaliitKeyboard {
 
-class Key;
-
 namespace Model {
 class Layout;
 }
@@ -45,6 +45,7 @@ class Layout;
 namespace Logic {
 
 class LayoutUpdater;
+class SessionRecorder;
 class EventHandlerPrivate;
 
 class EventHandler
@@ -53,6 +54,9 @@ class EventHandler
     Q_OBJECT
     Q_DISABLE_COPY(EventHandler)
     Q_DECLARE_PRIVATE(EventHandler)
+    Q_PROPERTY(bool gestureTypingEnabled READ isGestureTypingEnabled
+                                         WRITE setGestureTypingEnabled
+                                         NOTIFY gestureTypingEnabledChanged)
 
 public:
     explicit EventHandler(Model::Layout * const layout,
@@ -69,6 +73,19 @@ public:
     Q_INVOKABLE void onPressed(int index);
     Q_INVOKABLE void onReleased(int index);
     Q_INVOKABLE void onPressAndHold(int index);
+    Q_INVOKABLE void onMoved(int index,
+                             int x,
+                             int y);
+
+    void setSessionRecorder(SessionRecorder *recorder);
+
+    //! Number of touch events resolved to keys. The hit testing itself
+    //! happens in QML, which reports the hit key's index.
+    int hitTestCount() const;
+
+    bool isGestureTypingEnabled() const;
+    Q_SLOT void setGestureTypingEnabled(bool enabled);
+    Q_SIGNAL void gestureTypingEnabledChanged(bool enabled);
 
     // Key signals:
     Q_SIGNAL void keyPressed(const Key &key);
@@ -77,6 +94,10 @@ public:
     Q_SIGNAL void keyEntered(const Key &key);
     Q_SIGNAL void keyExited(const Key &key);
 
+    // Gesture signals:
+    Q_SIGNAL void gestureCompleted(const QVector<QPoint> &trajectory,
+                                   const KeyArea &key_area);
+
 private:
     const QScopedPointer<EventHandlerPrivate> d_ptr;
 };
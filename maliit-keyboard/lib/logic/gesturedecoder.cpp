@@ -0,0 +1,485 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "gesturedecoder.h"
+#include "memoryusage.h"
+
+#include <QTextCodec>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+//! Trajectory points used to align word letters along the gesture.
+const int AlignmentPoints = 64;
+
+//! Points compared between gesture shape and word template.
+const int TemplatePoints = 32;
+
+//! How far (in key widths) a letter's key may be away from the trajectory.
+const qreal KeyRadius = 1.0;
+
+struct TrieNode
+{
+    QChar letter;
+    int first_child;
+    int next_sibling;
+    int word; //!< Index into lexicon, or -1 if no word ends here.
+};
+
+struct SearchFrame
+{
+    int node;
+    int position; //!< Trajectory point the node's letter is aligned to.
+    int key;
+    int depth;
+};
+
+qreal squaredDistance(const QPointF &a,
+                      const QPointF &b)
+{
+    const QPointF d(a - b);
+    return d.x() * d.x() + d.y() * d.y();
+}
+
+qreal distance(const QPointF &a,
+               const QPointF &b)
+{
+    return qSqrt(squaredDistance(a, b));
+}
+
+// Resamples a polyline into count points, equidistant along its length.
+QVector<QPointF> resample(const QVector<QPointF> &points,
+                          int count)
+{
+    QVector<QPointF> result;
+    result.reserve(count);
+
+    if (points.isEmpty()) {
+        return result;
+    }
+
+    qreal length(0);
+    for (int index = 1; index < points.count(); ++index) {
+        length += distance(points.at(index - 1), points.at(index));
+    }
+
+    if (length <= 0 || count < 2) {
+        result.fill(points.first(), count);
+        return result;
+    }
+
+    const qreal step(length / (count - 1));
+    qreal walked(0);
+    result.append(points.first());
+
+    for (int index = 1; index < points.count() && result.count() < count; ++index) {
+        QPointF from(points.at(index - 1));
+        const QPointF &to(points.at(index));
+        qreal segment(distance(from, to));
+
+        while (walked + segment >= step && result.count() < count) {
+            const qreal t((step - walked) / segment);
+            from = from + (to - from) * t;
+            result.append(from);
+            segment = distance(from, to);
+            walked = 0;
+        }
+
+        walked += segment;
+    }
+
+    while (result.count() < count) {
+        result.append(points.last());
+    }
+
+    return result;
+}
+
+} // unnamed namespace
+
+//! \class GestureDecoder
+//! \brief Decodes shape-writing gestures into words.
+//!
+//! The lexicon is stored as a trie. Decoding walks the trie and aligns each
+//! letter with the first trajectory point near its key, after the point the
+//! previous letter was aligned to. Subtrees whose letter cannot be aligned
+//! are pruned, which keeps decoding fast even for large lexicons. The
+//! remaining words are ranked by comparing the gesture's shape with the
+//! polyline through their key centers.
+
+class GestureDecoderPrivate
+{
+public:
+    QVector<TrieNode> nodes;
+    QStringList words;
+
+    explicit GestureDecoderPrivate();
+    int child(int node,
+              const QChar &letter) const;
+    int addChild(int node,
+                 const QChar &letter);
+};
+
+GestureDecoderPrivate::GestureDecoderPrivate()
+    : nodes()
+    , words()
+{}
+
+int GestureDecoderPrivate::child(int node,
+                                 const QChar &letter) const
+{
+    for (int index = nodes.at(node).first_child; index >= 0; index = nodes.at(index).next_sibling) {
+        if (nodes.at(index).letter == letter) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+int GestureDecoderPrivate::addChild(int node,
+                                    const QChar &letter)
+{
+    TrieNode added;
+    added.letter = letter;
+    added.first_child = -1;
+    added.next_sibling = nodes.at(node).first_child;
+    added.word = -1;
+
+    nodes.append(added);
+    nodes[node].first_child = nodes.count() - 1;
+
+    return nodes.count() - 1;
+}
+
+
+GestureDecoder::GestureDecoder()
+    : d_ptr(new GestureDecoderPrivate)
+{}
+
+GestureDecoder::~GestureDecoder()
+{}
+
+//! \brief Replaces the lexicon.
+//! \param words The words to decode gestures into. If several words only
+//!              differ in case, the first one wins.
+void GestureDecoder::setLexicon(const QStringList &words)
+{
+    Q_D(GestureDecoder);
+
+    TrieNode root;
+    root.first_child = -1;
+    root.next_sibling = -1;
+    root.word = -1;
+
+    d->nodes.clear();
+    d->nodes.append(root);
+    d->words = words;
+
+    for (int word = 0; word < words.count(); ++word) {
+        const QString lower(words.at(word).toLower());
+        int node = 0;
+
+        Q_FOREACH (const QChar &letter, lower) {
+            const int next(d->child(node, letter));
+            node = (next < 0) ? d->addChild(node, letter) : next;
+        }
+
+        if (node != 0 && d->nodes.at(node).word < 0) {
+            d->nodes[node].word = word;
+        }
+    }
+
+    d->nodes.squeeze();
+}
+
+//! \brief Returns the number of words in the lexicon.
+int GestureDecoder::lexiconSize() const
+{
+    Q_D(const GestureDecoder);
+    return d->words.count();
+}
+
+//! \brief Returns the estimated heap usage of lexicon and trie, in bytes.
+qint64 GestureDecoder::memoryUsage() const
+{
+    Q_D(const GestureDecoder);
+    return (d->nodes.capacity() * sizeof(TrieNode)
+            + MemoryUsage::ofStringList(d->words));
+}
+
+//! \brief Finds the words best matching a gesture.
+//! \param trajectory The touch points of the gesture, in key area coordinates.
+//! \param key_area The key area the gesture was drawn on.
+//! \param limit Maximum number of words to return.
+//! \param visited_nodes Set to the number of trie nodes the search
+//!                      visited, which is what decoding time scales with.
+//! \return the matching words, best match first.
+QStringList GestureDecoder::decode(const QVector<QPoint> &trajectory,
+                                   const KeyArea &key_area,
+                                   int limit,
+                                   int *visited_nodes) const
+{
+    Q_D(const GestureDecoder);
+
+    QStringList result;
+
+    if (visited_nodes) {
+        *visited_nodes = 0;
+    }
+
+    if (trajectory.count() < 2 || d->nodes.count() < 2 || limit <= 0) {
+        return result;
+    }
+
+    QHash<QChar, int> key_index;
+    QVector<QPointF> centers;
+    qreal total_width(0);
+
+    // Geometry and actions come from the packed columns, only letter keys
+    // get looked at:
+    const QVector<Key> &keys(key_area.keys());
+    const QVector<QRect> &rects(key_area.keyRects());
+    const QVector<quint8> &actions(key_area.keyActions());
+
+    for (int index = 0; index < keys.count(); ++index) {
+        if (actions.at(index) != Key::ActionInsert) {
+            continue;
+        }
+
+        const QString &text(keys.at(index).label().text());
+
+        if (text.length() == 1 && text.at(0).isLetter()) {
+            const QChar letter(text.at(0).toLower());
+
+            if (not key_index.contains(letter)) {
+                key_index.insert(letter, centers.count());
+                centers.append(QRectF(rects.at(index)).center());
+                total_width += rects.at(index).width();
+            }
+        }
+    }
+
+    if (centers.isEmpty()) {
+        return result;
+    }
+
+    const qreal key_width(total_width / centers.count());
+    const qreal squared_radius(key_width * KeyRadius * key_width * KeyRadius);
+
+    QVector<QPointF> raw;
+    raw.reserve(trajectory.count());
+    Q_FOREACH (const QPoint &point, trajectory) {
+        raw.append(point);
+    }
+
+    const QVector<QPointF> points(resample(raw, AlignmentPoints));
+    const QVector<QPointF> shape(resample(points, TemplatePoints));
+    const QPointF &last_point(points.last());
+
+    // next[key * AlignmentPoints + p]: first point >= p near key, or -1.
+    QVector<int> next(centers.count() * AlignmentPoints);
+    for (int key = 0; key < centers.count(); ++key) {
+        int nearest = -1;
+        for (int position = AlignmentPoints - 1; position >= 0; --position) {
+            if (squaredDistance(points.at(position), centers.at(key)) <= squared_radius) {
+                nearest = position;
+            }
+            next[key * AlignmentPoints + position] = nearest;
+        }
+    }
+
+    QVector<SearchFrame> stack;
+    QVector<int> path;
+    QList<QPair<qreal, int> > best; // (shape distance, word index), sorted.
+
+    for (int node = d->nodes.first().first_child; node >= 0; node = d->nodes.at(node).next_sibling) {
+        const int key(key_index.value(d->nodes.at(node).letter, -1));
+
+        if (key >= 0 && next.at(key * AlignmentPoints) == 0) {
+            const SearchFrame frame = { node, 0, key, 1 };
+            stack.append(frame);
+        }
+    }
+
+    while (not stack.isEmpty()) {
+        const SearchFrame frame(stack.last());
+        stack.pop_back();
+
+        if (visited_nodes) {
+            ++*visited_nodes;
+        }
+
+        // Parents are always visited right before their children's
+        // subtrees, so path[0 .. depth - 2] holds the current prefix:
+        path.resize(frame.depth);
+        path[frame.depth - 1] = frame.key;
+
+        const TrieNode &node(d->nodes.at(frame.node));
+
+        if (node.word >= 0
+            && frame.depth >= 2
+            && squaredDistance(last_point, centers.at(frame.key)) <= squared_radius) {
+            QVector<QPointF> word_points;
+            Q_FOREACH (int key, path) {
+                if (word_points.isEmpty() || word_points.last() != centers.at(key)) {
+                    word_points.append(centers.at(key));
+                }
+            }
+
+            const QVector<QPointF> word_shape(resample(word_points, TemplatePoints));
+            qreal shape_distance(0);
+            for (int index = 0; index < TemplatePoints; ++index) {
+                shape_distance += distance(shape.at(index), word_shape.at(index));
+            }
+            shape_distance /= (TemplatePoints * key_width);
+
+            if (best.count() < limit || shape_distance < best.last().first) {
+                int position = 0;
+                while (position < best.count() && best.at(position).first <= shape_distance) {
+                    ++position;
+                }
+
+                best.insert(position, qMakePair(shape_distance, node.word));
+
+                if (best.count() > limit) {
+                    best.removeLast();
+                }
+            }
+        }
+
+        for (int child = node.first_child; child >= 0; child = d->nodes.at(child).next_sibling) {
+            const int key(key_index.value(d->nodes.at(child).letter, -1));
+
+            if (key < 0) {
+                continue;
+            }
+
+            const int position(next.at(key * AlignmentPoints + frame.position));
+
+            if (position >= 0) {
+                const SearchFrame child_frame = { child, position, key, frame.depth + 1 };
+                stack.append(child_frame);
+            }
+        }
+    }
+
+    for (int index = 0; index < best.count(); ++index) {
+        result.append(d->words.at(best.at(index).second));
+    }
+
+    return result;
+}
+
+//! \brief Tells whether a trajectory is a gesture rather than a tap.
+//! \param trajectory The touch points since the key was pressed.
+//! \param pressed_key The rectangle of the key that was pressed initially.
+//!
+//! A trajectory is a gesture once it left the pressed key by more than
+//! half a key size, to not mistake sloppy taps for gestures.
+// static
+bool GestureDecoder::isGesture(const QVector<QPoint> &trajectory,
+                               const QRect &pressed_key)
+{
+    const int dx(pressed_key.width() / 2);
+    const int dy(pressed_key.height() / 2);
+    const QRect tap_area(pressed_key.adjusted(-dx, -dy, dx, dy));
+
+    Q_FOREACH (const QPoint &point, trajectory) {
+        if (not tap_area.contains(point)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//! \brief Reads the word list of a Hunspell dictionary.
+//! \param dictionary_path The dictionary path without file extension, as
+//!                        used for SpellChecker.
+//! \return the stems listed in the dictionary's .dic file. Words containing
+//!         anything else than letters are skipped, as they cannot be drawn.
+// static
+QStringList GestureDecoder::lexiconFromDictionary(const QString &dictionary_path)
+{
+    QStringList words;
+    QByteArray encoding("ISO8859-1");
+
+    QFile aff(dictionary_path + ".aff");
+    if (aff.open(QIODevice::ReadOnly)) {
+        while (not aff.atEnd()) {
+            const QByteArray line(aff.readLine().trimmed());
+            if (line.startsWith("SET ")) {
+                encoding = line.mid(4).trimmed();
+                break;
+            }
+        }
+    }
+
+    QTextCodec *codec(QTextCodec::codecForName(encoding));
+    QFile dic(dictionary_path + ".dic");
+
+    if (not codec || not dic.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Cannot read dictionary:" << dictionary_path;
+        return words;
+    }
+
+    // First line holds the approximate word count.
+    words.reserve(dic.readLine().trimmed().toInt());
+
+    while (not dic.atEnd()) {
+        const QString line(codec->toUnicode(dic.readLine()));
+        const QString word(line.section('/', 0, 0).section('\t', 0, 0).trimmed());
+
+        if (word.length() < 2) {
+            continue;
+        }
+
+        bool drawable(true);
+        Q_FOREACH (const QChar &c, word) {
+            if (not c.isLetter()) {
+                drawable = false;
+                break;
+            }
+        }
+
+        if (drawable) {
+            words.append(word);
+        }
+    }
+
+    return words;
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,76 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_GESTUREDECODER_H
+#define MALIIT_KEYBOARD_GESTUREDECODER_H
+
+#include "models/keyarea.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+class GestureDecoderPrivate;
+
+class GestureDecoder
+{
+    Q_DISABLE_COPY(GestureDecoder)
+    Q_DECLARE_PRIVATE(GestureDecoder)
+
+public:
+    explicit GestureDecoder();
+    ~GestureDecoder();
+
+    void setLexicon(const QStringList &words);
+    int lexiconSize() const;
+    qint64 memoryUsage() const;
+
+    QStringList decode(const QVector<QPoint> &trajectory,
+                       const KeyArea &key_area,
+                       int limit = 5,
+                       int *visited_nodes = 0) const;
+
+    static bool isGesture(const QVector<QPoint> &trajectory,
+                          const QRect &pressed_key);
+    static QStringList lexiconFromDictionary(const QString &dictionary_path);
+
+private:
+    const QScopedPointer<GestureDecoderPrivate> d_ptr;
+};
+
+typedef QSharedPointer<GestureDecoder> SharedGestureDecoder;
+
+}} // namespace Logic, MaliitKeyboard
+
+Q_DECLARE_METATYPE(MaliitKeyboard::Logic::SharedGestureDecoder)
+
+#endif // MALIIT_KEYBOARD_GESTUREDECODER_H
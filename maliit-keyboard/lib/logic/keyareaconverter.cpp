@@ -37,6 +37,7 @@
 #include "models/keyarea.h"
 #include "models/key.h"
 #include "logic/keyboardloader.h"
+#include "tracer.h"
 
 #include <QtCore>
 
@@ -62,6 +63,8 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
                            LayoutHelper::Orientation orientation,
                            bool is_extended_keyarea = false)
 {
+    MALIIT_TRACE_SCOPE("KeyAreaConverter::createFromKeyboard");
+
     // An ad-hoc geometry updater that also uses styling information.
     KeyArea ka;
     Keyboard kb(source);
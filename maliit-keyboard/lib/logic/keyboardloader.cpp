@@ -36,63 +36,15 @@
 #include <QRegExp>
 
 #include "parser/layoutparser.h"
-#include "coreutils.h"
 
 #include "keyboardloader.h"
+#include "keyboardrepository.h"
 
 namespace {
 
 using namespace MaliitKeyboard;
 
-// For getting languages directory we use a function instead of global constant
-// because global constants are initialized before main runs. In this case that
-// would mean that CoreUtils::pluginDataDirectory is ran before any code in main
-// and it sets its static variable once. We want to be able to set the
-// environment variable altering behaviour of pluginDataDirectory for testing
-// purposes.
-QString getLanguagesDir()
-{
-    static QString languages_dir;
-
-    if (languages_dir.isEmpty()) {
-        // From http://doc.qt.nokia.com/4.7/qdir.html#separator: If you always
-        // use "/", Qt will translate your paths to conform to the underlying
-        // operating system.
-        languages_dir = CoreUtils::pluginDataDirectory() + "/languages";
-    }
-
-    return languages_dir;
-}
-
-typedef const QStringList (LayoutParser::*ParserFunc)() const;
-
-TagKeyboardPtr getTagKeyboard(const QString &id)
-{
-    if (id.isEmpty()) {
-        return TagKeyboardPtr();
-    }
-
-    const QString path(getLanguagesDir() + "/" + id + ".xml");
-    QFile file(path);
-
-    if (file.exists()) {
-        file.open(QIODevice::ReadOnly);
-
-        LayoutParser parser(&file);
-        const bool result(parser.parse());
-
-        file.close();
-        if (result) {
-            return parser.keyboard();
-        } else {
-            qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
-        }
-    } else {
-        qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
-    }
-
-    return TagKeyboardPtr();
-}
+typedef QStringList KeyboardImports::*ImportList;
 
 QPair<Key, KeyDescription> keyAndDescFromTags(const TagKeyPtr &key,
                                               const TagBindingPtr &binding,
@@ -311,64 +263,55 @@ QPair<TagKeyPtr, TagBindingPtr> getTagKeyAndBinding(const TagKeyboardPtr &keyboa
     return pair;
 }
 
-Keyboard getImportedKeyboard(const QString &id,
-                             ParserFunc func,
+Keyboard getImportedKeyboard(KeyboardRepository *repository,
+                             const QString &id,
+                             ImportList import_list,
                              const QString &file_prefix,
                              const QString &default_file,
                              int page = 0)
 {
-    QString path(getLanguagesDir() + "/" + id + ".xml");
-    QFile file(path);
+    const QString languages_dir(KeyboardRepository::languagesDirectory());
+    KeyboardImports all_imports;
 
-    if (file.exists()) {
-        file.open(QIODevice::ReadOnly);
+    // The repository parses the layout file only once and warns about
+    // missing or broken files:
+    if (repository->lookupImports(id, &all_imports)) {
+        const QStringList f_results(all_imports.*import_list);
 
-        LayoutParser parser(&file);
-        const bool result(parser.parse());
+        Q_FOREACH (const QString &f_result, f_results) {
+            const QFileInfo file_info(languages_dir + "/" + f_result);
 
-        file.close();
-        if (result) {
-            const QStringList f_results((parser.*func)());
-
-            Q_FOREACH (const QString &f_result, f_results) {
-                const QFileInfo file_info(getLanguagesDir() + "/" + f_result);
-
-                if (file_info.exists() and file_info.isFile()) {
-                    const TagKeyboardPtr keyboard(getTagKeyboard(file_info.baseName()));
-                    return getKeyboard(keyboard, false, page);
-                }
+            if (file_info.exists() and file_info.isFile()) {
+                const TagKeyboardPtr keyboard(repository->tagKeyboard(file_info.baseName()));
+                return getKeyboard(keyboard, false, page);
             }
+        }
 
-            // If we got there then it means that we got xml layout file that does not use
-            // new <import> syntax or just does not specify explicitly which file to import.
-            // In this case we have to search imports list for entry with filename beginning
-            // with file_prefix.
-            const QStringList imports(parser.imports());
-            const QRegExp file_regexp("^(" + file_prefix + ".*).xml$");
+        // If we got there then it means that we got xml layout file that does not use
+        // new <import> syntax or just does not specify explicitly which file to import.
+        // In this case we have to search imports list for entry with filename beginning
+        // with file_prefix.
+        const QStringList imports(all_imports.imports);
+        const QRegExp file_regexp("^(" + file_prefix + ".*).xml$");
 
-            Q_FOREACH (const QString &import, imports) {
-                if (file_regexp.exactMatch(import)) {
-                    QFileInfo file_info(getLanguagesDir() + "/" + import);
+        Q_FOREACH (const QString &import, imports) {
+            if (file_regexp.exactMatch(import)) {
+                QFileInfo file_info(languages_dir + "/" + import);
 
-                    if (file_info.exists() and file_info.isFile()) {
-                        const TagKeyboardPtr keyboard(getTagKeyboard(file_regexp.cap(1)));
-                        return getKeyboard(keyboard, false, page);
-                    }
+                if (file_info.exists() and file_info.isFile()) {
+                    const TagKeyboardPtr keyboard(repository->tagKeyboard(file_regexp.cap(1)));
+                    return getKeyboard(keyboard, false, page);
                 }
             }
+        }
 
-            // If we got there then we try to just load a file with name in default_file.
-            QFileInfo file_info(getLanguagesDir() + "/" + default_file);
+        // If we got there then we try to just load a file with name in default_file.
+        QFileInfo file_info(languages_dir + "/" + default_file);
 
-            if (file_info.exists() and file_info.isFile()) {
-                const TagKeyboardPtr keyboard(getTagKeyboard(file_info.baseName()));
-                return getKeyboard(keyboard, false);
-            }
-        } else {
-            qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
+        if (file_info.exists() and file_info.isFile()) {
+            const TagKeyboardPtr keyboard(repository->tagKeyboard(file_info.baseName()));
+            return getKeyboard(keyboard, false);
         }
-    } else {
-        qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
     }
     return Keyboard();
 }
@@ -380,8 +323,49 @@ namespace MaliitKeyboard {
 class KeyboardLoaderPrivate
 {
 public:
-
     QString active_id;
+    SharedKeyboardRepository repository;
+
+    explicit KeyboardLoaderPrivate()
+        : active_id()
+        , repository(new KeyboardRepository)
+    {}
+
+    // Returns the keyboard stored under id and variant, converting it
+    // only on first use:
+    Keyboard cachedKeyboard(const QString &id,
+                            const QString &variant,
+                            bool shifted = false,
+                            const QString &dead_label = QString()) const
+    {
+        const QString key(id + '/' + variant);
+        Keyboard result;
+
+        if (not repository->lookupKeyboard(key, &result)) {
+            result = getKeyboard(repository->tagKeyboard(id), shifted, 0, dead_label);
+            repository->storeKeyboard(key, result);
+        }
+
+        return result;
+    }
+
+    Keyboard cachedImportedKeyboard(const QString &variant,
+                                    ImportList import_list,
+                                    const QString &file_prefix,
+                                    const QString &default_file,
+                                    int page = 0) const
+    {
+        const QString key(active_id + '/' + variant);
+        Keyboard result;
+
+        if (not repository->lookupKeyboard(key, &result)) {
+            result = getImportedKeyboard(repository.data(), active_id, import_list,
+                                         file_prefix, default_file, page);
+            repository->storeKeyboard(key, result);
+        }
+
+        return result;
+    }
 };
 
 KeyboardLoader::KeyboardLoader(QObject *parent)
@@ -392,28 +376,29 @@ KeyboardLoader::KeyboardLoader(QObject *parent)
 KeyboardLoader::~KeyboardLoader()
 {}
 
-QStringList KeyboardLoader::ids() const
+SharedKeyboardRepository KeyboardLoader::repository() const
 {
-    QStringList ids;
-    QDir dir(getLanguagesDir(),
-             "*.xml",
-             QDir::Name | QDir::IgnoreCase,
-             QDir::Files | QDir::NoSymLinks | QDir::Readable);
-
-    if (dir.exists()) {
-        QFileInfoList file_infos(dir.entryInfoList());
-
-        Q_FOREACH (const QFileInfo &file_info, file_infos) {
-            QFile file(file_info.filePath());
-            file.open(QIODevice::ReadOnly);
-            LayoutParser parser(&file);
-
-            if (parser.isLanguageFile()) {
-                ids.append(file_info.baseName());
-            }
-        }
+    Q_D(const KeyboardLoader);
+    return d->repository;
+}
+
+//! \brief Lets this loader read layouts from a shared repository.
+//!
+//! Loaders sharing one repository parse and convert each layout only
+//! once.
+void KeyboardLoader::setRepository(const SharedKeyboardRepository &repository)
+{
+    Q_D(KeyboardLoader);
+
+    if (not repository.isNull()) {
+        d->repository = repository;
     }
-    return ids;
+}
+
+QStringList KeyboardLoader::ids() const
+{
+    Q_D(const KeyboardLoader);
+    return d->repository->ids();
 }
 
 QString KeyboardLoader::activeId() const
@@ -436,7 +421,8 @@ void KeyboardLoader::setActiveId(const QString &id)
 
 QString KeyboardLoader::title(const QString &id) const
 {
-    const TagKeyboardPtr keyboard(getTagKeyboard(id));
+    Q_D(const KeyboardLoader);
+    const TagKeyboardPtr keyboard(d->repository->tagKeyboard(id));
 
     if (keyboard) {
         return keyboard->title();
@@ -445,12 +431,22 @@ QString KeyboardLoader::title(const QString &id) const
     return QString();
 }
 
-Keyboard KeyboardLoader::keyboard() const
+QString KeyboardLoader::language(const QString &id) const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
+    const TagKeyboardPtr keyboard(d->repository->tagKeyboard(id));
+
+    if (keyboard) {
+        return keyboard->language();
+    }
+
+    return QString();
+}
 
-    return getKeyboard(keyboard);
+Keyboard KeyboardLoader::keyboard() const
+{
+    Q_D(const KeyboardLoader);
+    return d->cachedKeyboard(d->active_id, "main");
 }
 
 Keyboard KeyboardLoader::nextKeyboard() const
@@ -469,9 +465,7 @@ Keyboard KeyboardLoader::nextKeyboard() const
         next_index = 0;
     }
 
-    TagKeyboardPtr keyboard(getTagKeyboard(all_ids[next_index]));
-
-    return getKeyboard(keyboard);
+    return d->cachedKeyboard(all_ids[next_index], "main");
 }
 
 Keyboard KeyboardLoader::previousKeyboard() const
@@ -490,40 +484,36 @@ Keyboard KeyboardLoader::previousKeyboard() const
         previous_index = 0;
     }
 
-    TagKeyboardPtr keyboard(getTagKeyboard(all_ids[previous_index]));
-
-    return getKeyboard(keyboard);
+    return d->cachedKeyboard(all_ids[previous_index], "main");
 }
 
 Keyboard KeyboardLoader::shiftedKeyboard() const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
-
-    return getKeyboard(keyboard, true);
+    return d->cachedKeyboard(d->active_id, "shifted", true);
 }
 
 Keyboard KeyboardLoader::symbolsKeyboard(int page) const
 {
     Q_D(const KeyboardLoader);
-
-    return getImportedKeyboard(d->active_id, &LayoutParser::symviews, "symbols", "symbols_en.xml", page);
+    return d->cachedImportedKeyboard("symbols/" + QString::number(page),
+                                     &KeyboardImports::symviews, "symbols", "symbols_en.xml", page);
 }
 
 Keyboard KeyboardLoader::deadKeyboard(const Key &dead) const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
+    const QString &label(dead.label().text());
 
-    return getKeyboard(keyboard, false, 0, dead.label().text());
+    return d->cachedKeyboard(d->active_id, "dead/" + label, false, label);
 }
 
 Keyboard KeyboardLoader::shiftedDeadKeyboard(const Key &dead) const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
+    const QString &label(dead.label().text());
 
-    return getKeyboard(keyboard, true, 0, dead.label().text());
+    return d->cachedKeyboard(d->active_id, "shifted-dead/" + label, true, label);
 }
 
 Keyboard KeyboardLoader::extendedKeyboard(const Key &key) const
@@ -537,7 +527,7 @@ Keyboard KeyboardLoader::extendedKeyboard(const Key &key) const
     }
 
     Q_D(const KeyboardLoader);
-    const TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
+    const TagKeyboardPtr keyboard(d->repository->tagKeyboard(d->active_id));
     bool shifted(false);
     const QPair<TagKeyPtr, TagBindingPtr> pair(getTagKeyAndBinding(keyboard, key.label().text(), &shifted));
     Keyboard skeyboard;
@@ -605,15 +595,13 @@ Keyboard KeyboardLoader::extendedKeyboard(const Key &key) const
 Keyboard KeyboardLoader::numberKeyboard() const
 {
     Q_D(const KeyboardLoader);
-
-    return getImportedKeyboard(d->active_id, &LayoutParser::numbers, "number", "number.xml");
+    return d->cachedImportedKeyboard("number", &KeyboardImports::numbers, "number", "number.xml");
 }
 
 Keyboard KeyboardLoader::phoneNumberKeyboard() const
 {
     Q_D(const KeyboardLoader);
-
-    return getImportedKeyboard(d->active_id, &LayoutParser::phonenumbers, "phonenumber", "phonenumber.xml");
+    return d->cachedImportedKeyboard("phonenumber", &KeyboardImports::phonenumbers, "phonenumber", "phonenumber.xml");
 }
 
 } // namespace MaliitKeyboard
@@ -35,6 +35,7 @@
 
 #include "models/key.h"
 #include "models/keyboard.h"
+#include "keyboardrepository.h"
 
 #include <QtCore>
 
@@ -53,11 +54,15 @@ public:
     explicit KeyboardLoader(QObject *parent = 0);
     virtual ~KeyboardLoader();
 
+    SharedKeyboardRepository repository() const;
+    void setRepository(const SharedKeyboardRepository &repository);
+
     virtual QStringList ids() const;
     virtual QString activeId() const;
     virtual void setActiveId(const QString &id);
 
     virtual QString title(const QString &id) const;
+    virtual QString language(const QString &id) const;
 
     virtual Keyboard keyboard() const;
     virtual Keyboard nextKeyboard() const;
@@ -0,0 +1,324 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "keyboardrepository.h"
+#include "parser/layoutparser.h"
+#include "coreutils.h"
+#include "memoryusage.h"
+
+#include <QDir>
+#include <QFile>
+
+namespace MaliitKeyboard {
+
+namespace {
+
+//! Default for the estimated heap usage of converted keyboards, in bytes.
+//! Enough for the variants of a few layouts, including dead key variants.
+const int DefaultKeyboardCacheSize = 1024 * 1024;
+
+} // unnamed namespace
+
+//! Parse result of a layout file, kept in the repository.
+struct ParsedLayout
+{
+    TagKeyboardPtr keyboard;
+    KeyboardImports imports;
+};
+
+class KeyboardRepositoryPrivate
+{
+public:
+    QStringList ids;
+    bool ids_valid;
+    QHash<QString, ParsedLayout> layouts;
+    QCache<QString, Keyboard> keyboards;
+    int parse_count;
+    mutable int cache_hit_count;
+    mutable int cache_miss_count;
+
+    explicit KeyboardRepositoryPrivate()
+        : ids()
+        , ids_valid(false)
+        , layouts()
+        , keyboards(DefaultKeyboardCacheSize)
+        , parse_count(0)
+        , cache_hit_count(0)
+        , cache_miss_count(0)
+    {}
+
+    const ParsedLayout &layout(const QString &id);
+};
+
+//! Returns the parse result for given layout, parsing the layout file
+//! only on first use.
+const ParsedLayout &KeyboardRepositoryPrivate::layout(const QString &id)
+{
+    QHash<QString, ParsedLayout>::const_iterator it(layouts.constFind(id));
+
+    if (it != layouts.constEnd()) {
+        ++cache_hit_count;
+        return it.value();
+    }
+
+    ++cache_miss_count;
+
+    ParsedLayout parsed;
+    const QString path(KeyboardRepository::languagesDirectory() + "/" + id + ".xml");
+    QFile file(path);
+
+    if (not file.exists()) {
+        qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
+    } else if (not file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Cannot open file:" << path;
+    } else {
+        LayoutParser parser(&file);
+        const bool result(parser.parse());
+        ++parse_count;
+
+        file.close();
+        if (result) {
+            parsed.keyboard = parser.keyboard();
+            parsed.imports.imports = parser.imports();
+            parsed.imports.symviews = parser.symviews();
+            parsed.imports.numbers = parser.numbers();
+            parsed.imports.phonenumbers = parser.phonenumbers();
+        } else {
+            qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
+        }
+    }
+
+    // Failures are stored too, so that broken files are not parsed again:
+    return layouts.insert(id, parsed).value();
+}
+
+KeyboardRepository::KeyboardRepository()
+    : d_ptr(new KeyboardRepositoryPrivate)
+{}
+
+KeyboardRepository::~KeyboardRepository()
+{}
+
+// For getting languages directory we use a function instead of global constant
+// because global constants are initialized before main runs. In this case that
+// would mean that CoreUtils::pluginDataDirectory is ran before any code in main
+// and it sets its static variable once. We want to be able to set the
+// environment variable altering behaviour of pluginDataDirectory for testing
+// purposes.
+QString KeyboardRepository::languagesDirectory()
+{
+    static QString languages_dir;
+
+    if (languages_dir.isEmpty()) {
+        // From http://doc.qt.nokia.com/4.7/qdir.html#separator: If you always
+        // use "/", Qt will translate your paths to conform to the underlying
+        // operating system.
+        languages_dir = CoreUtils::pluginDataDirectory() + "/languages";
+    }
+
+    return languages_dir;
+}
+
+QStringList KeyboardRepository::ids()
+{
+    Q_D(KeyboardRepository);
+
+    if (d->ids_valid) {
+        return d->ids;
+    }
+
+    QDir dir(languagesDirectory(),
+             "*.xml",
+             QDir::Name | QDir::IgnoreCase,
+             QDir::Files | QDir::NoSymLinks | QDir::Readable);
+
+    d->ids.clear();
+
+    if (dir.exists()) {
+        QFileInfoList file_infos(dir.entryInfoList());
+
+        Q_FOREACH (const QFileInfo &file_info, file_infos) {
+            QFile file(file_info.filePath());
+
+            if (not file.open(QIODevice::ReadOnly)) {
+                qWarning() << __PRETTY_FUNCTION__
+                           << "Cannot open file:" << file_info.filePath();
+                continue;
+            }
+
+            LayoutParser parser(&file);
+
+            if (parser.isLanguageFile()) {
+                d->ids.append(file_info.baseName());
+            }
+        }
+    }
+
+    d->ids_valid = true;
+    return d->ids;
+}
+
+TagKeyboardPtr KeyboardRepository::tagKeyboard(const QString &id)
+{
+    Q_D(KeyboardRepository);
+
+    if (id.isEmpty()) {
+        return TagKeyboardPtr();
+    }
+
+    return d->layout(id).keyboard;
+}
+
+bool KeyboardRepository::lookupImports(const QString &id,
+                                       KeyboardImports *imports)
+{
+    Q_D(KeyboardRepository);
+
+    if (id.isEmpty()) {
+        return false;
+    }
+
+    const ParsedLayout &parsed(d->layout(id));
+
+    if (not parsed.keyboard) {
+        return false;
+    }
+
+    if (imports) {
+        *imports = parsed.imports;
+    }
+
+    return true;
+}
+
+bool KeyboardRepository::lookupKeyboard(const QString &key,
+                                        Keyboard *keyboard) const
+{
+    Q_D(const KeyboardRepository);
+
+    const Keyboard *const cached(d->keyboards.object(key));
+
+    if (not cached) {
+        ++d->cache_miss_count;
+        return false;
+    }
+
+    ++d->cache_hit_count;
+
+    if (keyboard) {
+        *keyboard = *cached;
+    }
+
+    return true;
+}
+
+void KeyboardRepository::storeKeyboard(const QString &key,
+                                       const Keyboard &keyboard)
+{
+    Q_D(KeyboardRepository);
+
+    const qint64 cost(MemoryUsage::ofString(key) + sizeof(Keyboard) + MemoryUsage::ofKeyboard(keyboard));
+    d->keyboards.insert(key, new Keyboard(keyboard), static_cast<int>(cost));
+}
+
+//! Maximum estimated heap usage of converted keyboards, in bytes.
+int KeyboardRepository::keyboardCacheSize() const
+{
+    Q_D(const KeyboardRepository);
+    return d->keyboards.maxCost();
+}
+
+//! Sets the maximum estimated heap usage of converted keyboards, in
+//! bytes. Least recently used keyboards are dropped first.
+void KeyboardRepository::setKeyboardCacheSize(int size)
+{
+    Q_D(KeyboardRepository);
+    d->keyboards.setMaxCost(size);
+}
+
+void KeyboardRepository::clear()
+{
+    Q_D(KeyboardRepository);
+
+    d->ids.clear();
+    d->ids_valid = false;
+    d->layouts.clear();
+    d->keyboards.clear();
+}
+
+void KeyboardRepository::clearKeyboards()
+{
+    Q_D(KeyboardRepository);
+    d->keyboards.clear();
+}
+
+//! Number of layout files parsed so far, useful for testing.
+int KeyboardRepository::parseCount() const
+{
+    Q_D(const KeyboardRepository);
+    return d->parse_count;
+}
+
+//! Number of parsed or converted keyboards served from the repository.
+int KeyboardRepository::cacheHitCount() const
+{
+    Q_D(const KeyboardRepository);
+    return d->cache_hit_count;
+}
+
+//! Number of lookups that had to parse or convert a keyboard.
+int KeyboardRepository::cacheMissCount() const
+{
+    Q_D(const KeyboardRepository);
+    return d->cache_miss_count;
+}
+
+qint64 KeyboardRepository::memoryUsage() const
+{
+    Q_D(const KeyboardRepository);
+    qint64 usage(MemoryUsage::ofStringList(d->ids));
+
+    for (QHash<QString, ParsedLayout>::const_iterator it = d->layouts.constBegin();
+         it != d->layouts.constEnd();
+         ++it) {
+        const KeyboardImports &imports(it.value().imports);
+        usage += MemoryUsage::ofString(it.key()) + MemoryUsage::ofTagKeyboard(it.value().keyboard)
+                 + MemoryUsage::ofStringList(imports.imports) + MemoryUsage::ofStringList(imports.symviews)
+                 + MemoryUsage::ofStringList(imports.numbers) + MemoryUsage::ofStringList(imports.phonenumbers);
+    }
+
+    // Converted keyboards are stored with their estimated usage as cost:
+    usage += d->keyboards.totalCost();
+
+    return usage;
+}
+
+} // namespace MaliitKeyboard
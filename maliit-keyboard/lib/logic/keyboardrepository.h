@@ -0,0 +1,112 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_KEYBOARDREPOSITORY_H
+#define MALIIT_KEYBOARD_KEYBOARDREPOSITORY_H
+
+#include "models/keyboard.h"
+#include "parser/alltagtypes.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class KeyboardRepositoryPrivate;
+
+//! Files a language layout imports, as found by LayoutParser.
+struct KeyboardImports
+{
+    QStringList imports;
+    QStringList symviews;
+    QStringList numbers;
+    QStringList phonenumbers;
+};
+
+//! \brief Shared store for parsed language layouts.
+//!
+//! Parses every layout file at most once and keeps the resulting tag
+//! trees and import lists around. Converted keyboards are cached too,
+//! up to keyboardCacheSize(), dropping the least recently used ones.
+//! Stored data is never modified after insertion, so several
+//! KeyboardLoader instances (e.g., the main and the extended layout) can
+//! read from one repository.
+class KeyboardRepository
+{
+    Q_DISABLE_COPY(KeyboardRepository)
+    Q_DECLARE_PRIVATE(KeyboardRepository)
+
+public:
+    explicit KeyboardRepository();
+    virtual ~KeyboardRepository();
+
+    static QString languagesDirectory();
+
+    //! Returns ids of all available language layouts.
+    QStringList ids();
+    //! Returns parsed layout for given id, or a null pointer if the
+    //! layout file could not be parsed.
+    TagKeyboardPtr tagKeyboard(const QString &id);
+    //! Looks up the imports of given layout. Returns false if the layout
+    //! file could not be parsed.
+    bool lookupImports(const QString &id,
+                       KeyboardImports *imports);
+
+    //! Looks up a converted keyboard. Returns false if no keyboard was
+    //! stored for given key yet.
+    bool lookupKeyboard(const QString &key,
+                        Keyboard *keyboard) const;
+    void storeKeyboard(const QString &key,
+                       const Keyboard &keyboard);
+
+    int keyboardCacheSize() const;
+    void setKeyboardCacheSize(int size);
+
+    //! Drops all cached data, for instance after layout files changed.
+    void clear();
+    //! Drops converted keyboards only, parsed layouts are kept.
+    void clearKeyboards();
+
+    int parseCount() const;
+    int cacheHitCount() const;
+    int cacheMissCount() const;
+
+    //! Estimated heap usage of all cached layouts, in bytes.
+    qint64 memoryUsage() const;
+
+private:
+    const QScopedPointer<KeyboardRepositoryPrivate> d_ptr;
+};
+
+typedef QSharedPointer<KeyboardRepository> SharedKeyboardRepository;
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_KEYBOARDREPOSITORY_H
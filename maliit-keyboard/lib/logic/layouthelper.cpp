@@ -30,7 +30,6 @@
  *
  */
 
-#include <algorithm>
 #include <tr1/functional>
 
 #include "layouthelper.h"
@@ -60,23 +59,12 @@ bool removeKey(QVector<Key> *keys,
     return false;
 }
 
-struct KeyPredicate
-{
-    KeyPredicate(const QSet<QString> &changed_ids)
-        : m_changed_ids(changed_ids)
-    {}
-
-    bool operator()(Key &key)
-    {
-        return (m_changed_ids.constFind(CoreUtils::idFromKey(key)) != m_changed_ids.constEnd());
-    }
-
-    const QSet<QString> &m_changed_ids;
-};
-
 } // namespace
 
-typedef std::tr1::function<void(const KeyArea &, const KeyOverrides &)> EmitFunc;
+typedef std::tr1::function<void(const QVector<int> &, const KeyOverrides &)> EmitFunc;
+
+//! Maps override ids to the indices of the keys they apply to.
+typedef QHash<QString, QVector<int> > KeyIndexMap;
 
 class LayoutHelperPrivate
 {
@@ -105,12 +93,19 @@ public:
     Key magnifier_key;
     KeyOverrides overriden_keys;
 
+    // Built on first override after a panel changed, so that rebuilding
+    // panels does not pay for it:
+    KeyIndexMap key_indices[LayoutHelper::NumPanels];
+    bool key_indices_valid[LayoutHelper::NumPanels];
+
     explicit LayoutHelperPrivate();
 
-    KeyArea lookup(LayoutHelper::Panel panel) const;
+    const KeyArea & lookup(LayoutHelper::Panel panel) const;
     QPoint panelOrigin() const;
+    void invalidateKeyIndices(LayoutHelper::Panel panel);
+    const KeyIndexMap &keyIndices(LayoutHelper::Panel panel);
     void overrideCheck(const QSet<QString> &changed_ids,
-                       KeyArea &key_area,
+                       LayoutHelper::Panel panel,
                        const EmitFunc& func);
 };
 
@@ -127,10 +122,17 @@ LayoutHelperPrivate::LayoutHelperPrivate()
     , active_keys()
     , magnifier_key()
     , overriden_keys()
-{}
+    , key_indices()
+{
+    for (int panel = 0; panel < LayoutHelper::NumPanels; ++panel) {
+        key_indices_valid[panel] = false;
+    }
+}
 
-KeyArea LayoutHelperPrivate::lookup(LayoutHelper::Panel panel) const
+const KeyArea & LayoutHelperPrivate::lookup(LayoutHelper::Panel panel) const
 {
+    static const KeyArea empty;
+
     switch(panel) {
     case LayoutHelper::LeftPanel: return left;
     case LayoutHelper::RightPanel: return right;
@@ -141,7 +143,7 @@ KeyArea LayoutHelperPrivate::lookup(LayoutHelper::Panel panel) const
 
     qCritical() << __PRETTY_FUNCTION__
                 << "Should not be reached, invalid panel:" << panel;
-    return KeyArea();
+    return empty;
 }
 
 QPoint LayoutHelperPrivate::panelOrigin() const
@@ -149,15 +151,50 @@ QPoint LayoutHelperPrivate::panelOrigin() const
     return QPoint(0, ribbon.area().size().height());
 }
 
+void LayoutHelperPrivate::invalidateKeyIndices(LayoutHelper::Panel panel)
+{
+    key_indices_valid[panel] = false;
+    key_indices[panel].clear();
+}
+
+const KeyIndexMap &LayoutHelperPrivate::keyIndices(LayoutHelper::Panel panel)
+{
+    KeyIndexMap &indices(key_indices[panel]);
+
+    if (not key_indices_valid[panel]) {
+        const QVector<Key> &keys(lookup(panel).keys());
+
+        for (int index = 0; index < keys.count(); ++index) {
+            const QString &id(CoreUtils::idFromKey(keys.at(index)));
+
+            if (not id.isEmpty()) {
+                indices[id].append(index);
+            }
+        }
+
+        key_indices_valid[panel] = true;
+    }
+
+    return indices;
+}
+
 void LayoutHelperPrivate::overrideCheck(const QSet<QString> &changed_ids,
-                                  KeyArea &key_area,
-                                  const EmitFunc &func)
+                                        LayoutHelper::Panel panel,
+                                        const EmitFunc &func)
 {
-    QVector<Key> &keys(key_area.rKeys());
-    KeyPredicate predicate(changed_ids);
+    const KeyIndexMap &indices(keyIndices(panel));
+    QVector<int> changed_indices;
+
+    Q_FOREACH (const QString &id, changed_ids) {
+        const KeyIndexMap::const_iterator found(indices.find(id));
+
+        if (found != indices.end()) {
+            changed_indices += found.value();
+        }
+    }
 
-    if (std::find_if(keys.begin(), keys.end(), predicate) != keys.end()) {
-        func(key_area, overriden_keys);
+    if (not changed_indices.isEmpty()) {
+        func(changed_indices, overriden_keys);
     }
 }
 
@@ -233,7 +270,7 @@ void LayoutHelper::setActivePanel(Panel panel)
     }
 }
 
-KeyArea LayoutHelper::activeKeyArea() const
+const KeyArea & LayoutHelper::activeKeyArea() const
 {
     Q_D(const LayoutHelper);
     return d->lookup(activePanel());
@@ -259,7 +296,7 @@ QRect LayoutHelper::activeKeyAreaGeometry() const
     return QRect();
 }
 
-KeyArea LayoutHelper::leftPanel() const
+const KeyArea & LayoutHelper::leftPanel() const
 {
     Q_D(const LayoutHelper);
     return d->left;
@@ -271,11 +308,12 @@ void LayoutHelper::setLeftPanel(const KeyArea &left)
 
     if (d->left != left) {
         d->left = left;
+        d->invalidateKeyIndices(LeftPanel);
         Q_EMIT leftPanelChanged(d->left, d->overriden_keys);
     }
 }
 
-KeyArea LayoutHelper::rightPanel() const
+const KeyArea & LayoutHelper::rightPanel() const
 {
     Q_D(const LayoutHelper);
     return d->right;
@@ -287,11 +325,12 @@ void LayoutHelper::setRightPanel(const KeyArea &right)
 
     if (d->right != right) {
         d->right = right;
+        d->invalidateKeyIndices(RightPanel);
         Q_EMIT rightPanelChanged(d->right, d->overriden_keys);
     }
 }
 
-KeyArea LayoutHelper::centerPanel() const
+const KeyArea & LayoutHelper::centerPanel() const
 {
     Q_D(const LayoutHelper);
     return d->center;
@@ -303,11 +342,12 @@ void LayoutHelper::setCenterPanel(const KeyArea &center)
 
     if (d->center != center) {
         d->center = center;
+        d->invalidateKeyIndices(CenterPanel);
         Q_EMIT centerPanelChanged(d->center, d->overriden_keys);
     }
 }
 
-KeyArea LayoutHelper::extendedPanel() const
+const KeyArea & LayoutHelper::extendedPanel() const
 {
     Q_D(const LayoutHelper);
     return d->extended;
@@ -319,6 +359,7 @@ void LayoutHelper::setExtendedPanel(const KeyArea &extended)
 
     if (d->extended != extended) {
         d->extended = extended;
+        d->invalidateKeyIndices(ExtendedPanel);
         Q_EMIT extendedPanelChanged(d->extended, d->overriden_keys);
     }
 }
@@ -339,6 +380,72 @@ void LayoutHelper::setWordRibbon(const WordRibbon &ribbon)
     }
 }
 
+int LayoutHelper::wordCandidateCount() const
+{
+    Q_D(const LayoutHelper);
+    return d->ribbon.candidates().count();
+}
+
+//! Resizes the candidate slots of the word ribbon, keeping existing slots
+//! and their contents.
+void LayoutHelper::setWordCandidateCount(int count)
+{
+    Q_D(LayoutHelper);
+    QVector<WordCandidate> &candidates(d->ribbon.rCandidates());
+
+    if (candidates.count() != count) {
+        candidates.resize(count);
+        Q_EMIT wordCandidateCountChanged(count);
+    }
+}
+
+WordCandidate LayoutHelper::wordCandidate(int index) const
+{
+    Q_D(const LayoutHelper);
+    const QVector<WordCandidate> &candidates(d->ribbon.candidates());
+
+    return (index >= 0 && index < candidates.count() ? candidates.at(index)
+                                                     : WordCandidate());
+}
+
+//! Updates one candidate slot in place, instead of replacing and
+//! comparing the whole word ribbon.
+void LayoutHelper::setWordCandidate(int index,
+                                    const WordCandidate &candidate)
+{
+    Q_D(LayoutHelper);
+    QVector<WordCandidate> &candidates(d->ribbon.rCandidates());
+
+    if (index < 0 || index >= candidates.count()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Invalid word candidate index:" << index;
+        return;
+    }
+
+    if (candidates.at(index) != candidate) {
+        candidates[index] = candidate;
+        Q_EMIT wordCandidateChanged(index, candidate);
+    }
+}
+
+//! Returns the slot of a candidate with same label and geometry, or -1.
+int LayoutHelper::wordCandidateIndex(const WordCandidate &candidate) const
+{
+    Q_D(const LayoutHelper);
+    const QVector<WordCandidate> &candidates(d->ribbon.candidates());
+
+    for (int index = 0; index < candidates.count(); ++index) {
+        const WordCandidate &current(candidates.at(index));
+
+        if (current.label().text() == candidate.label().text()
+            && current.rect() == candidate.rect()) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
 QVector<Key> LayoutHelper::activeKeys() const
 {
     Q_D(const LayoutHelper);
@@ -468,13 +575,17 @@ void LayoutHelper::onKeysOverriden(const KeyOverrides &overriden_keys,
         d->overriden_keys = overriden_keys;
     }
 
+    if (changed_ids.isEmpty()) {
+        return;
+    }
+
     using std::tr1::placeholders::_1;
     using std::tr1::placeholders::_2;
 
-    d->overrideCheck(changed_ids, d->left, std::tr1::bind(&LayoutHelper::leftPanelChanged, this, _1, _2));
-    d->overrideCheck(changed_ids, d->right, std::tr1::bind(&LayoutHelper::rightPanelChanged, this, _1, _2));
-    d->overrideCheck(changed_ids, d->center, std::tr1::bind(&LayoutHelper::centerPanelChanged, this, _1, _2));
-    d->overrideCheck(changed_ids, d->extended, std::tr1::bind(&LayoutHelper::extendedPanelChanged, this, _1, _2));
+    d->overrideCheck(changed_ids, LeftPanel, std::tr1::bind(&LayoutHelper::leftKeysOverriden, this, _1, _2));
+    d->overrideCheck(changed_ids, RightPanel, std::tr1::bind(&LayoutHelper::rightKeysOverriden, this, _1, _2));
+    d->overrideCheck(changed_ids, CenterPanel, std::tr1::bind(&LayoutHelper::centerKeysOverriden, this, _1, _2));
+    d->overrideCheck(changed_ids, ExtendedPanel, std::tr1::bind(&LayoutHelper::extendedKeysOverriden, this, _1, _2));
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -100,32 +100,52 @@ public:
     void setActivePanel(Panel panel);
     Q_SIGNAL void activePanelChanged(Panel panel);
 
-    KeyArea activeKeyArea() const;
+    const KeyArea & activeKeyArea() const;
     QRect activeKeyAreaGeometry() const;
 
-    KeyArea leftPanel() const;
+    const KeyArea & leftPanel() const;
     void setLeftPanel(const KeyArea &left);
     Q_SIGNAL void leftPanelChanged(const KeyArea &left,
                                    const Logic::KeyOverrides &overrides);
 
-    KeyArea rightPanel() const;
+    const KeyArea & rightPanel() const;
     void setRightPanel(const KeyArea &right);
     Q_SIGNAL void rightPanelChanged(const KeyArea &right,
                                     const Logic::KeyOverrides &overrides);
 
-    KeyArea centerPanel() const;
+    const KeyArea & centerPanel() const;
     void setCenterPanel(const KeyArea &center);
     Q_SIGNAL void centerPanelChanged(const KeyArea &center,
                                      const Logic::KeyOverrides &overrides);
 
-    KeyArea extendedPanel() const;
+    const KeyArea & extendedPanel() const;
     void setExtendedPanel(const KeyArea &extended);
     Q_SIGNAL void extendedPanelChanged(const KeyArea &extended,
                                        const Logic::KeyOverrides &overrides);
+
+    Q_SIGNAL void leftKeysOverriden(const QVector<int> &key_indices,
+                                    const Logic::KeyOverrides &overrides);
+    Q_SIGNAL void rightKeysOverriden(const QVector<int> &key_indices,
+                                     const Logic::KeyOverrides &overrides);
+    Q_SIGNAL void centerKeysOverriden(const QVector<int> &key_indices,
+                                      const Logic::KeyOverrides &overrides);
+    Q_SIGNAL void extendedKeysOverriden(const QVector<int> &key_indices,
+                                        const Logic::KeyOverrides &overrides);
     WordRibbon wordRibbon() const;
     void setWordRibbon(const WordRibbon &ribbon);
     Q_SIGNAL void wordRibbonChanged(const WordRibbon &ribbon);
 
+    int wordCandidateCount() const;
+    void setWordCandidateCount(int count);
+    Q_SIGNAL void wordCandidateCountChanged(int count);
+
+    WordCandidate wordCandidate(int index) const;
+    void setWordCandidate(int index,
+                          const WordCandidate &candidate);
+    Q_SIGNAL void wordCandidateChanged(int index,
+                                       const WordCandidate &candidate);
+    int wordCandidateIndex(const WordCandidate &candidate) const;
+
     QVector<Key> activeKeys() const;
     void clearActiveKeys();
     void appendActiveKey(const Key &key);
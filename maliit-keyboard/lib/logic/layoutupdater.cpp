@@ -46,6 +46,8 @@
 #include "logic/state-machines/viewmachine.h"
 #include "logic/state-machines/deadkeymachine.h"
 
+#include "tracer.h"
+
 namespace MaliitKeyboard {
 namespace Logic {
 
@@ -117,31 +119,21 @@ void applyStyleToWordRibbon(WordRibbon *ribbon,
     ribbon->setArea(area);
 }
 
-bool updateWordRibbon(LayoutHelper *layout,
-                      const WordCandidate &candidate,
-                      const StyleAttributes *attributes,
-                      ActivationPolicy policy)
+bool updateWordCandidate(LayoutHelper *layout,
+                         int index,
+                         const StyleAttributes *attributes,
+                         ActivationPolicy policy)
 {
-    if (not layout || not attributes) {
+    if (not layout || not attributes
+        || index < 0 || index >= layout->wordCandidateCount()) {
         return false;
     }
 
-    WordRibbon ribbon(layout->wordRibbon());
-    QVector<WordCandidate> &candidates(ribbon.rCandidates());
-
-    for (int index = 0; index < candidates.count(); ++index) {
-        WordCandidate &current(candidates[index]);
-
-        if (current.label().text() == candidate.label().text()
-            && current.rect() == candidate.rect()) {
-            applyStyleToCandidate(&current, attributes, layout->orientation(), policy);
-            layout->setWordRibbon(ribbon);
-
-            return true;
-        }
-    }
+    WordCandidate candidate(layout->wordCandidate(index));
+    applyStyleToCandidate(&candidate, attributes, layout->orientation(), policy);
+    layout->setWordCandidate(index, candidate);
 
-    return false;
+    return true;
 }
 
 QRect adjustedRect(const QRect &rect, const QMargins &margins)
@@ -217,6 +209,9 @@ public:
     SharedStyle style;
     bool word_ribbon_visible;
     LayoutHelper::Panel close_extended_on_release;
+    QTimer rebuild_timer;
+    bool rebuild_pending;
+    int rebuild_count;
 
     explicit LayoutUpdaterPrivate()
         : initialized(false)
@@ -228,23 +223,27 @@ public:
         , style()
         , word_ribbon_visible(false)
         , close_extended_on_release(LayoutHelper::NumPanels) // NumPanels counts as invalid panel.
-    {}
+        , rebuild_timer()
+        , rebuild_pending(false)
+        , rebuild_count(0)
+    {
+        rebuild_timer.setSingleShot(true);
+        rebuild_timer.setInterval(0);
+    }
 
     bool inShiftedState() const
     {
-        return (shift_machine.inState(ShiftMachine::shift_state) or
-                shift_machine.inState(ShiftMachine::caps_lock_state) or
-                shift_machine.inState(ShiftMachine::latched_shift_state));
+        return shift_machine.inShiftedState();
     }
 
     bool arePrimarySymbolsShown() const
     {
-        return view_machine.inState(ViewMachine::symbols0_state);
+        return (view_machine.state() == ViewMachine::Symbols0);
     }
 
     bool areSecondarySymbolsShown() const
     {
-        return view_machine.inState(ViewMachine::symbols1_state);
+        return (view_machine.state() == ViewMachine::Symbols1);
     }
 
     bool areSymbolsShown() const
@@ -254,8 +253,7 @@ public:
 
     bool inDeadkeyState() const
     {
-        return (deadkey_machine.inState(DeadkeyMachine::deadkey_state) or
-                deadkey_machine.inState(DeadkeyMachine::latched_deadkey_state));
+        return deadkey_machine.inDeadkeyState();
     }
 
     const StyleAttributes * activeStyleAttributes() const
@@ -272,6 +270,9 @@ LayoutUpdater::LayoutUpdater(QObject *parent)
     connect(&d_ptr->loader, SIGNAL(keyboardsChanged()),
             this,           SLOT(onKeyboardsChanged()),
             Qt::UniqueConnection);
+
+    connect(&d_ptr->rebuild_timer, SIGNAL(timeout()),
+            this,                  SLOT(rebuildLayout()));
 }
 
 LayoutUpdater::~LayoutUpdater()
@@ -284,6 +285,12 @@ void LayoutUpdater::init()
     d->shift_machine.setup(this);
     d->view_machine.setup(this);
     d->deadkey_machine.setup(this);
+
+    connect(this, SIGNAL(autoCapsActivated()),
+            this, SLOT(onAutoCapsActivated()));
+
+    // Initial layout gets built in first main loop iteration:
+    resetStateMachines();
 }
 
 QStringList LayoutUpdater::keyboardIds() const
@@ -310,6 +317,18 @@ QString LayoutUpdater::keyboardTitle(const QString &id) const
     return d->loader.title(id);
 }
 
+SharedKeyboardRepository LayoutUpdater::keyboardRepository() const
+{
+    Q_D(const LayoutUpdater);
+    return d->loader.repository();
+}
+
+void LayoutUpdater::setKeyboardRepository(const SharedKeyboardRepository &repository)
+{
+    Q_D(LayoutUpdater);
+    d->loader.setRepository(repository);
+}
+
 void LayoutUpdater::setLayout(LayoutHelper *layout)
 {
     Q_D(LayoutUpdater);
@@ -327,11 +346,7 @@ void LayoutUpdater::setOrientation(LayoutHelper::Orientation orientation)
 
     if (d->layout && d->style && d->layout->orientation() != orientation) {
         d->layout->setOrientation(orientation);
-
-        KeyAreaConverter converter(d->style->attributes(), &d->loader);
-        converter.setLayoutOrientation(orientation);
-        d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
-                                                      : converter.keyArea());
+        syncLayoutToView();
 
         if (isWordRibbonVisible()) {
             WordRibbon ribbon(d->layout->wordRibbon());
@@ -408,11 +423,13 @@ void LayoutUpdater::onKeyPressed(const Key &key)
     switch (key.action()) {
     case Key::ActionShift:
         Q_EMIT shiftPressed();
+        d->shift_machine.dispatch(ShiftMachine::ShiftPressed);
         break;
 
     case Key::ActionDead:
         d->deadkey_machine.setAccentKey(key);
         Q_EMIT deadkeyPressed();
+        d->deadkey_machine.dispatch(DeadkeyMachine::DeadkeyPressed);
         break;
 
     default:
@@ -464,7 +481,7 @@ void LayoutUpdater::onKeyLongPressed(const Key &key)
 
 void LayoutUpdater::onKeyReleased(const Key &key)
 {
-    Q_D(const LayoutUpdater);
+    Q_D(LayoutUpdater);
 
     if (not d->layout) {
         return;
@@ -483,29 +500,35 @@ void LayoutUpdater::onKeyReleased(const Key &key)
     switch (key.action()) {
     case Key::ActionShift:
         Q_EMIT shiftReleased();
+        d->shift_machine.dispatch(ShiftMachine::ShiftReleased);
         break;
 
     case Key::ActionInsert:
-        if (d->shift_machine.inState(ShiftMachine::latched_shift_state)) {
+        if (d->shift_machine.state() == ShiftMachine::LatchedShift) {
             Q_EMIT shiftCancelled();
+            d->shift_machine.dispatch(ShiftMachine::ShiftCancelled);
         }
 
-        if (d->deadkey_machine.inState(DeadkeyMachine::latched_deadkey_state)) {
+        if (d->deadkey_machine.state() == DeadkeyMachine::LatchedDeadkey) {
             Q_EMIT deadkeyCancelled();
+            d->deadkey_machine.dispatch(DeadkeyMachine::DeadkeyCancelled);
         }
 
         break;
 
     case Key::ActionSym:
         Q_EMIT symKeyReleased();
+        d->view_machine.dispatch(ViewMachine::SymKeyReleased);
         break;
 
     case Key::ActionSwitch:
         Q_EMIT symSwitcherReleased();
+        d->view_machine.dispatch(ViewMachine::SymSwitcherReleased);
         break;
 
     case Key::ActionDead:
         Q_EMIT deadkeyReleased();
+        d->deadkey_machine.dispatch(DeadkeyMachine::DeadkeyReleased);
         break;
 
     default:
@@ -604,29 +627,36 @@ void LayoutUpdater::onWordCandidatesChanged(const WordCandidateList &candidates)
         return;
     }
 
-    // Copy WordRibbon instance in order to preserve geometry and styling:
-    WordRibbon ribbon(d->layout->wordRibbon());
-    ribbon.clearCandidates();
-
     const StyleAttributes * const attributes(d->activeStyleAttributes());
     const LayoutHelper::Orientation orientation(d->layout->orientation());
     const int candidate_width(attributes->keyAreaWidth(orientation) / (orientation == LayoutHelper::Landscape ? 6 : 4));
 
+    // Ribbon geometry and styling stay, candidate slots get updated in
+    // place. Only slots whose candidate changed get signalled:
+    d->layout->setWordCandidateCount(candidates.count());
+    WordCandidate word_candidate;
+
     for (int index = 0; index < candidates.count(); ++index) {
-        WordCandidate word_candidate(candidates.at(index));
+        word_candidate = candidates.at(index);
         // FIXME candidate height needs to come from word ribbon height
         word_candidate.rArea().setSize(QSize(word_candidate.source() == WordCandidate::SourceUser
                                              ? attributes->keyAreaWidth(orientation) : candidate_width, 56));
         word_candidate.setOrigin(QPoint(index * candidate_width, 0));
-        applyStyleToCandidate(&word_candidate, d->activeStyleAttributes(), orientation, DeactivateElement);
-        ribbon.appendCandidate(word_candidate);
-    }
 
-    d->layout->setWordRibbon(ribbon);
+        // Styling does not take part in the comparison, so unchanged slots
+        // can be skipped before paying for it:
+        if (word_candidate == d->layout->wordCandidate(index)) {
+            continue;
+        }
+
+        applyStyleToCandidate(&word_candidate, attributes, orientation, DeactivateElement);
+        d->layout->setWordCandidate(index, word_candidate);
+    }
 }
 
 void LayoutUpdater::onExtendedKeysShown(const Key &main_key)
 {
+    MALIIT_TRACE_SCOPE("LayoutUpdater::onExtendedKeysShown");
     Q_D(LayoutUpdater);
 
     if (not d->layout || d->style.isNull()) {
@@ -669,22 +699,39 @@ void LayoutUpdater::onExtendedKeysShown(const Key &main_key)
 void LayoutUpdater::onWordCandidatePressed(const WordCandidate &candidate)
 {
     Q_D(LayoutUpdater);
+    onWordCandidatePressed(d->layout ? d->layout->wordCandidateIndex(candidate) : -1);
+}
 
-    if (d->layout
-        && isWordRibbonVisible()
-        && updateWordRibbon(d->layout, candidate, d->activeStyleAttributes(), ActivateElement)) {
+void LayoutUpdater::onWordCandidateReleased(const WordCandidate &candidate)
+{
+    Q_D(LayoutUpdater);
+    onWordCandidateReleased(d->layout ? d->layout->wordCandidateIndex(candidate) : -1);
+}
+
+//! Highlights the candidate in given slot of the word ribbon.
+void LayoutUpdater::onWordCandidatePressed(int index)
+{
+    Q_D(LayoutUpdater);
+
+    if (d->layout && isWordRibbonVisible()) {
+        updateWordCandidate(d->layout, index, d->activeStyleAttributes(), ActivateElement);
     }
 }
 
-void LayoutUpdater::onWordCandidateReleased(const WordCandidate &candidate)
+//! Removes the highlight from the candidate in given slot of the word
+//! ribbon and selects the candidate.
+void LayoutUpdater::onWordCandidateReleased(int index)
 {
     Q_D(LayoutUpdater);
 
     if (d->layout
         && isWordRibbonVisible()
-        && updateWordRibbon(d->layout, candidate, d->activeStyleAttributes(), DeactivateElement)) {
+        && updateWordCandidate(d->layout, index, d->activeStyleAttributes(), DeactivateElement)) {
+        const WordCandidate candidate(d->layout->wordCandidate(index));
+
         if (candidate.source() == WordCandidate::SourcePrediction
-            || candidate.source() == WordCandidate::SourceSpellChecking) {
+            || candidate.source() == WordCandidate::SourceSpellChecking
+            || candidate.source() == WordCandidate::SourceUserDictionary) {
             Q_EMIT wordCandidateSelected(candidate.word());
         } else if (candidate.source() == WordCandidate::SourceUser) {
             Q_EMIT userCandidateSelected(candidate.word());
@@ -692,23 +739,18 @@ void LayoutUpdater::onWordCandidateReleased(const WordCandidate &candidate)
     }
 }
 
+//! \brief Marks the layout as dirty and schedules a rebuild.
+//!
+//! All state changes within one main loop iteration are collected and
+//! result in one KeyAreaConverter pass, see rebuildLayout().
 void LayoutUpdater::syncLayoutToView()
 {
-    Q_D(const LayoutUpdater);
-
-    if (not d->layout) {
-        return;
-    }
-
-    // Symbols do not care about shift state.
-    if (d->areSymbolsShown()) {
-        return;
-    }
+    MALIIT_TRACE_INSTANT("LayoutUpdater::syncLayoutToView");
+    Q_D(LayoutUpdater);
 
-    if (d->inDeadkeyState()) {
-        switchToAccentedView();
-    } else {
-        switchToMainView();
+    if (not d->rebuild_pending) {
+        d->rebuild_pending = true;
+        d->rebuild_timer.start();
     }
 }
 
@@ -717,86 +759,95 @@ void LayoutUpdater::onKeyboardsChanged()
     Q_D(LayoutUpdater);
 
     // Resetting state machines should reset layout also.
-    // FIXME: Most probably reloading will happen three
-    // times, which is not what we want.
-    d->shift_machine.restart();
-    d->deadkey_machine.restart();
-    d->view_machine.restart();
+    resetStateMachines();
 
     Q_EMIT keyboardTitleChanged(d->loader.title(d->loader.activeId()));
+    Q_EMIT keyboardLanguageChanged(d->loader.language(d->loader.activeId()));
 }
 
-void LayoutUpdater::switchToMainView()
+void LayoutUpdater::resetStateMachines()
 {
     Q_D(LayoutUpdater);
 
-    if (not d->layout || d->style.isNull()) {
-        return;
-    }
+    d->shift_machine.reset();
+    d->deadkey_machine.reset();
+    d->view_machine.reset();
 
-    d->layout->clearActiveKeys();
-    d->layout->clearMagnifierKey();
-
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-
-    if (d->word_ribbon_visible) {
-        WordRibbon ribbon(d->layout->wordRibbon());
-        applyStyleToWordRibbon(&ribbon, d->style, orientation);
-        d->layout->setWordRibbon(ribbon);
-    }
+    syncLayoutToView();
+}
 
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
-                                                  : converter.keyArea());
+void LayoutUpdater::onAutoCapsActivated()
+{
+    Q_D(LayoutUpdater);
+    d->shift_machine.dispatch(ShiftMachine::AutoCapsActivated);
 }
 
 void LayoutUpdater::switchToPrimarySymView()
 {
     Q_D(LayoutUpdater);
 
-    if (not d->layout || d->style.isNull()) {
-        return;
-    }
-
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(converter.symbolsKeyArea(0));
+    // Symbols do not care about shift state, start unshifted when
+    // returning to main view:
+    d->shift_machine.reset();
+    syncLayoutToView();
+}
 
-    // Reset shift state machine, also see switchToMainView.
-    d->shift_machine.restart();
+int LayoutUpdater::rebuildCount() const
+{
+    Q_D(const LayoutUpdater);
+    return d->rebuild_count;
 }
 
-void LayoutUpdater::switchToSecondarySymView()
+void LayoutUpdater::rebuildLayout()
 {
+    MALIIT_TRACE_SCOPE("LayoutUpdater::rebuildLayout");
     Q_D(LayoutUpdater);
 
+    if (not d->rebuild_pending) {
+        return;
+    }
+
+    d->rebuild_pending = false;
+    d->rebuild_timer.stop();
+
     if (not d->layout || d->style.isNull()) {
         return;
     }
 
+    ++d->rebuild_count;
+
     const LayoutHelper::Orientation orientation(d->layout->orientation());
     KeyAreaConverter converter(d->style->attributes(), &d->loader);
     converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(converter.symbolsKeyArea(1));
-}
 
-void LayoutUpdater::switchToAccentedView()
-{
-    Q_D(LayoutUpdater);
+    if (d->arePrimarySymbolsShown()) {
+        d->layout->setCenterPanel(converter.symbolsKeyArea(0));
+        return;
+    }
 
-    if (not d->layout || d->style.isNull()) {
+    if (d->areSecondarySymbolsShown()) {
+        d->layout->setCenterPanel(converter.symbolsKeyArea(1));
         return;
     }
 
+    if (d->inDeadkeyState()) {
+        const Key accent(d->deadkey_machine.accentKey());
+        d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedDeadKeyArea(accent)
+                                                      : converter.deadKeyArea(accent));
+        return;
+    }
 
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    const Key accent(d->deadkey_machine.accentKey());
-    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedDeadKeyArea(accent)
-                                                  : converter.deadKeyArea(accent));
+    d->layout->clearActiveKeys();
+    d->layout->clearMagnifierKey();
+
+    if (d->word_ribbon_visible) {
+        WordRibbon ribbon(d->layout->wordRibbon());
+        applyStyleToWordRibbon(&ribbon, d->style, orientation);
+        d->layout->setWordRibbon(ribbon);
+    }
+
+    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
+                                                  : converter.keyArea());
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -68,6 +68,9 @@ public:
     void setActiveKeyboardId(const QString &id);
     QString keyboardTitle(const QString &id) const;
 
+    SharedKeyboardRepository keyboardRepository() const;
+    void setKeyboardRepository(const SharedKeyboardRepository &repository);
+
     void setLayout(LayoutHelper *layout);
     Q_SLOT void setOrientation(LayoutHelper::Orientation orientation);
 
@@ -80,6 +83,10 @@ public:
     Key modifyKey(const Key &key,
                   KeyDescription::State state) const;
 
+    //! Number of KeyAreaConverter passes done so far. All state changes
+    //! within one main loop iteration are coalesced into one rebuild.
+    int rebuildCount() const;
+
     // Key signal handlers:
     Q_SLOT void onKeyPressed(const Key &key);
     Q_SLOT void onKeyLongPressed(const Key &key);
@@ -98,6 +105,8 @@ public:
     // WordCandidate signal handlers:
     Q_SLOT void onWordCandidatePressed(const WordCandidate &candidate);
     Q_SLOT void onWordCandidateReleased(const WordCandidate &candidate);
+    Q_SLOT void onWordCandidatePressed(int index);
+    Q_SLOT void onWordCandidateReleased(int index);
 
     Q_SIGNAL void wordCandidateSelected(const QString &candidate);
     Q_SIGNAL void userCandidateSelected(const QString &candidate);
@@ -105,12 +114,22 @@ public:
     Q_SIGNAL void addToUserDictionary();
 
     Q_SIGNAL void keyboardTitleChanged(const QString &title);
+    Q_SIGNAL void keyboardLanguageChanged(const QString &language);
 
 private:
+    // The state machines invoke syncLayoutToView and
+    // switchToPrimarySymView as their entry actions:
+    friend class ShiftMachine;
+    friend class ViewMachine;
+    friend class DeadkeyMachine;
+
+    Q_SLOT void resetStateMachines();
+
     Q_SIGNAL void shiftPressed();
     Q_SIGNAL void shiftReleased();
     Q_SIGNAL void autoCapsActivated();
     Q_SIGNAL void shiftCancelled();
+    Q_SLOT void onAutoCapsActivated();
 
     Q_SLOT void syncLayoutToView();
     Q_SLOT void onKeyboardsChanged();
@@ -118,15 +137,13 @@ private:
     Q_SIGNAL void symKeyReleased();
     Q_SIGNAL void symSwitcherReleased();
 
-    Q_SLOT void switchToMainView();
     Q_SLOT void switchToPrimarySymView();
-    Q_SLOT void switchToSecondarySymView();
 
     Q_SIGNAL void deadkeyPressed();
     Q_SIGNAL void deadkeyReleased();
     Q_SIGNAL void deadkeyCancelled();
 
-    Q_SLOT void switchToAccentedView();
+    Q_SLOT void rebuildLayout();
 
     const QScopedPointer<LayoutUpdaterPrivate> d_ptr;
 };
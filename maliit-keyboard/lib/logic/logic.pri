@@ -5,30 +5,38 @@ HEADERS += \
     logic/layouthelper.h \
     logic/layoutupdater.h \
     logic/keyboardloader.h \
+    logic/keyboardrepository.h \
     logic/keyareaconverter.h \
     logic/style.h \
     logic/spellchecker.h \
     logic/abstracttexteditor.h \
     logic/abstractwordengine.h \
     logic/wordengine.h \
+    logic/candidatefusion.h \
     logic/abstractlanguagefeatures.h \
     logic/languagefeatures.h \
     logic/eventhandler.h \
+    logic/gesturedecoder.h \
+    logic/sessionrecorder.h \
 
 SOURCES += \
     logic/hitlogic.cpp \
     logic/layouthelper.cpp \
     logic/layoutupdater.cpp \
     logic/keyboardloader.cpp \
+    logic/keyboardrepository.cpp \
     logic/keyareaconverter.cpp \
     logic/style.cpp \
     logic/spellchecker.cpp \
     logic/abstracttexteditor.cpp \
     logic/abstractwordengine.cpp \
     logic/wordengine.cpp \
+    logic/candidatefusion.cpp \
     logic/abstractlanguagefeatures.cpp \
     logic/languagefeatures.cpp \
     logic/eventhandler.cpp \
+    logic/gesturedecoder.cpp \
+    logic/sessionrecorder.cpp \
 
 DEFINES += HUNSPELL_DICT_PATH=\\\"$$HUNSPELL_DICT_PATH\\\"
 
@@ -0,0 +1,398 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "sessionrecorder.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \class SessionRecorder
+//! \brief Records what the keyboard sees during an input session.
+//!
+//! Key events of the event handler, cursor updates of the application,
+//! keyboard switches, orientation changes and the gesture typing setting,
+//! which decides how moves are handled, are written to a compact
+//! binary trace, together with their timestamps. Such a trace can be
+//! replayed with maliit-keyboard-session-replay. Recording is opt-in, the
+//! plugin only records if MALIIT_KEYBOARD_SESSION_TRACE names a file.
+//!
+//! Trace format (QDataStream, big endian): a quint32 magic and a quint16
+//! version, followed by records made of a quint8 event type, a quint32
+//! number of milliseconds since the previous record and the payload:
+//! a qint16 key index for key events, key index, x and y as qint16 for
+//! moves, a qint32 cursor position and the UTF-8 redacted surrounding text
+//! for cursor updates, the UTF-8 keyboard id for keyboard switches, a
+//! quint8 orientation, width and height as qint16 for screen size changes,
+//! or a quint8 for the gesture typing setting.
+//!
+//! The surrounding text itself is never written, as it might come from a
+//! password field or contain other private data. Only its character
+//! classes are: letters become 'a' and digits '0', while spaces and
+//! punctuation are kept, so that replays see the same word boundaries.
+
+namespace {
+
+const quint32 TraceMagic = 0x4d4b5354; // "MKST"
+const quint16 TraceVersion = 3;
+
+QString redacted(const QString &text)
+{
+    QString result(text);
+
+    for (int index = 0; index < result.length(); ++index) {
+        const QChar c(result.at(index));
+
+        if (c.isLetter() or c.isMark()) {
+            result[index] = QChar('a');
+        } else if (c.isDigit()) {
+            result[index] = QChar('0');
+        }
+    }
+
+    return result;
+}
+
+} // unnamed namespace
+
+class SessionRecorderPrivate
+{
+public:
+    QFile file;
+    QDataStream stream;
+    QElapsedTimer timer;
+    qint64 last_time;
+
+    explicit SessionRecorderPrivate();
+};
+
+SessionRecorderPrivate::SessionRecorderPrivate()
+    : file()
+    , stream()
+    , timer()
+    , last_time(0)
+{}
+
+SessionRecorder::SessionRecorder(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new SessionRecorderPrivate)
+{}
+
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+//! Starts recording into given file, replacing its contents.
+//! \param file_name the trace file.
+//! \return whether the file could be opened.
+bool SessionRecorder::start(const QString &file_name)
+{
+    Q_D(SessionRecorder);
+
+    stop();
+    d->file.setFileName(file_name);
+
+    if (not d->file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Cannot open trace file:" << file_name;
+        return false;
+    }
+
+    d->stream.setDevice(&d->file);
+    d->stream.setVersion(QDataStream::Qt_4_6);
+    d->stream << TraceMagic << TraceVersion;
+    d->timer.start();
+    d->last_time = 0;
+
+    return true;
+}
+
+//! Stops recording and closes the trace file.
+void SessionRecorder::stop()
+{
+    Q_D(SessionRecorder);
+
+    if (d->file.isOpen()) {
+        d->stream.setDevice(0);
+        d->file.close();
+    }
+}
+
+//! Returns whether a recording is running.
+bool SessionRecorder::isRecording() const
+{
+    Q_D(const SessionRecorder);
+    return d->file.isOpen();
+}
+
+//! Records press, release, enter, exit or press-and-hold of a key.
+//! \param type the kind of key event.
+//! \param index index of the key in the key area.
+void SessionRecorder::recordKeyEvent(EventType type,
+                                     int index)
+{
+    Event event;
+    event.type = type;
+    event.index = index;
+    record(event);
+}
+
+//! Records a touch moving over a key.
+void SessionRecorder::recordMoved(int index,
+                                  int x,
+                                  int y)
+{
+    Event event;
+    event.type = EventMoved;
+    event.index = index;
+    event.position = QPoint(x, y);
+    record(event);
+}
+
+//! Records a cursor position update from the application. Only the
+//! character classes of the surrounding text are recorded, not its contents.
+void SessionRecorder::recordCursorPositionChanged(int cursor_position,
+                                                  const QString &surrounding_text)
+{
+    if (not isRecording()) {
+        return;
+    }
+
+    Event event;
+    event.type = EventCursorPositionChanged;
+    event.index = cursor_position;
+    event.text = redacted(surrounding_text);
+    record(event);
+}
+
+//! Records a switch to another keyboard.
+void SessionRecorder::recordKeyboardChanged(const QString &id)
+{
+    Event event;
+    event.type = EventKeyboardChanged;
+    event.text = id;
+    record(event);
+}
+
+//! Records an orientation change, using LayoutHelper::Orientation values.
+void SessionRecorder::recordOrientationChanged(int orientation)
+{
+    Event event;
+    event.type = EventOrientationChanged;
+    event.index = orientation;
+    record(event);
+}
+
+//! Records a change of the available screen size.
+void SessionRecorder::recordScreenSizeChanged(const QSize &size)
+{
+    Event event;
+    event.type = EventScreenSizeChanged;
+    event.position = QPoint(size.width(), size.height());
+    record(event);
+}
+
+//! Records whether gesture typing is enabled. Moves only reach the word
+//! engine while it is.
+void SessionRecorder::recordGestureTypingChanged(bool enabled)
+{
+    Event event;
+    event.type = EventGestureTypingChanged;
+    event.index = enabled ? 1 : 0;
+    record(event);
+}
+
+void SessionRecorder::record(const Event &event)
+{
+    Q_D(SessionRecorder);
+
+    if (not d->file.isOpen()) {
+        return;
+    }
+
+    const qint64 time(d->timer.elapsed());
+    d->stream << static_cast<quint8>(event.type)
+              << static_cast<quint32>(time - d->last_time);
+    d->last_time = time;
+
+    switch (event.type) {
+    case EventPressed:
+    case EventReleased:
+    case EventEntered:
+    case EventExited:
+    case EventPressAndHold:
+        d->stream << static_cast<qint16>(event.index);
+        break;
+
+    case EventMoved:
+        d->stream << static_cast<qint16>(event.index)
+                  << static_cast<qint16>(event.position.x())
+                  << static_cast<qint16>(event.position.y());
+        break;
+
+    case EventCursorPositionChanged:
+        d->stream << static_cast<qint32>(event.index)
+                  << event.text.toUtf8();
+        break;
+
+    case EventKeyboardChanged:
+        d->stream << event.text.toUtf8();
+        break;
+
+    case EventOrientationChanged:
+    case EventGestureTypingChanged:
+        d->stream << static_cast<quint8>(event.index);
+        break;
+
+    case EventScreenSizeChanged:
+        d->stream << static_cast<qint16>(event.position.x())
+                  << static_cast<qint16>(event.position.y());
+        break;
+    }
+
+    // Moves are frequent and least interesting, so only flush on other
+    // events. Everything else should survive a crash:
+    if (event.type != EventMoved) {
+        d->file.flush();
+    }
+}
+
+//! Reads a trace written by SessionRecorder.
+//! \param file_name the trace file.
+//! \param events receives the recorded events, with absolute timestamps.
+//! \return whether the trace could be read completely.
+bool SessionRecorder::readTrace(const QString &file_name,
+                                QVector<Event> *events)
+{
+    if (not events) {
+        return false;
+    }
+
+    QFile file(file_name);
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Cannot open trace file:" << file_name;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic(0);
+    quint16 version(0);
+    stream >> magic >> version;
+
+    if (magic != TraceMagic or version != TraceVersion) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Not a session trace, or unsupported version:" << file_name;
+        return false;
+    }
+
+    qint64 time(0);
+
+    while (not stream.atEnd()) {
+        quint8 type(0);
+        quint32 delta(0);
+        stream >> type >> delta;
+        time += delta;
+
+        Event event;
+        event.type = static_cast<EventType>(type);
+        event.time = time;
+
+        switch (event.type) {
+        case EventPressed:
+        case EventReleased:
+        case EventEntered:
+        case EventExited:
+        case EventPressAndHold: {
+            qint16 index(0);
+            stream >> index;
+            event.index = index;
+        } break;
+
+        case EventMoved: {
+            qint16 index(0);
+            qint16 x(0);
+            qint16 y(0);
+            stream >> index >> x >> y;
+            event.index = index;
+            event.position = QPoint(x, y);
+        } break;
+
+        case EventCursorPositionChanged: {
+            qint32 cursor_position(0);
+            QByteArray surrounding_text;
+            stream >> cursor_position >> surrounding_text;
+            event.index = cursor_position;
+            event.text = QString::fromUtf8(surrounding_text.constData(), surrounding_text.size());
+        } break;
+
+        case EventKeyboardChanged: {
+            QByteArray id;
+            stream >> id;
+            event.text = QString::fromUtf8(id.constData(), id.size());
+        } break;
+
+        case EventOrientationChanged:
+        case EventGestureTypingChanged: {
+            quint8 value(0);
+            stream >> value;
+            event.index = value;
+        } break;
+
+        case EventScreenSizeChanged: {
+            qint16 width(0);
+            qint16 height(0);
+            stream >> width >> height;
+            event.position = QPoint(width, height);
+        } break;
+
+        default:
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Unknown event type:" << type;
+            return false;
+        }
+
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Truncated trace:" << file_name;
+            return false;
+        }
+
+        events->append(event);
+    }
+
+    return true;
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,111 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_SESSIONRECORDER_H
+#define MALIIT_KEYBOARD_SESSIONRECORDER_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+class SessionRecorderPrivate;
+
+class SessionRecorder
+    : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SessionRecorder)
+    Q_DECLARE_PRIVATE(SessionRecorder)
+
+public:
+    enum EventType {
+        EventPressed = 1,
+        EventReleased,
+        EventEntered,
+        EventExited,
+        EventPressAndHold,
+        EventMoved,
+        EventCursorPositionChanged,
+        EventKeyboardChanged,
+        EventOrientationChanged,
+        EventScreenSizeChanged,
+        EventGestureTypingChanged
+    };
+
+    struct Event
+    {
+        Event()
+            : type(EventPressed)
+            , time(0)
+            , index(-1)
+            , position()
+            , text()
+        {}
+
+        EventType type;
+        qint64 time; //!< Milliseconds since start of recording.
+        int index; //!< Key index, cursor position, orientation or gesture typing setting.
+        QPoint position; //!< Touch position or screen size.
+        QString text; //!< Keyboard id, or redacted surrounding text.
+    };
+
+    explicit SessionRecorder(QObject *parent = 0);
+    virtual ~SessionRecorder();
+
+    bool start(const QString &file_name);
+    void stop();
+    bool isRecording() const;
+
+    void recordKeyEvent(EventType type,
+                        int index);
+    void recordMoved(int index,
+                     int x,
+                     int y);
+    Q_SLOT void recordCursorPositionChanged(int cursor_position,
+                                            const QString &surrounding_text);
+    void recordKeyboardChanged(const QString &id);
+    void recordOrientationChanged(int orientation);
+    void recordScreenSizeChanged(const QSize &size);
+    void recordGestureTypingChanged(bool enabled);
+
+    static bool readTrace(const QString &file_name,
+                          QVector<Event> *events);
+
+private:
+    void record(const Event &event);
+
+    const QScopedPointer<SessionRecorderPrivate> d_ptr;
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_SESSIONRECORDER_H
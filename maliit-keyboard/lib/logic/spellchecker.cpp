@@ -31,6 +31,7 @@
  */
 
 #include "spellchecker.h"
+#include "memoryusage.h"
 
 #ifdef HAVE_HUNSPELL
 #include "hunspell/hunspell.hxx"
@@ -54,6 +55,7 @@ private:
 #endif
 
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
 #include <QTextCodec>
 #include <QStringList>
@@ -73,6 +75,7 @@ struct SpellCheckerPrivate
     bool enabled; //!< Whether the spellchecker is enabled.
     QSet<QString> ignored_words; //!< The words to ignore.
     QString user_dictionary_file;
+    qint64 dictionary_size; //!< Size of the affix and dictionary files.
 
     SpellCheckerPrivate(const QString &dictionary_path,
                         const QString &user_dictionary);
@@ -88,6 +91,8 @@ SpellCheckerPrivate::SpellCheckerPrivate(const QString &dictionary_path,
     , enabled(false)
     , ignored_words()
     , user_dictionary_file(user_dictionary)
+    , dictionary_size(QFileInfo(dictionary_path + ".aff").size()
+                      + QFileInfo(dictionary_path + ".dic").size())
 {
     if (not codec) {
         qWarning () << __PRETTY_FUNCTION__ << ":Could not find codec for" << hunspell.get_dic_encoding() << "- turning off spellchecking and suggesting.";
@@ -208,10 +213,82 @@ void SpellChecker::addToUserWordlist(const QString &word)
     }
 }
 
+//! \brief Returns the estimated heap usage, in bytes.
+//!
+//! Hunspell does not report its memory usage, the size of the dictionary
+//! files serves as approximation.
+qint64 SpellChecker::memoryUsage() const
+{
+    Q_D(const SpellChecker);
+    qint64 usage(d->dictionary_size);
+
+    Q_FOREACH (const QString &word, d->ignored_words) {
+        usage += MemoryUsage::ofString(word);
+    }
+
+    return usage;
+}
+
 // static
 QString SpellChecker::dictPath()
 {
-    return QString(HUNSPELL_DICT_PATH);
+    static const QByteArray env_dict_path = qgetenv("MALIIT_KEYBOARD_HUNSPELL_DICT_PATH");
+    return QString::fromUtf8(env_dict_path.isEmpty() ? HUNSPELL_DICT_PATH
+                                                     : env_dict_path.constData());
+}
+
+// static
+QString SpellChecker::defaultUserDictionary()
+{
+    return QString("%1/.config/maliit/userwords.txt").arg(QDir::homePath());
+}
+
+//! \brief Finds the system dictionary matching a layout language.
+//! \param language The language attribute of a layout, e.g. "de", "en_gb"
+//!                 or "zh@pinyin".
+//! \return the dictionary path without file extension, suitable for the
+//!         SpellChecker constructor, or an empty string if no dictionary is
+//!         installed for that language.
+//!
+//! Tries the exact locale first (en_gb -> en_GB), then the bare language
+//! (de), and finally any regional variant of the language (de -> de_DE).
+// static
+QString SpellChecker::dictionaryForLanguage(const QString &language)
+{
+    const QString locale(language.section('@', 0, 0));
+    const QString lang(locale.section('_', 0, 0).toLower());
+
+    if (lang.isEmpty()) {
+        return QString();
+    }
+
+    const QString region(locale.section('_', 1, 1).toUpper());
+    const QDir dir(dictPath());
+
+    QStringList candidates;
+    if (not region.isEmpty()) {
+        candidates.append(QString("%1_%2").arg(lang).arg(region));
+    }
+    candidates.append(lang);
+
+    Q_FOREACH (const QString &candidate, candidates) {
+        if (dir.exists(candidate + ".dic") and dir.exists(candidate + ".aff")) {
+            return dir.filePath(candidate);
+        }
+    }
+
+    const QStringList variants(dir.entryList(QStringList(lang + "_*.dic"),
+                                             QDir::Files | QDir::Readable,
+                                             QDir::Name));
+
+    Q_FOREACH (const QString &variant, variants) {
+        const QString base(variant.left(variant.length() - 4));
+        if (dir.exists(base + ".aff")) {
+            return dir.filePath(base);
+        }
+    }
+
+    return QString();
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -46,9 +46,8 @@ class SpellChecker
     Q_DECLARE_PRIVATE(SpellChecker)
 public:
     // FIXME: Find better way to discover default dictionaries.
-    // FIXME: Allow changing languages in between.
     explicit SpellChecker(const QString &dictionary_path = QString("%1/en_GB").arg(SpellChecker::dictPath()),
-                          const QString &user_dictionary = QString("%1/.config/maliit/userwords.txt").arg(QDir::homePath()));
+                          const QString &user_dictionary = SpellChecker::defaultUserDictionary());
 
     ~SpellChecker();
 
@@ -57,13 +56,20 @@ public:
                         int limit = -1);
     void ignoreWord(const QString &word);
     void addToUserWordlist(const QString &word);
+    qint64 memoryUsage() const;
 
     static QString dictPath();
+    static QString defaultUserDictionary();
+    static QString dictionaryForLanguage(const QString &language);
 
 private:
     const QScopedPointer<SpellCheckerPrivate> d_ptr;
 };
 
+typedef QSharedPointer<SpellChecker> SharedSpellChecker;
+
 }} // namespace Logic, MaliitKeyboard
 
+Q_DECLARE_METATYPE(MaliitKeyboard::Logic::SharedSpellChecker)
+
 #endif // MALIIT_KEYBOARD_SPELLCHECKER_H
@@ -40,6 +40,10 @@ namespace Logic {
 
 class LayoutUpdater;
 
+//! Base class for the small finite state machines driving the layout
+//! updater. Transitions are looked up in compile-time tables and
+//! dispatched synchronously by LayoutUpdater, entry actions are invoked
+//! directly on the updater.
 class AbstractStateMachine
 {
 public:
@@ -47,8 +51,12 @@ public:
     virtual ~AbstractStateMachine() = 0;
 
     virtual void setup(LayoutUpdater *updater) = 0;
-    virtual bool inState(const QString &name) const;
-    virtual void restart();
+    virtual bool inState(const QString &name) const = 0;
+
+    //! Returns to initial state without running its entry action.
+    virtual void reset() = 0;
+    //! Returns to initial state and runs its entry action.
+    virtual void restart() = 0;
 };
 
 }} // namespace Logic, MaliitKeyboard
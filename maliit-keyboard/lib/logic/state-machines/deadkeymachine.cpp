@@ -41,18 +41,42 @@ const char *const DeadkeyMachine::no_deadkey_state = "no-deadkey";
 const char *const DeadkeyMachine::latched_deadkey_state = "latched-deadkey";
 const char *const DeadkeyMachine::deadkey_state = "deadkey";
 
+namespace {
+
+// Indexed by DeadkeyMachine::State:
+const char *const StateNames[DeadkeyMachine::NumStates] = {
+    DeadkeyMachine::no_deadkey_state,
+    DeadkeyMachine::deadkey_state,
+    DeadkeyMachine::latched_deadkey_state
+};
+
+// Next state, indexed by current state and event. Staying in the same
+// state means the event is ignored.
+const DeadkeyMachine::State Transitions[DeadkeyMachine::NumStates][DeadkeyMachine::NumEvents] = {
+    // DeadkeyPressed, DeadkeyReleased, DeadkeyCancelled
+    { DeadkeyMachine::Deadkey, DeadkeyMachine::NoDeadkey, DeadkeyMachine::NoDeadkey }, // NoDeadkey
+    { DeadkeyMachine::Deadkey, DeadkeyMachine::LatchedDeadkey, DeadkeyMachine::NoDeadkey }, // Deadkey
+    { DeadkeyMachine::NoDeadkey, DeadkeyMachine::LatchedDeadkey, DeadkeyMachine::NoDeadkey } // LatchedDeadkey
+};
+
+}
+
 class DeadkeyMachinePrivate
 {
 public:
+    LayoutUpdater *updater;
+    DeadkeyMachine::State state;
     Key accent_key;
 
     explicit DeadkeyMachinePrivate()
-        : accent_key()
+        : updater(0)
+        , state(DeadkeyMachine::NoDeadkey)
+        , accent_key()
     {}
 };
 
-DeadkeyMachine::DeadkeyMachine(QObject *parent)
-    : QStateMachine(parent)
+DeadkeyMachine::DeadkeyMachine()
+    : AbstractStateMachine()
     , d_ptr(new DeadkeyMachinePrivate)
 {}
 
@@ -67,38 +91,68 @@ void DeadkeyMachine::setup(LayoutUpdater *updater)
         return;
     }
 
-    setChildMode(QState::ExclusiveStates);
+    Q_D(DeadkeyMachine);
+    d->updater = updater;
+    d->state = NoDeadkey;
+}
+
+bool DeadkeyMachine::inState(const QString &name) const
+{
+    Q_D(const DeadkeyMachine);
+    return (name == QLatin1String(StateNames[d->state]));
+}
+
+void DeadkeyMachine::reset()
+{
+    Q_D(DeadkeyMachine);
+    d->state = NoDeadkey;
+}
+
+void DeadkeyMachine::restart()
+{
+    reset();
+    enter(NoDeadkey);
+}
 
-    QState *no_deadkey = 0;
-    QState *deadkey = 0;
-    QState *latched_deadkey = 0;
+DeadkeyMachine::State DeadkeyMachine::state() const
+{
+    Q_D(const DeadkeyMachine);
+    return d->state;
+}
+
+bool DeadkeyMachine::inDeadkeyState() const
+{
+    Q_D(const DeadkeyMachine);
+    return (d->state != NoDeadkey);
+}
 
-    // addState makes state machine to be a parent of passed state,
-    // so we don't have to care about deleting states explicitly.
-    addState(no_deadkey = new QState);
-    addState(deadkey = new QState);
-    addState(latched_deadkey = new QState);
-    setInitialState(no_deadkey);
+bool DeadkeyMachine::dispatch(Event event)
+{
+    Q_D(DeadkeyMachine);
+    const State next(Transitions[d->state][event]);
 
-    no_deadkey->setObjectName(no_deadkey_state);
-    deadkey->setObjectName(deadkey_state);
-    latched_deadkey->setObjectName(latched_deadkey_state);
+    if (next == d->state) {
+        return false;
+    }
 
-    no_deadkey->addTransition(updater, SIGNAL(deadkeyPressed()), deadkey);
-    connect(no_deadkey, SIGNAL(entered()),
-            updater,    SLOT(switchToMainView()));
+    d->state = next;
+    enter(next);
 
+    return true;
+}
 
-    deadkey->addTransition(updater, SIGNAL(deadkeyCancelled()), no_deadkey);
-    deadkey->addTransition(updater, SIGNAL(deadkeyReleased()), latched_deadkey);
-    connect(deadkey, SIGNAL(entered()),
-            updater, SLOT(switchToAccentedView()));
+void DeadkeyMachine::enter(State state)
+{
+    Q_D(DeadkeyMachine);
 
-    latched_deadkey->addTransition(updater, SIGNAL(deadkeyCancelled()), no_deadkey);
-    latched_deadkey->addTransition(updater, SIGNAL(deadkeyPressed()), no_deadkey);
+    if (not d->updater) {
+        return;
+    }
 
-    // Defer to first main loop iteration:
-    QTimer::singleShot(0, this, SLOT(start()));
+    // Latching a deadkey keeps the accented view:
+    if (state != LatchedDeadkey) {
+        d->updater->syncLayoutToView();
+    }
 }
 
 void DeadkeyMachine::setAccentKey(const Key &accent_key)
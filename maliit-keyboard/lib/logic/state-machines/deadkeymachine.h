@@ -42,21 +42,46 @@
 namespace MaliitKeyboard {
 namespace Logic {
 
+class LayoutUpdater;
 class DeadkeyMachinePrivate;
 
 class DeadkeyMachine
-    : public QStateMachine
-    , public AbstractStateMachine
+    : public AbstractStateMachine
 {
-    Q_OBJECT
     Q_DISABLE_COPY(DeadkeyMachine)
     Q_DECLARE_PRIVATE(DeadkeyMachine)
 
 public:
-    explicit DeadkeyMachine(QObject *parent = 0);
+    enum State {
+        NoDeadkey,
+        Deadkey,
+        LatchedDeadkey,
+        NumStates
+    };
+
+    enum Event {
+        DeadkeyPressed,
+        DeadkeyReleased,
+        DeadkeyCancelled,
+        NumEvents
+    };
+
+    explicit DeadkeyMachine();
     virtual ~DeadkeyMachine();
 
+    //! \reimp
     virtual void setup(LayoutUpdater *updater);
+    virtual bool inState(const QString &name) const;
+    virtual void reset();
+    virtual void restart();
+    //! \reimp_end
+
+    State state() const;
+    bool inDeadkeyState() const;
+
+    //! Feeds event into the machine. Returns true and runs the entry
+    //! action of the new state if the event caused a transition.
+    bool dispatch(Event event);
 
     virtual void setAccentKey(const Key &accent_key);
     Key accentKey() const;
@@ -74,6 +99,8 @@ public:
     static const char *const latched_deadkey_state;
 
 private:
+    void enter(State state);
+
     const QScopedPointer<DeadkeyMachinePrivate> d_ptr;
 };
 
@@ -42,8 +42,41 @@ const char *const ShiftMachine::shift_state = "shift";
 const char *const ShiftMachine::latched_shift_state = "latched-shift";
 const char *const ShiftMachine::caps_lock_state = "caps-lock";
 
-ShiftMachine::ShiftMachine(QObject *parent)
-    : QStateMachine(parent)
+namespace {
+
+// Indexed by ShiftMachine::State:
+const char *const StateNames[ShiftMachine::NumStates] = {
+    ShiftMachine::no_shift_state,
+    ShiftMachine::latched_shift_state,
+    ShiftMachine::caps_lock_state
+};
+
+// Next state, indexed by current state and event. Staying in the same
+// state means the event is ignored.
+const ShiftMachine::State Transitions[ShiftMachine::NumStates][ShiftMachine::NumEvents] = {
+    // ShiftPressed, ShiftReleased, ShiftCancelled, AutoCapsActivated
+    { ShiftMachine::LatchedShift, ShiftMachine::NoShift, ShiftMachine::NoShift, ShiftMachine::LatchedShift }, // NoShift
+    { ShiftMachine::LatchedShift, ShiftMachine::CapsLock, ShiftMachine::NoShift, ShiftMachine::LatchedShift }, // LatchedShift
+    { ShiftMachine::CapsLock, ShiftMachine::NoShift, ShiftMachine::CapsLock, ShiftMachine::CapsLock } // CapsLock
+};
+
+}
+
+class ShiftMachinePrivate
+{
+public:
+    LayoutUpdater *updater;
+    ShiftMachine::State state;
+
+    explicit ShiftMachinePrivate()
+        : updater(0)
+        , state(ShiftMachine::NoShift)
+    {}
+};
+
+ShiftMachine::ShiftMachine()
+    : AbstractStateMachine()
+    , d_ptr(new ShiftMachinePrivate)
 {}
 
 ShiftMachine::~ShiftMachine()
@@ -57,38 +90,64 @@ void ShiftMachine::setup(LayoutUpdater *updater)
         return;
     }
 
-    setChildMode(QState::ExclusiveStates);
-
-    QState *no_shift = 0;
-    QState *latched_shift = 0;
-    QState *caps_lock = 0;
-
-    // addState makes state machine to be a parent of passed state,
-    // so we don't have to care about deleting states explicitly.
-    addState(no_shift = new QState);
-    addState(latched_shift = new QState);
-    addState(caps_lock = new QState);
-    setInitialState(no_shift);
-
-    no_shift->setObjectName(no_shift_state);
-    latched_shift->setObjectName(latched_shift_state);
-    caps_lock->setObjectName(caps_lock_state);
-
-    connect(no_shift, SIGNAL(entered()),
-            updater,  SLOT(syncLayoutToView()));
-    connect(latched_shift, SIGNAL(entered()),
-            updater,       SLOT(syncLayoutToView()));
-    connect(caps_lock, SIGNAL(entered()),
-            updater,   SLOT(syncLayoutToView()));
-
-    no_shift->addTransition(updater, SIGNAL(shiftPressed()), latched_shift);
-    no_shift->addTransition(updater, SIGNAL(autoCapsActivated()), latched_shift);
-    latched_shift->addTransition(updater, SIGNAL(shiftCancelled()), no_shift);
-    latched_shift->addTransition(updater, SIGNAL(shiftReleased()), caps_lock);
-    caps_lock->addTransition(updater, SIGNAL(shiftReleased()), no_shift);
-
-    // Defer to first main loop iteration:
-    QTimer::singleShot(0, this, SLOT(start()));
+    Q_D(ShiftMachine);
+    d->updater = updater;
+    d->state = NoShift;
+}
+
+bool ShiftMachine::inState(const QString &name) const
+{
+    Q_D(const ShiftMachine);
+    return (name == QLatin1String(StateNames[d->state]));
+}
+
+void ShiftMachine::reset()
+{
+    Q_D(ShiftMachine);
+    d->state = NoShift;
+}
+
+void ShiftMachine::restart()
+{
+    reset();
+    enter(NoShift);
+}
+
+ShiftMachine::State ShiftMachine::state() const
+{
+    Q_D(const ShiftMachine);
+    return d->state;
+}
+
+bool ShiftMachine::inShiftedState() const
+{
+    Q_D(const ShiftMachine);
+    return (d->state != NoShift);
+}
+
+bool ShiftMachine::dispatch(Event event)
+{
+    Q_D(ShiftMachine);
+    const State next(Transitions[d->state][event]);
+
+    if (next == d->state) {
+        return false;
+    }
+
+    d->state = next;
+    enter(next);
+
+    return true;
+}
+
+void ShiftMachine::enter(State state)
+{
+    Q_UNUSED(state);
+    Q_D(ShiftMachine);
+
+    if (d->updater) {
+        d->updater->syncLayoutToView();
+    }
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -41,19 +41,46 @@ namespace MaliitKeyboard {
 namespace Logic {
 
 class LayoutUpdater;
+class ShiftMachinePrivate;
 
 class ShiftMachine
-    : public QStateMachine
-    , public AbstractStateMachine
+    : public AbstractStateMachine
 {
-    Q_OBJECT
     Q_DISABLE_COPY(ShiftMachine)
+    Q_DECLARE_PRIVATE(ShiftMachine)
 
 public:
-    explicit ShiftMachine(QObject *parent = 0);
+    enum State {
+        NoShift,
+        LatchedShift,
+        CapsLock,
+        NumStates
+    };
+
+    enum Event {
+        ShiftPressed,
+        ShiftReleased,
+        ShiftCancelled,
+        AutoCapsActivated,
+        NumEvents
+    };
+
+    explicit ShiftMachine();
     virtual ~ShiftMachine();
 
+    //! \reimp
     virtual void setup(LayoutUpdater *updater);
+    virtual bool inState(const QString &name) const;
+    virtual void reset();
+    virtual void restart();
+    //! \reimp_end
+
+    State state() const;
+    bool inShiftedState() const;
+
+    //! Feeds event into the machine. Returns true and runs the entry
+    //! action of the new state if the event caused a transition.
+    bool dispatch(Event event);
 
     //! This state means that neither shift nor caps-lock wasn't pressed.
     //! Entered characters are lowercased. This is initial state.
@@ -67,6 +94,11 @@ public:
     static const char *const latched_shift_state;
     //! Same as latched shift?
     static const char *const caps_lock_state;
+
+private:
+    void enter(State state);
+
+    const QScopedPointer<ShiftMachinePrivate> d_ptr;
 };
 
 }} // namespace Logic, MaliitKeyboard
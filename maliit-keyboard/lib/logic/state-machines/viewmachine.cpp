@@ -41,8 +41,41 @@ const char *const ViewMachine::main_state = "main";
 const char *const ViewMachine::symbols0_state = "symbols0";
 const char *const ViewMachine::symbols1_state = "symbols1";
 
-ViewMachine::ViewMachine(QObject *parent)
-    : QStateMachine(parent)
+namespace {
+
+// Indexed by ViewMachine::State:
+const char *const StateNames[ViewMachine::NumStates] = {
+    ViewMachine::main_state,
+    ViewMachine::symbols0_state,
+    ViewMachine::symbols1_state
+};
+
+// Next state, indexed by current state and event. Staying in the same
+// state means the event is ignored.
+const ViewMachine::State Transitions[ViewMachine::NumStates][ViewMachine::NumEvents] = {
+    // SymKeyReleased, SymSwitcherReleased
+    { ViewMachine::Symbols0, ViewMachine::Main }, // Main
+    { ViewMachine::Main, ViewMachine::Symbols1 }, // Symbols0
+    { ViewMachine::Main, ViewMachine::Symbols0 } // Symbols1
+};
+
+}
+
+class ViewMachinePrivate
+{
+public:
+    LayoutUpdater *updater;
+    ViewMachine::State state;
+
+    explicit ViewMachinePrivate()
+        : updater(0)
+        , state(ViewMachine::Main)
+    {}
+};
+
+ViewMachine::ViewMachine()
+    : AbstractStateMachine()
+    , d_ptr(new ViewMachinePrivate)
 {}
 
 ViewMachine::~ViewMachine()
@@ -56,39 +89,67 @@ void ViewMachine::setup(LayoutUpdater *updater)
         return;
     }
 
-    setChildMode(QState::ExclusiveStates);
+    Q_D(ViewMachine);
+    d->updater = updater;
+    d->state = Main;
+}
 
-    QState *main = 0;
-    QState *symbols0 = 0;
-    QState *symbols1 = 0;
+bool ViewMachine::inState(const QString &name) const
+{
+    Q_D(const ViewMachine);
+    return (name == QLatin1String(StateNames[d->state]));
+}
 
-    // addState makes state machine to be a parent of passed state,
-    // so we don't have to care about deleting states explicitly.
-    addState(main = new QState);
-    addState(symbols0 = new QState);
-    addState(symbols1 = new QState);
-    setInitialState(main);
+void ViewMachine::reset()
+{
+    Q_D(ViewMachine);
+    d->state = Main;
+}
 
-    main->setObjectName(main_state);
-    symbols0->setObjectName(symbols0_state);
-    symbols1->setObjectName(symbols1_state);
+void ViewMachine::restart()
+{
+    reset();
+    enter(Main);
+}
 
-    main->addTransition(updater, SIGNAL(symKeyReleased()), symbols0);
-    connect(main,    SIGNAL(entered()),
-            updater, SLOT(switchToMainView()));
+ViewMachine::State ViewMachine::state() const
+{
+    Q_D(const ViewMachine);
+    return d->state;
+}
+
+bool ViewMachine::dispatch(Event event)
+{
+    Q_D(ViewMachine);
+    const State next(Transitions[d->state][event]);
+
+    if (next == d->state) {
+        return false;
+    }
+
+    d->state = next;
+    enter(next);
 
-    symbols0->addTransition(updater, SIGNAL(symKeyReleased()), main);
-    symbols0->addTransition(updater, SIGNAL(symSwitcherReleased()), symbols1);
-    connect(symbols0, SIGNAL(entered()),
-            updater,  SLOT(switchToPrimarySymView()));
+    return true;
+}
 
-    symbols1->addTransition(updater, SIGNAL(symKeyReleased()), main);
-    symbols1->addTransition(updater, SIGNAL(symSwitcherReleased()), symbols0);
-    connect(symbols1, SIGNAL(entered()),
-            updater,  SLOT(switchToSecondarySymView()));
+void ViewMachine::enter(State state)
+{
+    Q_D(ViewMachine);
 
-    // Defer to first main loop iteration:
-    QTimer::singleShot(0, this, SLOT(start()));
+    if (not d->updater) {
+        return;
+    }
+
+    switch (state) {
+    case Symbols0:
+        d->updater->switchToPrimarySymView();
+        break;
+
+    default:
+        d->updater->syncLayoutToView();
+        break;
+    }
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -41,19 +41,43 @@ namespace MaliitKeyboard {
 namespace Logic {
 
 class LayoutUpdater;
+class ViewMachinePrivate;
 
 class ViewMachine
-    : public QStateMachine
-    , public AbstractStateMachine
+    : public AbstractStateMachine
 {
-    Q_OBJECT
     Q_DISABLE_COPY(ViewMachine)
+    Q_DECLARE_PRIVATE(ViewMachine)
 
 public:
-    explicit ViewMachine(QObject *parent = 0);
+    enum State {
+        Main,
+        Symbols0,
+        Symbols1,
+        NumStates
+    };
+
+    enum Event {
+        SymKeyReleased,
+        SymSwitcherReleased,
+        NumEvents
+    };
+
+    explicit ViewMachine();
     virtual ~ViewMachine();
 
+    //! \reimp
     virtual void setup(LayoutUpdater *updater);
+    virtual bool inState(const QString &name) const;
+    virtual void reset();
+    virtual void restart();
+    //! \reimp_end
+
+    State state() const;
+
+    //! Feeds event into the machine. Returns true and runs the entry
+    //! action of the new state if the event caused a transition.
+    bool dispatch(Event event);
 
     //! This state means that main layout is currently active.
     //! This is initial state.
@@ -64,6 +88,11 @@ public:
     //! This state means that second page of symbols layout is
     //! currently active.
     static const char *const symbols1_state;
+
+private:
+    void enter(State state);
+
+    const QScopedPointer<ViewMachinePrivate> d_ptr;
 };
 
 }} // namespace Logic, MaliitKeyboard
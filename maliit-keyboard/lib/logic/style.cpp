@@ -34,6 +34,10 @@
 #include "style.h"
 #include "coreutils.h"
 
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
 namespace MaliitKeyboard {
 
 //! \class Style
@@ -50,6 +54,151 @@ const QString g_extended_keys_fn_format("%1/%2/extended-keys.ini");
 const QString g_profile_image_directory_path_format("%1/%2/images");
 const QString g_profile_sounds_directory_path_format("%1/%2/sounds");
 const QString g_profile_fonts_directory_path_format("%1/%2/fonts");
+const QString g_compiled_fn_format("%1/styles/%2/%3.blob");
+
+const quint32 CompiledStyleMagic = 0x4d4b5359; // "MKSY"
+const quint32 CompiledStyleVersion = 1;
+
+// Compiled styles start with a header identifying the INI file they were
+// compiled from, followed by the flattened settings map.
+bool readCompiledStyleHeader(QDataStream *stream,
+                             QString *source,
+                             qint64 *modified)
+{
+    quint32 magic(0);
+    quint32 version(0);
+
+    stream->setVersion(QDataStream::Qt_4_6);
+    *stream >> magic >> version;
+
+    if (magic != CompiledStyleMagic || version != CompiledStyleVersion) {
+        return false;
+    }
+
+    *stream >> *source >> *modified;
+    return (stream->status() == QDataStream::Ok);
+}
+
+bool readCompiledStyle(QIODevice &device,
+                       QSettings::SettingsMap &map)
+{
+    QDataStream stream(&device);
+    QString source;
+    qint64 modified(0);
+
+    if (not readCompiledStyleHeader(&stream, &source, &modified)) {
+        return false;
+    }
+
+    stream >> map;
+    return (stream.status() == QDataStream::Ok);
+}
+
+bool writeCompiledStyle(QIODevice &device,
+                        const QSettings::SettingsMap &map)
+{
+    // Compiled styles are never modified through QSettings, see
+    // compileStyle().
+    Q_UNUSED(device)
+    Q_UNUSED(map)
+    return false;
+}
+
+QSettings::Format compiledStyleFormat()
+{
+    static const QSettings::Format format(QSettings::registerFormat("blob",
+                                                                    readCompiledStyle,
+                                                                    writeCompiledStyle));
+    return format;
+}
+
+bool isCompiledStyleValid(const QString &compiled_file_name,
+                          const QString &ini_file_name,
+                          qint64 ini_modified)
+{
+    QFile file(compiled_file_name);
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    QString source;
+    qint64 modified(0);
+
+    return (readCompiledStyleHeader(&stream, &source, &modified)
+            && source == ini_file_name
+            && modified == ini_modified);
+}
+
+bool compileStyle(const QString &ini_file_name,
+                  qint64 ini_modified,
+                  const QString &compiled_file_name)
+{
+    const QSettings ini(ini_file_name, QSettings::IniFormat);
+    QSettings::SettingsMap map;
+
+    Q_FOREACH (const QString &key, ini.allKeys()) {
+        map.insert(key, ini.value(key));
+    }
+
+    if (not QDir().mkpath(QFileInfo(compiled_file_name).absolutePath())) {
+        return false;
+    }
+
+    // Write to a temporary file first, so that concurrent readers never
+    // see a half-written blob:
+    const QString temp_file_name(compiled_file_name + ".tmp");
+    QFile file(temp_file_name);
+
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream << CompiledStyleMagic << CompiledStyleVersion
+           << ini_file_name << ini_modified << map;
+    file.close();
+
+    if (stream.status() != QDataStream::Ok) {
+        QFile::remove(temp_file_name);
+        return false;
+    }
+
+    QFile::remove(compiled_file_name);
+    return QFile::rename(temp_file_name, compiled_file_name);
+}
+
+//! Returns settings for given INI file. Uses a compiled blob from the
+//! cache directory, which is (re-)created whenever the INI file's
+//! modification time changes. Falls back to parsing the INI file if the
+//! cache is not writable.
+QSettings * loadStyleSettings(const QString &profile,
+                              const QString &name,
+                              const QString &ini_file_name)
+{
+    const QFileInfo ini_info(ini_file_name);
+
+    if (not ini_info.exists()) {
+        return new QSettings(ini_file_name, QSettings::IniFormat);
+    }
+
+    const qint64 ini_modified(ini_info.lastModified().toMSecsSinceEpoch());
+    const QString compiled_file_name(g_compiled_fn_format
+                                     .arg(CoreUtils::maliitKeyboardCacheDirectory())
+                                     .arg(profile)
+                                     .arg(name));
+
+    if (not isCompiledStyleValid(compiled_file_name, ini_file_name, ini_modified)
+        && not compileStyle(ini_file_name, ini_modified, compiled_file_name)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Could not compile style, using INI file directly:" << ini_file_name;
+        return new QSettings(ini_file_name, QSettings::IniFormat);
+    }
+
+    return new QSettings(compiled_file_name, compiledStyleFormat());
+}
 
 } // unnamed namespace
 
@@ -63,12 +212,14 @@ public:
     QString style_name; //!< The active style name.
     QScopedPointer<StyleAttributes> attributes; //!< The main style attributes.
     QScopedPointer<StyleAttributes> extended_keys_attributes; //!< The extended keys style attributes.
+    bool image_preloading_enabled; //!< Whether profileChanged waits for image preloading.
 
     explicit StylePrivate()
         : profile()
         , style_name()
         , attributes()
         , extended_keys_attributes()
+        , image_preloading_enabled(false)
     {}
 };
 
@@ -87,6 +238,10 @@ Style::~Style()
 //! \brief Sets the style profile.
 //!
 //! Invalidates previous StyleAttributes instances and creates new ones.
+//! INI files are compiled into binary blobs in the cache directory, so
+//! that later loads of the same profile skip INI parsing. If image
+//! preloading is enabled, profileChanged is only emitted once all images
+//! have been preloaded, see onImagesPreloaded().
 //! \param profile The name of the profile, must be a valid sub directory in
 //!                data/styles and contain at least a main.ini file.
 void Style::setProfile(const QString &profile)
@@ -106,18 +261,71 @@ void Style::setProfile(const QString &profile)
                                               .arg(profile));
 
         attributes =  new StyleAttributes(
-            new QSettings(main_file_name, QSettings::IniFormat));
+            loadStyleSettings(profile, "main", main_file_name));
         extended_keys_attributes = new StyleAttributes(
-            new QSettings(extended_keys_file_name, QSettings::IniFormat));
+            loadStyleSettings(profile, "extended-keys", extended_keys_file_name));
     }
 
     d->attributes.reset(attributes);
     d->extended_keys_attributes.reset(extended_keys_attributes);
 
+    if (d->image_preloading_enabled && not d->profile.isEmpty()) {
+        Q_EMIT imagePreloadRequested(directory(Images), imageFiles());
+        return;
+    }
+
     Q_EMIT profileChanged();
 }
 
 
+//! \brief Returns all images referenced by the main and extended keys
+//! style attributes, relative to directory(Images).
+QStringList Style::imageFiles() const
+{
+    QStringList files(attributes()->imageFiles());
+
+    Q_FOREACH (const QString &file, extendedKeysAttributes()->imageFiles()) {
+        if (not files.contains(file)) {
+            files.append(file);
+        }
+    }
+
+    return files;
+}
+
+
+//! \brief Returns whether profile changes wait for image preloading.
+bool Style::isImagePreloadingEnabled() const
+{
+    Q_D(const Style);
+    return d->image_preloading_enabled;
+}
+
+
+//! \brief Enables or disables image preloading.
+//!
+//! If enabled, setProfile emits imagePreloadRequested instead of
+//! profileChanged. The receiver is expected to decode the images and to
+//! call onImagesPreloaded afterwards.
+void Style::setImagePreloadingEnabled(bool enabled)
+{
+    Q_D(Style);
+    d->image_preloading_enabled = enabled;
+}
+
+
+//! \brief Emits profileChanged once images of the active profile are
+//! preloaded.
+//! \param directory The image directory that was preloaded. Results for
+//!                  previously active profiles are ignored.
+void Style::onImagesPreloaded(const QString &directory)
+{
+    if (directory == this->directory(Images)) {
+        Q_EMIT profileChanged();
+    }
+}
+
+
 //! \brief Returns the active style profile.
 QString Style::profile() const
 {
@@ -198,4 +406,16 @@ StyleAttributes * Style::extendedKeysAttributes() const
     return d->extended_keys_attributes.data();
 }
 
+
+//! \brief Estimated heap usage of the loaded style attributes, in bytes.
+//! Attributes that were not queried yet do not count.
+qint64 Style::memoryUsage() const
+{
+    Q_D(const Style);
+
+    // Does not create the lazily loaded attributes:
+    return ((d->attributes.isNull() ? 0 : d->attributes->memoryUsage())
+            + (d->extended_keys_attributes.isNull() ? 0 : d->extended_keys_attributes->memoryUsage()));
+}
+
 } // namespace MaliitKeyboard
@@ -71,6 +71,17 @@ public:
     StyleAttributes * attributes() const;
     StyleAttributes * extendedKeysAttributes() const;
 
+    QStringList imageFiles() const;
+
+    //! Estimated heap usage of the loaded style attributes, in bytes.
+    qint64 memoryUsage() const;
+
+    bool isImagePreloadingEnabled() const;
+    void setImagePreloadingEnabled(bool enabled);
+    Q_SIGNAL void imagePreloadRequested(const QString &directory,
+                                        const QStringList &file_names);
+    Q_SLOT void onImagesPreloaded(const QString &directory);
+
     Q_SIGNAL void profileChanged();
 
 private:
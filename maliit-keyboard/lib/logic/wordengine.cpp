@@ -32,6 +32,10 @@
 
 #include "wordengine.h"
 #include "spellchecker.h"
+#include "gesturedecoder.h"
+#include "candidatefusion.h"
+#include "tracer.h"
+#include "memoryusage.h"
 
 #ifdef HAVE_PRESAGE
 #include <presage.h>
@@ -64,12 +68,349 @@ void appendToCandidates(WordCandidateList *candidates,
     }
 }
 
+// Hunspell dictionaries are several megabytes; keep the last few around so
+// that toggling between two layouts does not reload them.
+const int MaxLoadedDictionaries = 3;
+
+const char * const DefaultLanguage = "en_gb";
+
+//! \internal
+//! Loads a spell checker on the loader thread pool and hands it back to
+//! the word engine through a queued call.
+class DictionaryLoader
+    : public QRunnable
+{
+private:
+    QObject *const m_receiver;
+    const QString m_language;
+
+public:
+    explicit DictionaryLoader(QObject *receiver,
+                              const QString &language);
+
+    void run();
+
+    static SharedSpellChecker load(const QString &language,
+                                   QString *dictionary);
+};
+
+DictionaryLoader::DictionaryLoader(QObject *receiver,
+                                   const QString &language)
+    : QRunnable()
+    , m_receiver(receiver)
+    , m_language(language)
+{}
+
+void DictionaryLoader::run()
+{
+    QString dictionary;
+    const SharedSpellChecker checker(load(m_language, &dictionary));
+
+    QMetaObject::invokeMethod(m_receiver, "onDictionaryLoaded", Qt::QueuedConnection,
+                              Q_ARG(QString, m_language),
+                              Q_ARG(QString, dictionary),
+                              Q_ARG(SharedSpellChecker, checker));
+}
+
+//! Returns a null pointer if no dictionary is installed for language.
+//! Otherwise, dictionary is set to its path, without file extension.
+SharedSpellChecker DictionaryLoader::load(const QString &language,
+                                          QString *dictionary)
+{
+    *dictionary = SpellChecker::dictionaryForLanguage(language);
+
+    if (dictionary->isEmpty()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "No dictionary found for language:" << language;
+        return SharedSpellChecker();
+    }
+
+    return SharedSpellChecker(new SpellChecker(*dictionary));
+}
+
+//! Builds the gesture lexicon of a dictionary on the loader thread pool.
+//! The lexicon is large, so this only happens while gesture typing is
+//! enabled.
+class GestureLexiconLoader
+    : public QRunnable
+{
+private:
+    QObject *const m_receiver;
+    const QString m_language;
+    const QString m_dictionary;
+
+public:
+    explicit GestureLexiconLoader(QObject *receiver,
+                                  const QString &language,
+                                  const QString &dictionary);
+
+    void run();
+};
+
+GestureLexiconLoader::GestureLexiconLoader(QObject *receiver,
+                                           const QString &language,
+                                           const QString &dictionary)
+    : QRunnable()
+    , m_receiver(receiver)
+    , m_language(language)
+    , m_dictionary(dictionary)
+{}
+
+void GestureLexiconLoader::run()
+{
+    const SharedGestureDecoder decoder(new GestureDecoder);
+    decoder->setLexicon(GestureDecoder::lexiconFromDictionary(m_dictionary));
+
+    QMetaObject::invokeMethod(m_receiver, "onGestureLexiconLoaded", Qt::QueuedConnection,
+                              Q_ARG(QString, m_language),
+                              Q_ARG(SharedGestureDecoder, decoder));
+}
+//! \internal_end
+
+// FIXME: max_candidates should come from style, too:
+//! Maximum number of candidates shown in the word ribbon.
+const int MaxCandidates = 7;
+
+#ifdef HAVE_PRESAGE
+//! Number of characters left of the cursor given to Presage as context.
+//! Presage only looks at the last few words anyway.
+const int PredictionContextLength = 256;
+
+QString predictionContext(Model::Text *text)
+{
+    const int offset(text->surroundingOffset());
+    return text->surroundingMid(offset - PredictionContextLength, PredictionContextLength);
+}
+
+//! Caller needs to hold the Presage mutex.
+QStringList predict(Presage *presage,
+                    std::string *context_stream,
+                    const QString &context)
+{
+    *context_stream = context.toStdString();
+    const std::vector<std::string> predictions(presage->predict());
+
+    QStringList result;
+    const int count(qMin<int>(predictions.size(), MaxCandidates));
+    for (int index = 0; index < count; ++index) {
+        result.append(QString::fromStdString(predictions.at(index)));
+    }
+
+    return result;
+}
+
+class PresageJob
+    : public CandidateFusion::Job
+{
+public:
+    explicit PresageJob(Presage *presage,
+                        QMutex *presage_mutex,
+                        std::string *context_stream,
+                        const QString &context)
+        : CandidateFusion::Job()
+        , m_presage(presage)
+        , m_presage_mutex(presage_mutex)
+        , m_context_stream(context_stream)
+        , m_context(context)
+    {}
+
+private:
+    QStringList run(bool *misspelled)
+    {
+        Q_UNUSED(misspelled)
+        QMutexLocker locker(m_presage_mutex);
+
+        // TODO: Fine-tune presage behaviour to also perform error correction, not just word prediction.
+        return predict(m_presage, m_context_stream, m_context);
+    }
+
+    Presage *const m_presage;
+    QMutex *const m_presage_mutex;
+    std::string *const m_context_stream;
+    const QString m_context;
+};
+#endif
+
+//! Words added to the user dictionary, waiting to be added to Hunspell.
+//! Whoever holds the spell checker mutex next adds them, so that the GUI
+//! thread never waits for a running spell checker query.
+class UserWordQueue
+{
+public:
+    explicit UserWordQueue();
+
+    void append(const QString &word);
+    void addTo(SpellChecker *spell_checker);
+
+private:
+    QMutex m_mutex;
+    QStringList m_words;
+};
+
+UserWordQueue::UserWordQueue()
+    : m_mutex()
+    , m_words()
+{}
+
+void UserWordQueue::append(const QString &word)
+{
+    QMutexLocker locker(&m_mutex);
+    m_words.append(word);
+}
+
+//! Caller needs to hold the spell checker mutex.
+void UserWordQueue::addTo(SpellChecker *spell_checker)
+{
+    QStringList words;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        words.swap(m_words);
+    }
+
+    Q_FOREACH (const QString &word, words) {
+        spell_checker->addToUserWordlist(word);
+    }
+}
+
+class SpellCheckerJob
+    : public CandidateFusion::Job
+{
+public:
+    explicit SpellCheckerJob(const SharedSpellChecker &spell_checker,
+                             QMutex *spell_checker_mutex,
+                             UserWordQueue *user_word_queue,
+                             const QString &word)
+        : CandidateFusion::Job()
+        , m_spell_checker(spell_checker)
+        , m_spell_checker_mutex(spell_checker_mutex)
+        , m_user_word_queue(user_word_queue)
+        , m_word(word)
+    {}
+
+private:
+    QStringList run(bool *misspelled)
+    {
+        QMutexLocker locker(m_spell_checker_mutex);
+
+        m_user_word_queue->addTo(m_spell_checker.data());
+        *misspelled = not m_spell_checker->spell(m_word);
+
+        return (*misspelled ? m_spell_checker->suggest(m_word, 5)
+                            : QStringList());
+    }
+
+    const SharedSpellChecker m_spell_checker;
+    QMutex *const m_spell_checker_mutex;
+    UserWordQueue *const m_user_word_queue;
+    const QString m_word;
+};
+
+class UserDictionaryJob
+    : public CandidateFusion::Job
+{
+public:
+    explicit UserDictionaryJob(const QStringList &user_words,
+                               const QString &prefix)
+        : CandidateFusion::Job()
+        , m_user_words(user_words)
+        , m_prefix(prefix)
+    {}
+
+private:
+    QStringList run(bool *misspelled)
+    {
+        Q_UNUSED(misspelled)
+        QStringList result;
+
+        Q_FOREACH (const QString &word, m_user_words) {
+            if (word.length() > m_prefix.length()
+                && word.startsWith(m_prefix, Qt::CaseInsensitive)) {
+                result.append(word);
+
+                if (result.count() >= MaxCandidates) {
+                    break;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    const QStringList m_user_words;
+    const QString m_prefix;
+};
+
+#ifdef HAVE_PRESAGE
+//! Predicts the words following a context on its own thread and reports
+//! back through a queued call. Clears its busy flag when done, so that
+//! predictions do not pile up.
+class NextWordJob
+    : public QRunnable
+{
+public:
+    explicit NextWordJob(QObject *receiver,
+                         int request,
+                         const QString &previous_word,
+                         QAtomicInt *busy,
+                         Presage *presage,
+                         QMutex *presage_mutex,
+                         std::string *context_stream,
+                         const QString &context)
+        : QRunnable()
+        , m_receiver(receiver)
+        , m_request(request)
+        , m_previous_word(previous_word)
+        , m_busy(busy)
+        , m_presage(presage)
+        , m_presage_mutex(presage_mutex)
+        , m_context_stream(context_stream)
+        , m_context(context)
+    {}
+
+    void run()
+    {
+        QStringList result;
+
+        {
+            QMutexLocker locker(m_presage_mutex);
+            result = predict(m_presage, m_context_stream, m_context);
+        }
+
+        m_busy->fetchAndStoreRelease(0);
+
+        QMetaObject::invokeMethod(m_receiver, "onNextWordPredicted", Qt::QueuedConnection,
+                                  Q_ARG(int, m_request),
+                                  Q_ARG(QString, m_previous_word),
+                                  Q_ARG(QStringList, result));
+    }
+
+private:
+    QObject *const m_receiver;
+    const int m_request;
+    const QString m_previous_word;
+    QAtomicInt *const m_busy;
+    Presage *const m_presage;
+    QMutex *const m_presage_mutex;
+    std::string *const m_context_stream;
+    const QString m_context;
+};
+#endif
+
+//! Number of preceding words for which next word predictions are kept.
+const int MaxCachedNextWords = 200;
+
 } // namespace
 
 //! \class WordEngine
 //! \brief Provides error correction (based on Hunspell) and word
 //! prediction (based on Presage).
 
+//! \fn void WordEngine::dictionaryLoaded(const QString &language)
+//! \brief Emitted when loading the dictionary of a language has finished,
+//! whether or not one was found.
+//! \sa loadedLanguages()
+
 //! \internal
 #ifdef HAVE_PRESAGE
 class CandidatesCallback
@@ -106,24 +447,84 @@ std::string CandidatesCallback::get_future_stream() const
 class WordEnginePrivate
 {
 public:
-    SpellChecker spell_checker;
+    struct Dictionary
+    {
+        QString language;
+        QString path;
+        SharedSpellChecker spell_checker;
+        SharedGestureDecoder gesture_decoder; //!< Only while gesture typing is enabled.
+    };
+
+    SharedSpellChecker spell_checker; //!< Active spell checker, null while loading.
+    SharedGestureDecoder gesture_decoder; //!< Active gesture decoder, null while loading.
+    QList<Dictionary> loaded_dictionaries; //!< Most recently used first.
+    QString language;
+    QSet<QString> pending_languages; //!< Languages queued on the loader pool.
+    bool initial_load_attempted; //!< Only the very first dictionary gets loaded synchronously.
+    QSet<QString> pending_lexicons; //!< Gesture lexicons queued on the loader pool.
+    QThreadPool loader_pool;
+    QMutex spell_checker_mutex; //!< Guards Hunspell against concurrent queries and additions.
+    UserWordQueue user_word_queue;
+    QStringList user_words;
 #ifdef HAVE_PRESAGE
     std::string candidates_context;
     CandidatesCallback presage_candidates;
     Presage presage;
+    QMutex presage_mutex; //!< Guards Presage, shared by candidate and next word queries.
 #endif
+    QAtomicInt next_word_busy; //!< Whether a next word prediction is still running.
+    QCache<QString, QStringList> next_words; //!< Predictions, keyed by preceding word.
+    int next_word_request; //!< Invalidates pending predictions once user types.
+    int next_words_language_request; //!< Last request before the language changed.
+    QThreadPool next_word_pool;
+    int candidate_backends; //!< Bit mask of queried CandidateFusion::Backend values.
+    CandidateFusion fusion;
 
     explicit WordEnginePrivate();
 };
 
 WordEnginePrivate::WordEnginePrivate()
     : spell_checker()
+    , gesture_decoder()
+    , loaded_dictionaries()
+    , language()
+    , pending_languages()
+    , initial_load_attempted(false)
+    , pending_lexicons()
+    , loader_pool()
+    , spell_checker_mutex()
+    , user_word_queue()
+    , user_words()
 #ifdef HAVE_PRESAGE
     , candidates_context()
     , presage_candidates(CandidatesCallback(candidates_context))
     , presage(&presage_candidates)
+    , presage_mutex()
 #endif
+    , next_word_busy(0)
+    , next_words(MaxCachedNextWords)
+    , next_word_request(0)
+    , next_words_language_request(0)
+    , next_word_pool()
+    , candidate_backends(WordEngine::AllCandidateBackends)
+    , fusion(WordEngine::CandidatesTimeBudget)
 {
+    // Loading one dictionary at a time keeps memory usage bounded when the
+    // user cycles quickly through several layouts.
+    loader_pool.setMaxThreadCount(1);
+    next_word_pool.setMaxThreadCount(1);
+
+    QFile file(SpellChecker::defaultUserDictionary());
+    if (file.open(QFile::ReadOnly)) {
+        QTextStream stream(&file);
+        while (not stream.atEnd()) {
+            const QString word(stream.readLine().trimmed());
+            if (not word.isEmpty()) {
+                user_words.append(word);
+            }
+        }
+    }
+
     // FIXME: Check whether spellchecker is enabled, and update enabled flag!
 #ifdef HAVE_PRESAGE
     presage.config("Presage.Selector.SUGGESTIONS", "6");
@@ -138,11 +539,28 @@ WordEnginePrivate::WordEnginePrivate()
 WordEngine::WordEngine(QObject *parent)
     : AbstractWordEngine(parent)
     , d_ptr(new WordEnginePrivate)
-{}
+{
+    qRegisterMetaType<SharedSpellChecker>("SharedSpellChecker");
+    qRegisterMetaType<SharedGestureDecoder>("SharedGestureDecoder");
+    setLanguage(DefaultLanguage);
+}
 
 //! \brief Destructor.
 WordEngine::~WordEngine()
-{}
+{
+    Q_D(WordEngine);
+
+    // Pending loaders hold a pointer to this instance, and late backend
+    // jobs still use Presage and the spell checker mutex:
+    d->loader_pool.waitForDone();
+    d->fusion.waitForDone();
+    d->next_word_pool.waitForDone();
+
+    if (d->spell_checker) {
+        QMutexLocker locker(&d->spell_checker_mutex);
+        d->user_word_queue.addTo(d->spell_checker.data());
+    }
+}
 
 
 void WordEngine::setEnabled(bool enabled)
@@ -161,8 +579,13 @@ void WordEngine::setEnabled(bool enabled)
 }
 
 
+//! Queries all available backends in parallel and merges their results by
+//! score. Backends which did not answer within CandidatesTimeBudget
+//! contribute their result for an earlier keystroke instead, see
+//! CandidateFusion.
 WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
 {
+    MALIIT_TRACE_SCOPE("WordEngine::fetchCandidates");
     WordCandidateList candidates;
  
 #ifdef DISABLE_PREEDIT
@@ -171,32 +594,49 @@ WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
 #else
     Q_D(WordEngine);
 
+    // Pending next word predictions are outdated now:
+    ++d->next_word_request;
+
     const QString &preedit(text->preedit());
     const bool is_preedit_capitalized(not preedit.isEmpty() && preedit.at(0).isUpper());
 
+    d->fusion.begin(preedit);
+
 #ifdef HAVE_PRESAGE
-    const QString &context = (text->surroundingLeft() + preedit);
-    d->candidates_context = context.toStdString();
-    const std::vector<std::string> predictions = d->presage.predict();
-
-    // TODO: Fine-tune presage behaviour to also perform error correction, not just word prediction.
-    if (not context.isEmpty()) {
-        // FIXME: max_candidates should come from style, too:
-        const static unsigned int max_candidates = 7;
-        const int count(qMin<int>(predictions.size(), max_candidates));
-        for (int index = 0; index < count; ++index) {
-            appendToCandidates(&candidates, WordCandidate::SourcePrediction, QString::fromStdString(predictions.at(index)),
-                               is_preedit_capitalized);
-        }
+    const QString context(predictionContext(text) + preedit);
+    if (not context.isEmpty()
+        && (d->candidate_backends & (1 << CandidateFusion::BackendPresage))) {
+        d->fusion.start(CandidateFusion::BackendPresage,
+                        new PresageJob(&d->presage, &d->presage_mutex,
+                                       &d->candidates_context, context));
     }
 #endif
 
-    const bool correct_spelling(d->spell_checker.spell(preedit));
+    // Without a spell checker (dictionary still loading, or none installed
+    // for the current language) every word is considered correct.
+    if (d->spell_checker
+        && (d->candidate_backends & (1 << CandidateFusion::BackendSpellChecker))) {
+        d->fusion.start(CandidateFusion::BackendSpellChecker,
+                        new SpellCheckerJob(d->spell_checker, &d->spell_checker_mutex,
+                                            &d->user_word_queue, preedit));
+    }
+
+    if (not d->user_words.isEmpty()
+        && (d->candidate_backends & (1 << CandidateFusion::BackendUserDictionary))) {
+        d->fusion.start(CandidateFusion::BackendUserDictionary,
+                        new UserDictionaryJob(d->user_words, preedit));
+    }
+
+    bool misspelled = false;
+    const QList<CandidateFusion::Candidate> fused(d->fusion.finish(&misspelled));
+    const bool correct_spelling(not misspelled);
 
-    if (candidates.isEmpty() and not correct_spelling) {
-        Q_FOREACH(const QString &correction, d->spell_checker.suggest(preedit, 5)) {
-            appendToCandidates(&candidates, WordCandidate::SourceSpellChecking, correction, is_preedit_capitalized);
+    Q_FOREACH (const CandidateFusion::Candidate &candidate, fused) {
+        if (candidates.count() >= MaxCandidates) {
+            break;
         }
+
+        appendToCandidates(&candidates, candidate.source, candidate.word, is_preedit_capitalized);
     }
 
     text->setPreeditFace(candidates.isEmpty() ? (correct_spelling ? Model::Text::PreeditDefault
@@ -211,11 +651,302 @@ WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
 #endif
 }
 
+WordCandidateList WordEngine::fetchGestureCandidates(const QVector<QPoint> &trajectory,
+                                                     const KeyArea &key_area)
+{
+    Q_D(WordEngine);
+
+    WordCandidateList candidates;
+
+    if (not d->gesture_decoder) {
+        return candidates;
+    }
+
+    Q_FOREACH (const QString &word, d->gesture_decoder->decode(trajectory, key_area, MaxCandidates)) {
+        appendToCandidates(&candidates, WordCandidate::SourcePrediction, word, false);
+    }
+
+    return candidates;
+}
+
+//! Uses cached predictions for the preceding word if possible, otherwise
+//! asks Presage in the background.
+void WordEngine::fetchNextWordCandidates(Model::Text *text)
+{
+#ifdef HAVE_PRESAGE
+    Q_D(WordEngine);
+
+    const QString context(predictionContext(text));
+    const QString previous_word(context.simplified().section(' ', -1).toLower());
+
+    if (previous_word.isEmpty() || not previous_word.at(previous_word.length() - 1).isLetter()) {
+        return;
+    }
+
+    const int request(++d->next_word_request);
+
+    if (const QStringList *cached = d->next_words.object(previous_word)) {
+        onNextWordPredicted(request, previous_word, *cached);
+        return;
+    }
+
+    // Skip if a previous prediction is still running:
+    if (d->next_word_busy.testAndSetAcquire(0, 1)) {
+        d->next_word_pool.start(new NextWordJob(this, request, previous_word, &d->next_word_busy,
+                                                &d->presage, &d->presage_mutex,
+                                                &d->candidates_context, context));
+    }
+#else
+    Q_UNUSED(text)
+#endif
+}
+
+void WordEngine::onNextWordPredicted(int request,
+                                     const QString &previous_word,
+                                     const QStringList &predictions)
+{
+    Q_D(WordEngine);
+
+    // Predictions requested before a language change are not cached:
+    if (request > d->next_words_language_request
+        && not d->next_words.contains(previous_word)) {
+        d->next_words.insert(previous_word, new QStringList(predictions));
+    }
+
+    if (request != d->next_word_request) {
+        return;
+    }
+
+    WordCandidateList candidates;
+    Q_FOREACH (const QString &prediction, predictions) {
+        appendToCandidates(&candidates, WordCandidate::SourcePrediction, prediction, false);
+    }
+
+    setNextWordCandidates(candidates);
+}
+
+//! Builds the gesture lexicon of the current language when enabled, and
+//! frees all gesture lexicons when disabled.
+void WordEngine::setGestureTypingEnabled(bool enabled)
+{
+    Q_D(WordEngine);
+
+    AbstractWordEngine::setGestureTypingEnabled(enabled);
+
+    if (enabled) {
+        loadGestureLexicon();
+        return;
+    }
+
+    d->gesture_decoder.clear();
+
+    for (int index = 0; index < d->loaded_dictionaries.count(); ++index) {
+        d->loaded_dictionaries[index].gesture_decoder.clear();
+    }
+}
+
 void WordEngine::addToUserDictionary(const QString &word)
 {
     Q_D(WordEngine);
 
-    d->spell_checker.addToUserWordlist(word);
+    if (not d->user_words.contains(word)) {
+        d->user_words.append(word);
+    }
+
+    // Never wait for a running spell checker query; if there is one, the
+    // next query adds the word instead:
+    d->user_word_queue.append(word);
+
+    if (d->spell_checker && d->spell_checker_mutex.tryLock()) {
+        d->user_word_queue.addTo(d->spell_checker.data());
+        d->spell_checker_mutex.unlock();
+    }
+}
+
+//! \brief Switches the spell checker to the dictionary of a language.
+//! \param language The language attribute of the active layout.
+//!
+//! Recently used dictionaries are reused right away, others are loaded in
+//! the background. Until loading has finished, no spelling corrections or
+//! gesture candidates are offered. The first dictionary is loaded right
+//! away though, as there would be no corrections at all otherwise. This
+//! happens only once, even if that first load failed.
+void WordEngine::setLanguage(const QString &language)
+{
+    Q_D(WordEngine);
+
+    if (d->language == language) {
+        return;
+    }
+
+    d->language = language;
+
+    // Next word predictions are only valid for the language they were
+    // made for:
+    d->next_words.clear();
+    d->next_words_language_request = ++d->next_word_request;
+
+    for (int index = 0; index < d->loaded_dictionaries.count(); ++index) {
+        if (d->loaded_dictionaries.at(index).language == language) {
+            d->loaded_dictionaries.move(index, 0);
+            d->spell_checker = d->loaded_dictionaries.first().spell_checker;
+            d->gesture_decoder = d->loaded_dictionaries.first().gesture_decoder;
+            clearCandidates();
+            loadGestureLexicon();
+            return;
+        }
+    }
+
+    d->spell_checker.clear();
+    d->gesture_decoder.clear();
+    clearCandidates();
+
+    if (not d->initial_load_attempted) {
+        d->initial_load_attempted = true;
+
+        QString dictionary;
+        const SharedSpellChecker spell_checker(DictionaryLoader::load(language, &dictionary));
+        onDictionaryLoaded(language, dictionary, spell_checker);
+    } else if (not d->pending_languages.contains(language)) {
+        d->pending_languages.insert(language);
+        d->loader_pool.start(new DictionaryLoader(this, language));
+    }
+}
+
+//! \brief Returns the languages whose dictionaries are kept in memory,
+//! most recently used first.
+QStringList WordEngine::loadedLanguages() const
+{
+    Q_D(const WordEngine);
+    QStringList languages;
+
+    Q_FOREACH (const WordEnginePrivate::Dictionary &dictionary, d->loaded_dictionaries) {
+        languages.append(dictionary.language);
+    }
+
+    return languages;
+}
+
+//! \brief Returns whether the dictionary of the current language is still
+//! being loaded in the background.
+bool WordEngine::isLoadingDictionary() const
+{
+    Q_D(const WordEngine);
+    return d->pending_languages.contains(d->language);
+}
+
+//! \brief Restricts candidate queries to some backends, for benchmarks.
+//! \param backends Bit mask, one bit per CandidateFusion::Backend value.
+void WordEngine::setCandidateBackends(int backends)
+{
+    Q_D(WordEngine);
+    d->candidate_backends = backends;
+}
+
+//! \brief Changes how long candidate queries wait for backends.
+//! \param milliseconds Negative to wait for all backends, which lets
+//!                     benchmarks time the backends themselves.
+void WordEngine::setCandidatesTimeBudget(int milliseconds)
+{
+    Q_D(WordEngine);
+    d->fusion.setTimeBudget(milliseconds);
+}
+
+//! Presage's own memory is not included, as it offers no way to query it.
+qint64 WordEngine::memoryUsage() const
+{
+    Q_D(const WordEngine);
+    qint64 usage(MemoryUsage::ofStringList(d->user_words));
+
+    Q_FOREACH (const WordEnginePrivate::Dictionary &dictionary, d->loaded_dictionaries) {
+        if (dictionary.spell_checker) {
+            usage += dictionary.spell_checker->memoryUsage();
+        }
+
+        if (dictionary.gesture_decoder) {
+            usage += dictionary.gesture_decoder->memoryUsage();
+        }
+    }
+
+    Q_FOREACH (const QString &previous_word, d->next_words.keys()) {
+        usage += (MemoryUsage::ofString(previous_word)
+                  + MemoryUsage::ofStringList(*d->next_words.object(previous_word)));
+    }
+
+    return usage;
+}
+
+void WordEngine::onDictionaryLoaded(const QString &language,
+                                    const QString &dictionary_path,
+                                    const SharedSpellChecker &spell_checker)
+{
+    Q_D(WordEngine);
+
+    d->pending_languages.remove(language);
+
+    // Failed loads are not cached, so that a dictionary installed later on
+    // is picked up when switching back to its language.
+    if (spell_checker) {
+        WordEnginePrivate::Dictionary dictionary;
+        dictionary.language = language;
+        dictionary.path = dictionary_path;
+        dictionary.spell_checker = spell_checker;
+        d->loaded_dictionaries.prepend(dictionary);
+
+        while (d->loaded_dictionaries.count() > MaxLoadedDictionaries) {
+            d->loaded_dictionaries.removeLast();
+        }
+    }
+
+    // User might have switched to yet another language meanwhile:
+    if (d->language == language) {
+        d->spell_checker = spell_checker;
+        loadGestureLexicon();
+    }
+
+    Q_EMIT dictionaryLoaded(language);
+}
+
+//! Builds the gesture lexicon of the current dictionary in the background,
+//! if gesture typing is enabled and the lexicon is not there yet.
+void WordEngine::loadGestureLexicon()
+{
+    Q_D(WordEngine);
+
+    if (not isGestureTypingEnabled()
+        || d->gesture_decoder
+        || d->loaded_dictionaries.isEmpty()
+        || d->loaded_dictionaries.first().language != d->language
+        || d->pending_lexicons.contains(d->language)) {
+        return;
+    }
+
+    d->pending_lexicons.insert(d->language);
+    d->loader_pool.start(new GestureLexiconLoader(this, d->language,
+                                                  d->loaded_dictionaries.first().path));
+}
+
+void WordEngine::onGestureLexiconLoaded(const QString &language,
+                                        const SharedGestureDecoder &gesture_decoder)
+{
+    Q_D(WordEngine);
+
+    d->pending_lexicons.remove(language);
+
+    // Gesture typing might have been disabled meanwhile:
+    if (not isGestureTypingEnabled()) {
+        return;
+    }
+
+    for (int index = 0; index < d->loaded_dictionaries.count(); ++index) {
+        if (d->loaded_dictionaries.at(index).language == language) {
+            d->loaded_dictionaries[index].gesture_decoder = gesture_decoder;
+        }
+    }
+
+    if (d->language == language) {
+        d->gesture_decoder = gesture_decoder;
+    }
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -35,6 +35,9 @@
 
 #include "models/text.h"
 #include "logic/abstractwordengine.h"
+#include "logic/spellchecker.h"
+#include "logic/gesturedecoder.h"
+#include "logic/candidatefusion.h"
 
 #include <QtCore>
 
@@ -51,18 +54,45 @@ class WordEngine
     Q_DECLARE_PRIVATE(WordEngine)
 
 public:
+    enum {
+        AllCandidateBackends = (1 << CandidateFusion::BackendCount) - 1,
+        CandidatesTimeBudget = 20 //!< For a single keystroke, in milliseconds.
+    };
+
     explicit WordEngine(QObject *parent = 0);
     virtual ~WordEngine();
 
     //! \reimp
     virtual void setEnabled(bool enabled);
+    virtual void setGestureTypingEnabled(bool enabled);
 
     virtual void addToUserDictionary(const QString &word);
+    Q_SLOT virtual void setLanguage(const QString &language);
+    virtual qint64 memoryUsage() const;
     //! \reimp_end
 
+    QStringList loadedLanguages() const;
+    bool isLoadingDictionary() const;
+    void setCandidateBackends(int backends);
+    void setCandidatesTimeBudget(int milliseconds);
+    Q_SIGNAL void dictionaryLoaded(const QString &language);
+
 private:
+    Q_SLOT void onDictionaryLoaded(const QString &language,
+                                   const QString &dictionary_path,
+                                   const SharedSpellChecker &spell_checker);
+    Q_SLOT void onGestureLexiconLoaded(const QString &language,
+                                       const SharedGestureDecoder &gesture_decoder);
+    void loadGestureLexicon();
+    Q_SLOT void onNextWordPredicted(int request,
+                                    const QString &previous_word,
+                                    const QStringList &predictions);
+
     //! \reimp
     virtual WordCandidateList fetchCandidates(Model::Text *text);
+    virtual WordCandidateList fetchGestureCandidates(const QVector<QPoint> &trajectory,
+                                                     const KeyArea &key_area);
+    virtual void fetchNextWordCandidates(Model::Text *text);
     //! \reimp_end
 
     const QScopedPointer<WordEnginePrivate> d_ptr;
@@ -0,0 +1,242 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "memoryusage.h"
+#include "parser/alltagtypes.h"
+#include "parser/tagbinding.h"
+#include "parser/tagextended.h"
+#include "parser/tagkey.h"
+#include "parser/tagkeyboard.h"
+#include "parser/taglayout.h"
+#include "parser/tagmodifiers.h"
+#include "parser/tagrow.h"
+#include "parser/tagrowelement.h"
+#include "parser/tagsection.h"
+#include "parser/tagspacer.h"
+
+#include <unistd.h>
+
+namespace MaliitKeyboard {
+namespace MemoryUsage {
+namespace {
+
+//! Rough size of a QSharedPointer control block.
+const qint64 SharedPointerOverhead = 2 * sizeof(void *) + 2 * sizeof(int);
+
+//! A tag object, owned through a QSharedPointer.
+template <typename T>
+qint64 ofTag()
+{
+    return sizeof(T) + SharedPointerOverhead;
+}
+
+qint64 ofTagList(int count)
+{
+    // QList stores pointers to heap-allocated QSharedPointer instances:
+    return count * (sizeof(void *) + sizeof(QSharedPointer<TagRow>));
+}
+
+qint64 ofTagBinding(const TagBindingPtr &binding);
+qint64 ofTagRows(const TagRowPtrs &rows);
+
+qint64 ofTagBindingContainer(const TagBindingContainer &container)
+{
+    return ofTagBinding(container.binding());
+}
+
+qint64 ofTagBinding(const TagBindingPtr &binding)
+{
+    if (binding.isNull()) {
+        return 0;
+    }
+
+    qint64 usage(ofTag<TagBinding>()
+                 + ofString(binding->label())
+                 + ofString(binding->secondary_label())
+                 + ofString(binding->accents())
+                 + ofString(binding->accented_labels())
+                 + ofString(binding->cycle_set())
+                 + ofString(binding->sequence())
+                 + ofString(binding->icon()));
+
+    const TagModifiersPtrs modifiers(binding->modifiers());
+    usage += ofTagList(modifiers.count());
+
+    Q_FOREACH (const TagModifiersPtr &modifier, modifiers) {
+        usage += ofTag<TagModifiers>() + ofTagBindingContainer(*modifier);
+    }
+
+    return usage;
+}
+
+qint64 ofTagKey(const TagKey &key)
+{
+    qint64 usage(ofTag<TagKey>()
+                 + ofString(key.id())
+                 + ofTagBindingContainer(key));
+
+    const TagExtendedPtr extended(key.extended());
+
+    if (not extended.isNull()) {
+        usage += ofTag<TagExtended>() + ofTagRows(extended->rows());
+    }
+
+    return usage;
+}
+
+qint64 ofTagRows(const TagRowPtrs &rows)
+{
+    qint64 usage(ofTagList(rows.count()));
+
+    Q_FOREACH (const TagRowPtr &row, rows) {
+        const TagRowElementPtrs elements(row->elements());
+        usage += ofTag<TagRow>() + ofTagList(elements.count());
+
+        Q_FOREACH (const TagRowElementPtr &element, elements) {
+            switch (element->element_type()) {
+            case TagRowElement::Key:
+                usage += ofTagKey(*static_cast<const TagKey *>(element.data()));
+                break;
+
+            case TagRowElement::Spacer:
+                usage += ofTag<TagSpacer>();
+                break;
+            }
+        }
+    }
+
+    return usage;
+}
+
+} // unnamed namespace
+
+qint64 ofString(const QString &string)
+{
+    return string.isNull() ? 0 : (sizeof(QStringData) + (string.capacity() + 1) * sizeof(QChar));
+}
+
+qint64 ofByteArray(const QByteArray &array)
+{
+    return array.isNull() ? 0 : (sizeof(QByteArrayData) + array.capacity() + 1);
+}
+
+qint64 ofStringList(const QStringList &list)
+{
+    qint64 usage(list.count() * sizeof(void *));
+
+    Q_FOREACH (const QString &string, list) {
+        usage += ofString(string);
+    }
+
+    return usage;
+}
+
+qint64 ofKey(const Key &key)
+{
+    const Label &label(key.label());
+
+    return (ofString(label.text())
+            + ofByteArray(label.font().name())
+            + ofByteArray(label.font().color())
+            + ofByteArray(key.area().background())
+            + ofByteArray(key.icon())
+            + ofString(key.commandSequence()));
+}
+
+qint64 ofKeys(const QVector<Key> &keys)
+{
+    qint64 usage(keys.capacity() * sizeof(Key));
+
+    Q_FOREACH (const Key &key, keys) {
+        usage += ofKey(key);
+    }
+
+    return usage;
+}
+
+qint64 ofKeyArea(const KeyArea &key_area)
+{
+    return ofKeys(key_area.keys()) + ofByteArray(key_area.area().background());
+}
+
+qint64 ofKeyboard(const Keyboard &keyboard)
+{
+    return (ofString(keyboard.style_name)
+            + ofKeys(keyboard.keys)
+            + keyboard.key_descriptions.capacity() * sizeof(KeyDescription));
+}
+
+qint64 ofTagKeyboard(const TagKeyboardPtr &keyboard)
+{
+    if (keyboard.isNull()) {
+        return 0;
+    }
+
+    const TagLayoutPtrs layouts(keyboard->layouts());
+    qint64 usage(ofTag<TagKeyboard>()
+                 + ofString(keyboard->version())
+                 + ofString(keyboard->title())
+                 + ofString(keyboard->language())
+                 + ofString(keyboard->catalog())
+                 + ofTagList(layouts.count()));
+
+    Q_FOREACH (const TagLayoutPtr &layout, layouts) {
+        const TagSectionPtrs sections(layout->sections());
+        usage += ofTag<TagLayout>() + ofTagList(sections.count());
+
+        Q_FOREACH (const TagSectionPtr &section, sections) {
+            usage += (ofTag<TagSection>()
+                      + ofString(section->id())
+                      + ofString(section->style())
+                      + ofTagRows(section->rows()));
+        }
+    }
+
+    return usage;
+}
+
+qint64 residentSetSize()
+{
+    // Second field of statm is the number of resident pages:
+    QFile statm("/proc/self/statm");
+
+    if (not statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    const QList<QByteArray> fields(statm.readAll().split(' '));
+    bool ok(false);
+    const qint64 pages(fields.count() > 1 ? fields.at(1).toLongLong(&ok) : 0);
+
+    return ok ? pages * sysconf(_SC_PAGESIZE) : -1;
+}
+
+}} // namespace MemoryUsage, MaliitKeyboard
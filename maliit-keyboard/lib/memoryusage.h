@@ -0,0 +1,67 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_MEMORYUSAGE_H
+#define MALIIT_KEYBOARD_MEMORYUSAGE_H
+
+#include "models/keyarea.h"
+#include "models/keyboard.h"
+#include "parser/alltagtypes.h"
+
+#include <QtCore>
+
+//! \file memoryusage.h
+//! Estimates heap usage of the keyboard's data structures, in bytes.
+//!
+//! The estimates cover the objects themselves and the payload of their
+//! strings and containers, but not allocator overhead. Implicitly shared
+//! data is counted for every owner, so numbers err on the high side.
+
+namespace MaliitKeyboard {
+namespace MemoryUsage {
+
+qint64 ofString(const QString &string);
+qint64 ofByteArray(const QByteArray &array);
+qint64 ofStringList(const QStringList &list);
+
+//! Payload of a key, excluding sizeof(Key) itself.
+qint64 ofKey(const Key &key);
+qint64 ofKeys(const QVector<Key> &keys);
+qint64 ofKeyArea(const KeyArea &key_area);
+qint64 ofKeyboard(const Keyboard &keyboard);
+qint64 ofTagKeyboard(const TagKeyboardPtr &keyboard);
+
+//! Resident set size of the whole process, or -1 where unknown.
+qint64 residentSetSize();
+
+}} // namespace MemoryUsage, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_MEMORYUSAGE_H
@@ -54,7 +54,7 @@ void Area::setBackground(const QByteArray &background)
     m_background = background;
 }
 
-QByteArray Area::background() const
+const QByteArray & Area::background() const
 {
     return m_background;
 }
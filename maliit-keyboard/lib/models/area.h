@@ -50,7 +50,7 @@ public:
     QSize size() const;
 
     void setBackground(const QByteArray &background);
-    QByteArray background() const;
+    const QByteArray & background() const;
 
     void setBackgroundBorders(const QMargins &borders);
     QMargins backgroundBorders() const;
@@ -40,7 +40,7 @@ Font::Font()
     , m_stretch(100)
 {}
 
-QByteArray Font::name() const
+const QByteArray & Font::name() const
 {
     return m_name;
 }
@@ -60,7 +60,7 @@ void Font::setSize(int size)
     m_size = size;
 }
 
-QByteArray Font::color() const
+const QByteArray & Font::color() const
 {
     return m_color;
 }
@@ -47,13 +47,13 @@ private:
 public:
     explicit Font();
 
-    QByteArray name() const;
+    const QByteArray & name() const;
     void setName(const QByteArray &name);
 
     int size() const;
     void setSize(int size);
 
-    QByteArray color() const;
+    const QByteArray & color() const;
     void setColor(const QByteArray &color);
 
     int stretch() const;
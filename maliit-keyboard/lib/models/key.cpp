@@ -66,7 +66,7 @@ void Key::setOrigin(const QPoint &origin)
     m_origin = origin;
 }
 
-Area Key::area() const
+const Area & Key::area() const
 {
     return m_area;
 }
@@ -81,7 +81,7 @@ void Key::setArea(const Area &area)
     m_area = area;
 }
 
-Label Key::label() const
+const Label & Key::label() const
 {
     return m_label;
 }
@@ -126,7 +126,7 @@ void Key::setMargins(const QMargins &margins)
     m_margins = margins;
 }
 
-QByteArray Key::icon() const
+const QByteArray & Key::icon() const
 {
     return m_icon;
 }
@@ -146,7 +146,7 @@ void Key::setExtendedKeysEnabled(bool enable)
     m_has_extended_keys = enable;
 }
 
-QString Key::commandSequence() const
+const QString & Key::commandSequence() const
 {
     return m_command_sequence;
 }
@@ -105,11 +105,11 @@ public:
     QPoint origin() const;
     void setOrigin(const QPoint &origin);
 
-    Area area() const;
+    const Area & area() const;
     Area & rArea();
     void setArea(const Area &area);
 
-    Label label() const;
+    const Label & label() const;
     Label & rLabel();
     void setLabel(const Label &label);
 
@@ -122,13 +122,13 @@ public:
     QMargins margins() const;
     void setMargins(const QMargins &margins);
 
-    QByteArray icon() const;
+    const QByteArray & icon() const;
     void setIcon(const QByteArray &icon);
 
     bool hasExtendedKeys() const;
     void setExtendedKeysEnabled(bool enable);
 
-    QString commandSequence() const;
+    const QString & commandSequence() const;
     void setCommandSequence(const QString &command_sequence);
 };
 
@@ -34,12 +34,62 @@
 
 namespace MaliitKeyboard {
 
+namespace {
+
+QAtomicInt g_generation;
+
+uint nextGeneration()
+{
+    return g_generation.fetchAndAddRelaxed(1) + 1;
+}
+
+} // unnamed namespace
+
+//! \class KeyArea
+//! Key areas are passed by value from KeyAreaConverter through LayoutHelper
+//! to the QML models. Copies share their keys (implicit sharing), so none of
+//! these steps copies a key.
+//!
+//! Each key area carries a generation number: copies keep the generation of
+//! their source, any mutable access assigns a new one. Equal generations
+//! mean equal content, which lets comparisons skip looking at the keys.
+//!
+//! Besides the keys, a key area provides key geometry and actions as packed
+//! columns (one entry per key, same order as keys()), which GestureDecoder
+//! scans for every gesture. These are built on first use after a change, so
+//! layouts that are never decoded do not pay for them. replaceKey() keeps
+//! them up to date, so highlighting pressed keys does not invalidate them.
+
 KeyArea::KeyArea()
     : m_keys()
     , m_origin()
     , m_area()
+    , m_margin(0)
+    , m_generation(0)
+    , m_key_rects()
+    , m_key_actions()
+    , m_columns_generation(0)
 {}
 
+void KeyArea::updateColumns() const
+{
+    if (m_columns_generation == m_generation) {
+        return;
+    }
+
+    const int count(m_keys.count());
+    m_key_rects.resize(count);
+    m_key_actions.resize(count);
+
+    for (int index = 0; index < count; ++index) {
+        const Key &key(m_keys.at(index));
+        m_key_rects[index] = key.rect();
+        m_key_actions[index] = key.action();
+    }
+
+    m_columns_generation = m_generation;
+}
+
 bool KeyArea::hasKeys() const
 {
     return (not m_keys.isEmpty());
@@ -58,41 +108,92 @@ QPoint KeyArea::origin() const
 void KeyArea::setOrigin(const QPoint &origin)
 {
     m_origin = origin;
+    m_generation = nextGeneration();
 }
 
-QVector<Key> KeyArea::keys() const
+const QVector<Key> & KeyArea::keys() const
 {
     return m_keys;
 }
 
+//! The returned reference must not be kept, changes made through it later
+//! on would not be reflected in generation().
 QVector<Key> & KeyArea::rKeys()
 {
+    m_generation = nextGeneration();
     return m_keys;
 }
 
 void KeyArea::setKeys(const QVector<Key> &keys)
 {
     m_keys = keys;
+    m_generation = nextGeneration();
 }
 
-Area KeyArea::area() const
+//! Replaces a single key. Valid columns get updated in place, instead of
+//! being rebuilt on next use as after rKeys().
+void KeyArea::replaceKey(int index,
+                         const Key &key)
+{
+    const bool columns_valid(m_columns_generation == m_generation);
+
+    m_keys.replace(index, key);
+    m_generation = nextGeneration();
+
+    if (columns_valid) {
+        m_key_rects[index] = key.rect();
+        m_key_actions[index] = key.action();
+        m_columns_generation = m_generation;
+    }
+}
+
+const Area & KeyArea::area() const
 {
     return m_area;
 }
 
+//! \sa rKeys()
 Area & KeyArea::rArea()
 {
+    m_generation = nextGeneration();
     return m_area;
 }
 
 void KeyArea::setArea(const Area &area)
 {
     m_area = area;
+    m_generation = nextGeneration();
+}
+
+//! Returns the generation of this key area's content. Default constructed
+//! key areas share generation 0.
+uint KeyArea::generation() const
+{
+    return m_generation;
+}
+
+//! Returns the rectangles of all keys, relative to the key area.
+const QVector<QRect> & KeyArea::keyRects() const
+{
+    updateColumns();
+    return m_key_rects;
+}
+
+//! Returns the actions of all keys, as Key::Action values.
+const QVector<quint8> & KeyArea::keyActions() const
+{
+    updateColumns();
+    return m_key_actions;
 }
 
 bool operator==(const KeyArea &lhs,
                 const KeyArea &rhs)
 {
+    // Same generation: one is an unmodified copy of the other.
+    if (lhs.generation() == rhs.generation()) {
+        return true;
+    }
+
     return (lhs.area() == rhs.area()
             && lhs.keys() == rhs.keys());
 }
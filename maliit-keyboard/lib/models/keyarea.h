@@ -45,6 +45,14 @@ private:
     QPoint m_origin;
     Area m_area;
     qreal m_margin;
+    uint m_generation;
+
+    // Columns of m_keys, valid while m_columns_generation matches:
+    mutable QVector<QRect> m_key_rects;
+    mutable QVector<quint8> m_key_actions;
+    mutable uint m_columns_generation;
+
+    void updateColumns() const;
 
 public:
     explicit KeyArea();
@@ -55,13 +63,20 @@ public:
     QPoint origin() const;
     void setOrigin(const QPoint &origin);
 
-    QVector<Key> keys() const;
+    const QVector<Key> & keys() const;
     QVector<Key> & rKeys();
     void setKeys(const QVector<Key> &keys);
+    void replaceKey(int index,
+                    const Key &key);
 
-    Area area() const;
+    const Area & area() const;
     Area & rArea();
     void setArea(const Area &area);
+
+    uint generation() const;
+
+    const QVector<QRect> & keyRects() const;
+    const QVector<quint8> & keyActions() const;
 };
 
 bool operator==(const KeyArea &lhs,
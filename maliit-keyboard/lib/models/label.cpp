@@ -39,7 +39,7 @@ Label::Label()
     , m_rect()
 {}
 
-QString Label::text() const
+const QString & Label::text() const
 {
     return m_text;
 }
@@ -49,7 +49,7 @@ void Label::setText(const QString &text)
     m_text = text;
 }
 
-Font Label::font() const
+const Font & Label::font() const
 {
     return m_font;
 }
@@ -47,10 +47,10 @@ private:
 public:
     explicit Label();
 
-    QString text() const;
+    const QString & text() const;
     void setText(const QString &text);
 
-    Font font() const;
+    const Font & font() const;
     void setFont(const Font &font);
 
     QRect rect() const;
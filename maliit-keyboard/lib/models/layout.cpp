@@ -36,6 +36,8 @@
 
 #include "logic/layouthelper.h"
 #include "logic/layoutupdater.h"
+#include "coreutils.h"
+#include "tracer.h"
 
 namespace MaliitKeyboard {
 namespace Model {
@@ -60,8 +62,16 @@ public:
     KeyArea key_area;
     QString image_directory;
     QHash<int, QByteArray> roles;
+    QHash<int, Key> overriden_keys; //!< Key overrides, by row.
+    int reset_count;
+    int row_insertion_count;
 
     explicit LayoutPrivate();
+
+    const Key &displayedKey(int row,
+                            const Key &key) const;
+    void updateOverride(int row,
+                        const Logic::KeyOverrides &overrides);
 };
 
 
@@ -70,6 +80,9 @@ LayoutPrivate::LayoutPrivate()
     , key_area()
     , image_directory()
     , roles()
+    , overriden_keys()
+    , reset_count(0)
+    , row_insertion_count(0)
 {
     // Model roles are used as variables in QML, hence the under_score naming
     // convention:
@@ -86,6 +99,32 @@ LayoutPrivate::LayoutPrivate()
 }
 
 
+const Key &LayoutPrivate::displayedKey(int row,
+                                       const Key &key) const
+{
+    if (overriden_keys.isEmpty()) {
+        return key;
+    }
+
+    const QHash<int, Key>::const_iterator found(overriden_keys.find(row));
+    return (found != overriden_keys.end() ? found.value() : key);
+}
+
+
+void LayoutPrivate::updateOverride(int row,
+                                   const Logic::KeyOverrides &overrides)
+{
+    const Logic::KeyOverrides::const_iterator found(
+        overrides.find(CoreUtils::idFromKey(key_area.keys().at(row))));
+
+    if (found != overrides.end()) {
+        overriden_keys.insert(row, found.value());
+    } else {
+        overriden_keys.remove(row);
+    }
+}
+
+
 Layout::Layout(QObject *parent)
     : QAbstractListModel(parent)
     , d_ptr(new LayoutPrivate)
@@ -116,6 +155,14 @@ QString Layout::title() const
 
 void Layout::setKeyArea(const KeyArea &area)
 {
+    setKeyArea(area, Logic::KeyOverrides());
+}
+
+
+void Layout::setKeyArea(const KeyArea &area,
+                        const Logic::KeyOverrides &overrides)
+{
+    MALIIT_TRACE_SCOPE("Model::Layout::setKeyArea");
     beginResetModel();
 
     Q_D(Layout);
@@ -127,6 +174,13 @@ void Layout::setKeyArea(const KeyArea &area)
     const bool origin_changed(d->key_area.origin() != area.origin());
 
     d->key_area = area;
+    d->overriden_keys.clear();
+
+    if (not overrides.isEmpty()) {
+        for (int row = 0; row < d->key_area.keys().count(); ++row) {
+            d->updateOverride(row, overrides);
+        }
+    }
 
     if (origin_changed) {
         Q_EMIT originChanged(d->key_area.origin());
@@ -150,21 +204,40 @@ void Layout::setKeyArea(const KeyArea &area)
     }
 
     endResetModel();
+    ++d->reset_count;
+    d->row_insertion_count += d->key_area.keys().count();
 }
 
 
-KeyArea Layout::keyArea() const
+const KeyArea & Layout::keyArea() const
 {
     Q_D(const Layout);
     return d->key_area;
 }
 
 
+//! Updates the given rows only, instead of resetting the whole model.
+void Layout::applyKeyOverrides(const QVector<int> &key_indices,
+                               const Logic::KeyOverrides &overrides)
+{
+    Q_D(Layout);
+
+    Q_FOREACH (int row, key_indices) {
+        if (row < 0 || row >= d->key_area.keys().count()) {
+            continue;
+        }
+
+        d->updateOverride(row, overrides);
+        Q_EMIT dataChanged(index(row, 0), index(row, 0));
+    }
+}
+
+
 void Layout::replaceKey(int index,
                         const Key &key)
 {
     Q_D(Layout);
-    d->key_area.rKeys().replace(index, key);
+    d->key_area.replaceKey(index, key);
     Q_EMIT dataChanged(this->index(index, 0), this->index(index, 0));
 }
 
@@ -223,6 +296,8 @@ void Layout::setImageDirectory(const QString &directory)
         beginResetModel();
         backgroundChanged(background());
         endResetModel();
+        ++d->reset_count;
+        d->row_insertion_count += d->key_area.keys().count();
     }
 }
 
@@ -270,7 +345,7 @@ QVariant Layout::data(const QModelIndex &index,
     }
 
     case RoleKeyText:
-        return QVariant(key.label().text());
+        return QVariant(d->displayedKey(index.row(), key).label().text());
 
     case RoleKeyFont:
         return QVariant(QString(key.label().font().name()));
@@ -287,7 +362,7 @@ QVariant Layout::data(const QModelIndex &index,
         return QVariant(key.label().font().stretch());
 
     case RoleKeyIcon:
-        return QVariant(toUrl(d->image_directory, key.icon()));
+        return QVariant(toUrl(d->image_directory, d->displayedKey(index.row(), key).icon()));
     }
 
     qWarning() << __PRETTY_FUNCTION__
@@ -313,4 +388,17 @@ QVariant Layout::data(int index,
 }
 
 
+int Layout::resetCount() const
+{
+    Q_D(const Layout);
+    return d->reset_count;
+}
+
+
+int Layout::rowInsertionCount() const
+{
+    Q_D(const Layout);
+    return d->row_insertion_count;
+}
+
 }} // namespace Model, MaliitKeyboard
@@ -33,6 +33,7 @@
 #define MALIIT_KEYBOARD_LAYOUT_H
 
 #include "models/key.h"
+#include "logic/layouthelper.h"
 #include <QtCore>
 
 namespace MaliitKeyboard {
@@ -96,7 +97,12 @@ public:
     Q_SIGNAL void titleChanged(const QString &changed);
 
     Q_SLOT void setKeyArea(const KeyArea &area);
-    KeyArea keyArea() const;
+    Q_SLOT void setKeyArea(const KeyArea &area,
+                           const Logic::KeyOverrides &overrides);
+    const KeyArea & keyArea() const;
+
+    Q_SLOT void applyKeyOverrides(const QVector<int> &key_indices,
+                                  const Logic::KeyOverrides &overrides);
 
     void replaceKey(int index,
                     const Key &key);
@@ -130,6 +136,11 @@ public:
     Q_INVOKABLE QVariant data(int index,
                               const QString &role) const;
 
+    //! Number of model resets so far.
+    int resetCount() const;
+    //! Number of rows inserted by resets, views may create a delegate for each.
+    int rowInsertionCount() const;
+
 private:
     const QScopedPointer<LayoutPrivate> d_ptr;
 };
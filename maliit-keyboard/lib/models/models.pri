@@ -11,6 +11,7 @@ HEADERS += \
     models/keydescription.h \
     models/wordcandidate.h \
     models/wordribbon.h \
+    models/ribbon.h \
     models/text.h \
     models/styleattributes.h \
 
@@ -23,6 +24,7 @@ SOURCES += \
     models/layout.cpp \
     models/wordcandidate.cpp \
     models/wordribbon.cpp \
+    models/ribbon.cpp \
     models/text.cpp \
     models/styleattributes.cpp \
 
@@ -0,0 +1,239 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "ribbon.h"
+
+namespace MaliitKeyboard {
+namespace Model {
+
+class RibbonPrivate
+{
+public:
+    WordRibbon ribbon;
+    QHash<int, QByteArray> roles;
+    int row_insertion_count;
+
+    explicit RibbonPrivate();
+};
+
+
+RibbonPrivate::RibbonPrivate()
+    : ribbon()
+    , roles()
+    , row_insertion_count(0)
+{
+    // Model roles are used as variables in QML, hence the under_score naming
+    // convention:
+    roles[Ribbon::RoleCandidateRectangle] = "candidate_rectangle";
+    roles[Ribbon::RoleCandidateText] = "candidate_text";
+    roles[Ribbon::RoleCandidateFontColor] = "candidate_font_color";
+    roles[Ribbon::RoleCandidateFontSize] = "candidate_font_size";
+    roles[Ribbon::RoleCandidateFontStretch] = "candidate_font_stretch";
+    roles[Ribbon::RoleCandidateSource] = "candidate_source";
+}
+
+
+Ribbon::Ribbon(QObject *parent)
+    : QAbstractListModel(parent)
+    , d_ptr(new RibbonPrivate)
+{}
+
+
+Ribbon::~Ribbon()
+{}
+
+
+//! Takes geometry and styling from ribbon, and syncs the candidate slots
+//! without resetting the model.
+void Ribbon::setWordRibbon(const WordRibbon &ribbon)
+{
+    Q_D(Ribbon);
+    const bool geometry_changed(d->ribbon.rect() != ribbon.rect());
+
+    d->ribbon.setOrigin(ribbon.origin());
+    d->ribbon.setArea(ribbon.area());
+
+    const QVector<WordCandidate> &candidates(ribbon.candidates());
+    setCandidateCount(candidates.count());
+
+    for (int index = 0; index < candidates.count(); ++index) {
+        setCandidate(index, candidates.at(index));
+    }
+
+    if (geometry_changed) {
+        Q_EMIT widthChanged(width());
+        Q_EMIT heightChanged(height());
+    }
+}
+
+
+WordRibbon Ribbon::wordRibbon() const
+{
+    Q_D(const Ribbon);
+    return d->ribbon;
+}
+
+
+void Ribbon::setCandidateCount(int count)
+{
+    Q_D(Ribbon);
+    QVector<WordCandidate> &candidates(d->ribbon.rCandidates());
+    const int current(candidates.count());
+    count = qMax(0, count);
+
+    if (count == current) {
+        return;
+    }
+
+    if (count > current) {
+        beginInsertRows(QModelIndex(), current, count - 1);
+        candidates.resize(count);
+        endInsertRows();
+        d->row_insertion_count += count - current;
+    } else {
+        beginRemoveRows(QModelIndex(), count, current - 1);
+        candidates.resize(count);
+        endRemoveRows();
+    }
+
+    if (current == 0 || count == 0) {
+        Q_EMIT visibleChanged(count > 0);
+    }
+}
+
+
+void Ribbon::setCandidate(int index,
+                          const WordCandidate &candidate)
+{
+    Q_D(Ribbon);
+    QVector<WordCandidate> &candidates(d->ribbon.rCandidates());
+
+    if (index < 0 || index >= candidates.count()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Invalid candidate index:" << index;
+        return;
+    }
+
+    if (candidates.at(index) != candidate) {
+        candidates[index] = candidate;
+        Q_EMIT dataChanged(this->index(index, 0), this->index(index, 0));
+    }
+}
+
+
+bool Ribbon::isVisible() const
+{
+    Q_D(const Ribbon);
+    return (not d->ribbon.candidates().isEmpty());
+}
+
+
+int Ribbon::width() const
+{
+    Q_D(const Ribbon);
+    return d->ribbon.rect().width();
+}
+
+
+int Ribbon::height() const
+{
+    Q_D(const Ribbon);
+    return d->ribbon.rect().height();
+}
+
+
+QHash<int, QByteArray> Ribbon::roleNames() const
+{
+    Q_D(const Ribbon);
+    return d->roles;
+}
+
+
+int Ribbon::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    Q_D(const Ribbon);
+    return d->ribbon.candidates().count();
+}
+
+
+QVariant Ribbon::data(const QModelIndex &index,
+                      int role) const
+{
+    Q_D(const Ribbon);
+
+    const QVector<WordCandidate> &candidates(d->ribbon.candidates());
+    const WordCandidate &candidate(index.row() < candidates.count()
+                                   ? candidates.at(index.row())
+                                   : WordCandidate());
+
+    switch(role) {
+    case RoleCandidateRectangle:
+        return QVariant(candidate.rect());
+
+    case RoleCandidateText:
+        return QVariant(candidate.label().text());
+
+    case RoleCandidateFontColor:
+        return QVariant(QString(candidate.label().font().color()));
+
+    case RoleCandidateFontSize:
+        // FIXME: Using qMax to suppress warning about "invalid" 0.0 font sizes in QFont::setPointSizeF.
+        return QVariant(qMax<int>(1, candidate.label().font().size()));
+
+    case RoleCandidateFontStretch:
+        return QVariant(candidate.label().font().stretch());
+
+    case RoleCandidateSource:
+        return QVariant(static_cast<int>(candidate.source()));
+    }
+
+    qWarning() << __PRETTY_FUNCTION__
+               << "Invalid index or role (" << index.row() << role << ").";
+
+    return QVariant();
+}
+
+
+QVariant Ribbon::data(int index,
+                      const QString &role) const
+{
+    const QModelIndex idx(this->index(index, 0));
+    return data(idx, roleNames().key(role.toLatin1()));
+}
+
+int Ribbon::rowInsertionCount() const
+{
+    Q_D(const Ribbon);
+    return d->row_insertion_count;
+}
+
+}} // namespace Model, MaliitKeyboard
@@ -0,0 +1,108 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_RIBBON_H
+#define MALIIT_KEYBOARD_RIBBON_H
+
+#include "models/wordribbon.h"
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Model {
+
+class RibbonPrivate;
+
+//! \brief List model of the word ribbon, one row per candidate slot.
+//!
+//! Slots are stable: new candidates are written into existing rows, and
+//! only rows whose candidate changed emit dataChanged. Rows are only
+//! inserted or removed if the number of candidates changes.
+class Ribbon
+    : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(Ribbon)
+    Q_DECLARE_PRIVATE(Ribbon)
+
+    Q_PROPERTY(bool visible READ isVisible
+                            NOTIFY visibleChanged)
+    Q_PROPERTY(int width READ width
+                         NOTIFY widthChanged)
+    Q_PROPERTY(int height READ height
+                          NOTIFY heightChanged)
+
+public:
+    enum Roles {
+        RoleCandidateRectangle = Qt::UserRole + 1,
+        RoleCandidateText,
+        RoleCandidateFontColor,
+        RoleCandidateFontSize,
+        RoleCandidateFontStretch,
+        RoleCandidateSource,
+    };
+
+    explicit Ribbon(QObject *parent = 0);
+    virtual ~Ribbon();
+
+    Q_SLOT void setWordRibbon(const WordRibbon &ribbon);
+    WordRibbon wordRibbon() const;
+
+    Q_SLOT void setCandidateCount(int count);
+    Q_SLOT void setCandidate(int index,
+                             const WordCandidate &candidate);
+
+    Q_SLOT bool isVisible() const;
+    Q_SIGNAL void visibleChanged(bool changed);
+
+    Q_SLOT int width() const;
+    Q_SIGNAL void widthChanged(int changed);
+
+    Q_SLOT int height() const;
+    Q_SIGNAL void heightChanged(int changed);
+
+    virtual QHash<int, QByteArray> roleNames() const;
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index,
+                          int role) const;
+
+    Q_INVOKABLE QVariant data(int index,
+                              const QString &role) const;
+
+    //! Number of rows inserted, views may create a delegate for each.
+    int rowInsertionCount() const;
+
+private:
+    const QScopedPointer<RibbonPrivate> d_ptr;
+};
+
+}} // namespace Model, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_RIBBON_H
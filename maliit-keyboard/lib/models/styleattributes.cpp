@@ -31,6 +31,7 @@
  */
 
 #include "styleattributes.h"
+#include "memoryusage.h"
 
 //! \class StyleAttributes
 //! This class allows to query style attributes, such as image names and font
@@ -204,6 +205,29 @@ StyleAttributes::StyleAttributes(const QSettings *store)
 StyleAttributes::~StyleAttributes()
 {}
 
+//! \brief Returns the estimated heap usage of the loaded style values.
+//!
+//! Walks all keys of the store, so this is not meant for hot paths.
+qint64 StyleAttributes::memoryUsage() const
+{
+    qint64 usage(sizeof(QSettings) + MemoryUsage::ofString(m_style_name));
+
+    Q_FOREACH (const QString &key, m_store->allKeys()) {
+        const QVariant value(m_store->value(key));
+        usage += MemoryUsage::ofString(key) + sizeof(QVariant);
+
+        if (value.type() == QVariant::String) {
+            usage += MemoryUsage::ofString(value.toString());
+        } else if (value.type() == QVariant::StringList) {
+            usage += MemoryUsage::ofStringList(value.toStringList());
+        } else if (value.type() == QVariant::ByteArray) {
+            usage += MemoryUsage::ofByteArray(value.toByteArray());
+        }
+    }
+
+    return usage;
+}
+
 //! \brief Sets the active style name.
 //!
 //! Consider HTML and CSS, where HTML provides the input and CSS specifies
@@ -348,6 +372,28 @@ QStringList StyleAttributes::fontFiles() const
 }
 
 
+//! \brief Returns all background and icon images referenced by this style.
+//!
+//! File names are relative to the image directory of the style profile.
+QStringList StyleAttributes::imageFiles() const
+{
+    QStringList files;
+
+    Q_FOREACH (const QString &key, m_store->allKeys()) {
+        if ((key.startsWith("background/") or key.startsWith("icon/"))
+            and not key.endsWith("-borders")) {
+            const QString file(m_store->value(key).toString());
+
+            if (not file.isEmpty() and not files.contains(file)) {
+                files.append(file);
+            }
+        }
+    }
+
+    return files;
+}
+
+
 //! \brief Looks up the font color used for key labels.
 //! @param orientation The layout orientation (landscape or portrait).
 //! @returns Value of "${style}\${orientation}\font-color".
@@ -51,6 +51,7 @@ public:
     virtual ~StyleAttributes();
 
     virtual void setStyleName(const QString &name);
+    qint64 memoryUsage() const;
     QByteArray wordRibbonBackground() const;
     QByteArray keyAreaBackground() const;
     QByteArray magnifierKeyBackground() const;
@@ -68,6 +69,7 @@ public:
     QByteArray customIcon(const QString &icon_name) const;
 
     QStringList fontFiles() const;
+    QStringList imageFiles() const;
 
     QByteArray fontName(Logic::LayoutHelper::Orientation orientation) const;
     QByteArray fontColor(Logic::LayoutHelper::Orientation orientation) const;
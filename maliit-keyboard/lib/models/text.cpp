@@ -32,19 +32,36 @@
 
 #include "text.h"
 
+#include <cstring>
+
 //! \class Text
 //! \brief Represents the text state of the editor
 //!
 //! Both MaliitKeyboard::AbstractTextEditor and
 //! MaliitKeyboard::Logic::AbstractWordEngine operate on the text model.
+//!
+//! The surrounding text is kept in a gap buffer: setSurrounding() only
+//! copies the part of the host's text that differs from the model, edits
+//! through replaceSurrounding() only move the gap to the edit position and
+//! cursor movements do not touch the text at all.
 
 namespace MaliitKeyboard {
 namespace Model {
 
+namespace {
+
+//! Minimum number of characters by which the gap grows.
+const int MinimumGapLength = 64;
+
+} // unnamed namespace
+
 //! C'tor
 Text::Text()
     : m_preedit()
     , m_surrounding()
+    , m_gap_begin(0)
+    , m_gap_length(0)
+    , m_copied_characters(0)
     , m_surrounding_offset(0)
     , m_face(PreeditDefault)
     , m_cursor_position(0)
@@ -87,12 +104,9 @@ void Text::appendToPreedit(const QString &appendix)
 //! updates surrounding offset to match expected cursor position.
 void Text::commitPreedit()
 {
-    // FIXME: Guessing the surrounding text like this might not be quite right;
-    // we would expect the text editor to just update the surrounding text.
-    // Raises the question whether we should have commitPreedit here at all,
-    // but it does preserve some consistency at least.
-    m_surrounding = m_preedit;
-    m_surrounding_offset = m_preedit.length();
+    // The application will send us the updated surrounding text later
+    // on, but until then this keeps the model consistent:
+    replaceSurrounding(m_surrounding_offset, 0, m_preedit);
     m_preedit.clear();
     m_primary_candidate.clear();
     m_face = PreeditDefault;
@@ -115,26 +129,133 @@ void Text::setPrimaryCandidate(const QString &candidate)
 //! Returns text surrounding cursor position.
 QString Text::surrounding() const
 {
-    return m_surrounding;
+    return surroundingMid(0, surroundingLength());
 }
 
 //! Returns text left of cursor position. Depends on surroundingOffset.
 QString Text::surroundingLeft() const
 {
-    return m_surrounding.left(m_surrounding_offset);
+    return surroundingMid(0, m_surrounding_offset);
 }
 
 //! Returns text right of cursor position. Depends on surroundingOffset.
 QString Text::surroundingRight() const
 {
-    return m_surrounding.mid(m_surrounding_offset);
+    const int offset(qMin<int>(m_surrounding_offset, surroundingLength()));
+    return surroundingMid(offset, surroundingLength() - offset);
 }
 
-//! Set text surrounding cursor position.
+//! Set text surrounding cursor position. Usually the host only echoes
+//! edits the model already made, so the text is compared with the model
+//! and only the differing part gets copied into the gap buffer.
+//! Surrounding offset is left alone.
 //! \param surrounding the updated surrounding text.
 void Text::setSurrounding(const QString &surrounding)
 {
-    m_surrounding = surrounding;
+    const QChar *const source(surrounding.constData());
+    const int length(surrounding.length());
+    const int old_length(surroundingLength());
+    const int common(qMin(length, old_length));
+
+    int prefix = 0;
+    while (prefix < common && surroundingAt(prefix) == source[prefix]) {
+        ++prefix;
+    }
+
+    int suffix = 0;
+    while (suffix < common - prefix
+           && surroundingAt(old_length - 1 - suffix) == source[length - 1 - suffix]) {
+        ++suffix;
+    }
+
+    if (prefix + suffix == length && length == old_length) {
+        return;
+    }
+
+    const uint offset(m_surrounding_offset);
+    const QString inserted(surrounding.mid(prefix, length - prefix - suffix));
+
+    // Inserting in two parts leaves the gap at the cursor, where the next
+    // edit most likely happens:
+    const int split(qBound(0, static_cast<int>(offset) - prefix, inserted.length()));
+    replaceSurrounding(prefix, old_length - prefix - suffix, inserted.mid(split));
+    replaceSurrounding(prefix, 0, inserted.left(split));
+    m_surrounding_offset = offset;
+}
+
+//! Returns length of surrounding text.
+int Text::surroundingLength() const
+{
+    return m_surrounding.length() - m_gap_length;
+}
+
+//! Returns character of surrounding text at given index, in constant time.
+//! \param index the index, has to be lower than surroundingLength.
+QChar Text::surroundingAt(int index) const
+{
+    return m_surrounding.at(index < m_gap_begin ? index : index + m_gap_length);
+}
+
+//! Returns part of the surrounding text. Only the requested part is
+//! copied, which allows to look at the text around the cursor without
+//! paying for the whole surrounding text.
+//! \param position start of the part, gets clipped to surrounding text.
+//! \param length length of the part, gets clipped to surrounding text.
+QString Text::surroundingMid(int position,
+                             int length) const
+{
+    const int begin(qBound(0, position, surroundingLength()));
+    const int end(qBound(begin, position + length, surroundingLength()));
+
+    if (end <= m_gap_begin) {
+        return m_surrounding.mid(begin, end - begin);
+    }
+
+    if (begin >= m_gap_begin) {
+        return m_surrounding.mid(begin + m_gap_length, end - begin);
+    }
+
+    QString result(end - begin, Qt::Uninitialized);
+    QChar *const data(result.data());
+    memcpy(data, m_surrounding.constData() + begin, (m_gap_begin - begin) * sizeof(QChar));
+    memcpy(data + m_gap_begin - begin, m_surrounding.constData() + m_gap_begin + m_gap_length,
+           (end - m_gap_begin) * sizeof(QChar));
+
+    return result;
+}
+
+//! Replaces part of the surrounding text. Costs are proportional to the
+//! size of the edit and the distance to the previous edit, not to the
+//! size of the surrounding text. Surrounding offset is moved along if
+//! it is behind the replaced part.
+//! \param position start of the replaced part.
+//! \param length length of the replaced part.
+//! \param replacement the text to put in.
+void Text::replaceSurrounding(int position,
+                              int length,
+                              const QString &replacement)
+{
+    const int begin(qBound(0, position, surroundingLength()));
+    const int end(qBound(begin, position + length, surroundingLength()));
+    const int offset(m_surrounding_offset);
+
+    moveGap(begin);
+    m_gap_length += end - begin;
+    reserveGap(replacement.length());
+
+    QChar *const data(m_surrounding.data());
+    for (int index = 0; index < replacement.length(); ++index) {
+        data[m_gap_begin + index] = replacement.at(index);
+    }
+    m_copied_characters += replacement.length();
+    m_gap_begin += replacement.length();
+    m_gap_length -= replacement.length();
+
+    if (offset >= end) {
+        m_surrounding_offset = offset - (end - begin) + replacement.length();
+    } else if (offset > begin) {
+        m_surrounding_offset = begin + replacement.length();
+    }
 }
 
 //! Returns offset of cursor position in surrounding text.
@@ -151,6 +272,52 @@ void Text::setSurroundingOffset(uint offset)
     m_surrounding_offset = offset;
 }
 
+//! Moves the gap to given position in surrounding text.
+void Text::moveGap(int position)
+{
+    if (position == m_gap_begin) {
+        return;
+    }
+
+    QChar *const data(m_surrounding.data());
+
+    if (position < m_gap_begin) {
+        const int count(m_gap_begin - position);
+        memmove(data + position + m_gap_length, data + position, count * sizeof(QChar));
+    } else {
+        const int count(position - m_gap_begin);
+        memmove(data + m_gap_begin, data + m_gap_begin + m_gap_length, count * sizeof(QChar));
+    }
+
+    m_copied_characters += qAbs(position - m_gap_begin);
+    m_gap_begin = position;
+}
+
+//! Makes sure the gap can take more than given number of characters. The
+//! gap never gets empty, so surroundingMid() never shares the buffer and
+//! the next edit does not need to detach it.
+void Text::reserveGap(int length)
+{
+    if (m_gap_length > length) {
+        return;
+    }
+
+    const int extra(qMax(qMax(length - m_gap_length + 1, MinimumGapLength),
+                         m_surrounding.length() / 2));
+    // Growing may reallocate, which copies the whole buffer:
+    m_copied_characters += m_surrounding.length();
+    m_surrounding.insert(m_gap_begin, QString(extra, QChar()));
+    m_gap_length += extra;
+}
+
+//! Returns how many characters were copied or moved inside the surrounding
+//! text buffer so far. Lets tests check that host updates and edits cost
+//! what changed, not what the document holds.
+qint64 Text::copiedCharacters() const
+{
+    return m_copied_characters;
+}
+
 //! Returns face of preedit.
 Text::PreeditFace Text::preeditFace() const
 {
@@ -51,7 +51,10 @@ public:
 
 private:
     QString m_preedit; //!< current text segment that is edited.
-    QString m_surrounding; //!< text to left and right side of cursor position, in current text block.
+    QString m_surrounding; //!< text to left and right side of cursor position, in current text block, with a gap.
+    int m_gap_begin; //!< start of the unused gap in m_surrounding.
+    int m_gap_length; //!< length of the unused gap in m_surrounding.
+    qint64 m_copied_characters; //!< characters copied or moved in m_surrounding so far.
     QString m_primary_candidate; //!< the primary candidate from the word engine.
     uint m_surrounding_offset; //!< offset of cursor position in surrounding text.
     PreeditFace m_face; //!< face of preedit.
@@ -73,15 +76,27 @@ public:
     QString surroundingLeft() const;
     QString surroundingRight() const;
     void setSurrounding(const QString &surrounding);
+    int surroundingLength() const;
+    QChar surroundingAt(int index) const;
+    QString surroundingMid(int position,
+                           int length) const;
+    void replaceSurrounding(int position,
+                            int length,
+                            const QString &replacement);
 
     uint surroundingOffset() const;
     void setSurroundingOffset(uint offset);
+    qint64 copiedCharacters() const;
 
     PreeditFace preeditFace() const;
     void setPreeditFace(PreeditFace face);
 
     int cursorPosition() const;
     void setCursorPosition(int cursor_position);
+
+private:
+    void moveGap(int position);
+    void reserveGap(int length);
 };
 
 }} // namespace Model, MaliitKeyboard
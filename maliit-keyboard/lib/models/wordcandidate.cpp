@@ -77,7 +77,7 @@ void WordCandidate::setOrigin(const QPoint &origin)
     m_origin = origin;
 }
 
-Area WordCandidate::area() const
+const Area & WordCandidate::area() const
 {
     return m_area;
 }
@@ -92,7 +92,7 @@ void WordCandidate::setArea(const Area &area)
     m_area = area;
 }
 
-Label WordCandidate::label() const
+const Label & WordCandidate::label() const
 {
     return m_label;
 }
@@ -117,7 +117,7 @@ void WordCandidate::setSource(Source source)
     m_source = source;
 }
 
-QString WordCandidate::word() const
+const QString & WordCandidate::word() const
 {
     return m_word;
 }
@@ -47,7 +47,8 @@ public:
         SourceUnknown,
         SourceSpellChecking,
         SourcePrediction,
-        SourceUser // Candidate based on current preedit word for adding to the user dictionary
+        SourceUser, // Candidate based on current preedit word for adding to the user dictionary
+        SourceUserDictionary // Candidate from words the user added to the user dictionary
     };
 
 private:
@@ -68,18 +69,18 @@ public:
     QPoint origin() const;
     void setOrigin(const QPoint &origin);
 
-    Area area() const;
+    const Area & area() const;
     Area & rArea();
     void setArea(const Area &area);
 
-    Label label() const;
+    const Label & label() const;
     Label & rLabel();
     void setLabel(const Label &label);
 
     Source source() const;
     void setSource(Source source);
 
-    QString word() const;
+    const QString & word() const;
     void setWord(const QString &word);
 };
 
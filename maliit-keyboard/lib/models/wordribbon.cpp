@@ -65,7 +65,7 @@ void WordRibbon::appendCandidate(const WordCandidate &candidate)
     m_candidates.append(candidate);
 }
 
-QVector<WordCandidate> WordRibbon::candidates() const
+const QVector<WordCandidate> & WordRibbon::candidates() const
 {
     return m_candidates;
 }
@@ -57,7 +57,7 @@ public:
     QPoint origin() const;
     void setOrigin(const QPoint &origin);
 
-    QVector<WordCandidate> candidates() const;
+    const QVector<WordCandidate> & candidates() const;
     QVector<WordCandidate> & rCandidates();
     void appendCandidate(const WordCandidate &candidate);
     void clearCandidates();
@@ -0,0 +1,342 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "tracer.h"
+
+namespace MaliitKeyboard {
+namespace Tracer {
+
+namespace {
+
+// Events per thread. Older events get overwritten, which keeps memory
+// bounded during long sessions (about 200KB per thread).
+const int BufferCapacity = 8192;
+
+// Buffers of exited threads kept for dumps and for reuse by new threads.
+// Thread pools keep replacing expired threads, so without a limit every
+// one of them would leave a buffer behind.
+const int MaxIdleBuffers = 4;
+
+struct Event
+{
+    const char *name;
+    qint64 begin;
+    qint64 duration; //!< Negative for instant events.
+};
+
+//! Written by its own thread only. Readers might see a torn event if
+//! they read while the buffer wraps or gets reused, which is acceptable
+//! for dumps. Thread id and name only change under the registry lock.
+struct Buffer
+{
+    explicit Buffer(int new_tid,
+                    const QString &new_thread_name)
+        : tid(new_tid)
+        , thread_name(new_thread_name)
+        , next(0)
+        , wrapped(0)
+    {}
+
+    int tid;
+    QString thread_name;
+    QAtomicInt next;
+    QAtomicInt wrapped;
+    Event events[BufferCapacity];
+};
+
+typedef QSharedPointer<Buffer> SharedBuffer;
+
+class Registry
+{
+public:
+    QMutex mutex;
+    QList<SharedBuffer> buffers; //!< All buffers, including idle ones.
+    QList<SharedBuffer> idle_buffers; //!< Buffers of exited threads, oldest first.
+    int last_tid;
+    QElapsedTimer clock;
+    QAtomicInt enabled;
+
+    explicit Registry()
+        : mutex()
+        , buffers()
+        , idle_buffers()
+        , last_tid(0)
+        , clock()
+        , enabled(0)
+    {
+        clock.start();
+    }
+};
+
+//! Owned by the thread storage, hands the buffer back to the registry
+//! when its thread finishes.
+class BufferHandle
+{
+public:
+    explicit BufferHandle(const SharedBuffer &new_buffer)
+        : buffer(new_buffer)
+    {}
+
+    ~BufferHandle();
+
+    const SharedBuffer buffer;
+};
+
+typedef QThreadStorage<BufferHandle *> BufferStorage;
+
+Q_GLOBAL_STATIC(Registry, registry)
+Q_GLOBAL_STATIC(BufferStorage, thread_buffer)
+
+//! Keeps the events of the exited thread around for dumps, until a new
+//! thread takes over the buffer or it is one idle buffer too many.
+BufferHandle::~BufferHandle()
+{
+    Registry *r(registry());
+
+    // Registry is gone already if the main thread exits last:
+    if (not r) {
+        return;
+    }
+
+    QMutexLocker locker(&r->mutex);
+    r->idle_buffers.append(buffer);
+
+    while (r->idle_buffers.count() > MaxIdleBuffers) {
+        r->buffers.removeOne(r->idle_buffers.takeFirst());
+    }
+}
+
+//! Only takes the registry lock on the first event of a thread.
+Buffer *currentBuffer()
+{
+    BufferStorage *storage(thread_buffer());
+
+    if (not storage->hasLocalData()) {
+        Registry *r(registry());
+        QMutexLocker locker(&r->mutex);
+
+        QThread *const thread(QThread::currentThread());
+        const int tid(++r->last_tid);
+        QString name(thread->objectName());
+
+        if (name.isEmpty()) {
+            name = (QCoreApplication::instance()
+                    && QCoreApplication::instance()->thread() == thread)
+                   ? QString("main") : QString("thread %1").arg(tid);
+        }
+
+        SharedBuffer buffer;
+
+        if (r->idle_buffers.isEmpty()) {
+            buffer = SharedBuffer(new Buffer(tid, name));
+            r->buffers.append(buffer);
+        } else {
+            // Events of the exited thread get dropped here:
+            buffer = r->idle_buffers.takeFirst();
+            buffer->tid = tid;
+            buffer->thread_name = name;
+            buffer->wrapped.store(0);
+            buffer->next.store(0);
+        }
+
+        storage->setLocalData(new BufferHandle(buffer));
+    }
+
+    return storage->localData()->buffer.data();
+}
+
+void record(const char *name,
+            qint64 begin,
+            qint64 duration)
+{
+    Buffer *const buffer(currentBuffer());
+    const int index(buffer->next.load());
+
+    Event &event(buffer->events[index]);
+    event.name = name;
+    event.begin = begin;
+    event.duration = duration;
+
+    if (index + 1 == BufferCapacity) {
+        buffer->wrapped.storeRelease(1);
+        buffer->next.storeRelease(0);
+    } else {
+        buffer->next.storeRelease(index + 1);
+    }
+}
+
+QByteArray escaped(const char *name)
+{
+    QByteArray result(name);
+    result.replace('\\', "\\\\");
+    result.replace('"', "\\\"");
+
+    return result;
+}
+
+QByteArray microseconds(qint64 nanoseconds)
+{
+    return QByteArray::number(nanoseconds / 1000.0, 'f', 3);
+}
+
+} // unnamed namespace
+
+bool isEnabled()
+{
+    return registry()->enabled.load();
+}
+
+void setEnabled(bool enabled)
+{
+    registry()->enabled.store(enabled ? 1 : 0);
+}
+
+//! Drops all events. Should be called while no tracepoints are hit.
+void clear()
+{
+    Registry *r(registry());
+    QMutexLocker locker(&r->mutex);
+
+    Q_FOREACH (const SharedBuffer &buffer, r->buffers) {
+        buffer->wrapped.store(0);
+        buffer->next.store(0);
+    }
+}
+
+qint64 now()
+{
+    return registry()->clock.nsecsElapsed();
+}
+
+void recordComplete(const char *name,
+                    qint64 begin,
+                    qint64 end)
+{
+    if (isEnabled()) {
+        record(name, begin, end - begin);
+    }
+}
+
+void recordInstant(const char *name)
+{
+    if (isEnabled()) {
+        record(name, now(), -1);
+    }
+}
+
+int bufferCount()
+{
+    Registry *r(registry());
+    QMutexLocker locker(&r->mutex);
+
+    return r->buffers.count();
+}
+
+int eventCount()
+{
+    Registry *r(registry());
+    QMutexLocker locker(&r->mutex);
+    int count = 0;
+
+    Q_FOREACH (const SharedBuffer &buffer, r->buffers) {
+        count += (buffer->wrapped.loadAcquire() ? BufferCapacity
+                                                : buffer->next.loadAcquire());
+    }
+
+    return count;
+}
+
+bool writeChromeTrace(const QString &file_name)
+{
+    QFile file(file_name);
+
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Could not open trace file:" << file_name;
+        return false;
+    }
+
+    Registry *r(registry());
+    QList<SharedBuffer> buffers;
+    QList<QPair<int, QString> > threads;
+    {
+        QMutexLocker locker(&r->mutex);
+        buffers = r->buffers;
+
+        Q_FOREACH (const SharedBuffer &buffer, buffers) {
+            threads.append(qMakePair(buffer->tid, buffer->thread_name));
+        }
+    }
+
+    const QByteArray pid(QByteArray::number(QCoreApplication::applicationPid()));
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+
+    for (int index = 0; index < buffers.count(); ++index) {
+        const SharedBuffer &buffer(buffers.at(index));
+        const QByteArray tid(QByteArray::number(threads.at(index).first));
+
+        json += (first ? "" : ",");
+        json += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid
+                + ",\"args\":{\"name\":\"" + escaped(threads.at(index).second.toUtf8().constData()) + "\"}}";
+        first = false;
+
+        const int next(buffer->next.loadAcquire());
+        const bool wrapped(buffer->wrapped.loadAcquire());
+        const int count(wrapped ? BufferCapacity : next);
+
+        for (int offset = 0; offset < count; ++offset) {
+            // Oldest event first:
+            const Event &event(buffer->events[wrapped ? (next + offset) % BufferCapacity : offset]);
+
+            json += ",\n{\"name\":\"" + escaped(event.name) + "\",\"cat\":\"maliit\",\"pid\":" + pid
+                    + ",\"tid\":" + tid + ",\"ts\":" + microseconds(event.begin);
+
+            if (event.duration < 0) {
+                json += ",\"ph\":\"i\",\"s\":\"t\"}";
+            } else {
+                json += ",\"ph\":\"X\",\"dur\":" + microseconds(event.duration) + "}";
+            }
+        }
+    }
+
+    json += "\n]}\n";
+
+    if (file.write(json) != json.size()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Could not write trace file:" << file_name;
+        return false;
+    }
+
+    return true;
+}
+
+}} // namespace Tracer, MaliitKeyboard
@@ -0,0 +1,108 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_TRACER_H
+#define MALIIT_KEYBOARD_TRACER_H
+
+#include <QtCore>
+
+//! \file tracer.h
+//! Tracepoints for following a keystroke through the keyboard.
+//!
+//! Tracepoints only exist in builds configured with CONFIG+=enable-tracing,
+//! otherwise MALIIT_TRACE_SCOPE and MALIIT_TRACE_INSTANT expand to nothing.
+//! Even then, nothing gets recorded until Tracer::setEnabled() was called.
+//! Each thread records into its own fixed-size ring buffer, without locks
+//! or allocations. Buffers of exited threads get reused by new threads.
+//! Names have to be string literals, as only the pointer is stored.
+
+#define MALIIT_TRACE_CONCAT_IMPL(a, b) a##b
+#define MALIIT_TRACE_CONCAT(a, b) MALIIT_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef MALIIT_KEYBOARD_TRACING
+#define MALIIT_TRACE_SCOPE(name) \
+    const MaliitKeyboard::Tracer::Scope MALIIT_TRACE_CONCAT(maliit_trace_scope_, __LINE__)(name)
+#define MALIIT_TRACE_INSTANT(name) \
+    MaliitKeyboard::Tracer::recordInstant(name)
+#else
+#define MALIIT_TRACE_SCOPE(name) do {} while (false)
+#define MALIIT_TRACE_INSTANT(name) do {} while (false)
+#endif
+
+namespace MaliitKeyboard {
+namespace Tracer {
+
+bool isEnabled();
+void setEnabled(bool enabled);
+void clear();
+
+//! Nanoseconds since the tracer was first used.
+qint64 now();
+void recordComplete(const char *name,
+                    qint64 begin,
+                    qint64 end);
+void recordInstant(const char *name);
+
+//! Number of thread buffers, including the ones of exited threads.
+int bufferCount();
+//! Number of events currently held by all thread buffers.
+int eventCount();
+
+//! Writes all buffered events in Chrome's trace event format, which can
+//! be loaded into chrome://tracing.
+bool writeChromeTrace(const QString &file_name);
+
+//! Records a complete event for the lifetime of the instance.
+class Scope
+{
+    Q_DISABLE_COPY(Scope)
+
+public:
+    explicit Scope(const char *name)
+        : m_name(isEnabled() ? name : 0)
+        , m_begin(m_name ? now() : 0)
+    {}
+
+    ~Scope()
+    {
+        if (m_name) {
+            recordComplete(m_name, m_begin, now());
+        }
+    }
+
+private:
+    const char *const m_name;
+    const qint64 m_begin;
+};
+
+}} // namespace Tracer, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_TRACER_H
@@ -32,6 +32,7 @@
 
 #include "models/text.h"
 #include "editor.h"
+#include "tracer.h"
 
 #include <QtGui/QKeyEvent>
 #include <QTimer>
@@ -52,74 +53,238 @@ QEvent::Type toQEventType(Logic::AbstractTextEditor::KeyState state)
 
 }
 
+//! \class Editor
+//! \brief Text editor talking to the Maliit host.
+//!
+//! With coalescing enabled, host calls are queued and sent at the end of
+//! the current event loop iteration. Consecutive preedit updates collapse
+//! into the last one, consecutive commits into a single commit, and a
+//! commit replaces a preedit update right before it (committing clears
+//! the preedit anyway). Key events and actions keep their order.
+
 Editor::Editor(Model::Text *text,
                Logic::AbstractWordEngine *word_engine,
                Logic::AbstractLanguageFeatures *language_features,
                QObject *parent)
     : AbstractTextEditor(text, word_engine, language_features, parent)
     , m_host(0)
-{}
+    , m_coalescing_enabled(false)
+    , m_pending_updates()
+    , m_flush_timer()
+    , m_saved_host_calls(0)
+    , m_host_calls(0)
+{
+    m_flush_timer.setSingleShot(true);
+    m_flush_timer.setInterval(0);
+    connect(&m_flush_timer, SIGNAL(timeout()),
+            this,           SLOT(flushHostUpdates()));
+}
 
 Editor::~Editor()
-{}
+{
+    // Queued updates would get lost otherwise:
+    flushHostUpdates();
+}
 
 void Editor::setHost(MAbstractInputMethodHost *host)
 {
+    if (m_host != host) {
+        flushHostUpdates();
+    }
+
     m_host = host;
 }
 
-void Editor::sendPreeditString(const QString &preedit,
-                               Model::Text::PreeditFace face,
-                               const Replacement &replacement)
+//! Returns whether host calls are queued and merged.
+bool Editor::isCoalescingEnabled() const
 {
-    if (not m_host) {
-        qWarning() << __PRETTY_FUNCTION__
-                   << "Host not set, ignoring.";
+    return m_coalescing_enabled;
+}
+
+//! Sets whether host calls are queued and merged. Disabling sends queued
+//! updates right away.
+//! \param enabled whether to enable coalescing.
+void Editor::setCoalescingEnabled(bool enabled)
+{
+    if (m_coalescing_enabled != enabled) {
+        m_coalescing_enabled = enabled;
+
+        if (not enabled) {
+            flushHostUpdates();
+        }
     }
+}
 
-    QList<Maliit::PreeditTextFormat> format_list;
-    const int start (0);
-    const int length (preedit.length());
+//! Returns number of host calls saved by coalescing.
+int Editor::savedHostCalls() const
+{
+    return m_saved_host_calls;
+}
 
-    format_list.append(Maliit::PreeditTextFormat(start,
-                                                 length,
-                                                 static_cast< ::Maliit::PreeditFace>(face)));
+//! Returns number of calls made to the host.
+int Editor::hostCalls() const
+{
+    return m_host_calls;
+}
+
+//! Sends all queued updates to the host.
+void Editor::flushHostUpdates()
+{
+    m_flush_timer.stop();
 
-    m_host->sendPreeditString(preedit, format_list, replacement.start,
-                              replacement.length, replacement.cursor_position);
+    // Sending might re-enter the editor, so work on a copy:
+    const QList<HostUpdate> updates(m_pending_updates);
+    m_pending_updates.clear();
+
+    Q_FOREACH (const HostUpdate &update, updates) {
+        sendHostUpdate(update);
+    }
 }
 
-void Editor::sendCommitString(const QString &commit)
+void Editor::queueHostUpdate(const HostUpdate &update)
+{
+    if (not m_coalescing_enabled) {
+        sendHostUpdate(update);
+        return;
+    }
+
+    HostUpdate merged(update);
+
+    while (not m_pending_updates.isEmpty()) {
+        const HostUpdate &last(m_pending_updates.last());
+
+        if (merged.type == HostUpdate::PreeditUpdate
+            and last.type == HostUpdate::PreeditUpdate) {
+            // Only the latest preedit is visible in the end, but a
+            // replacement of surrounding text still has to happen:
+            if (last.replacement.length > 0 or last.replacement.start != 0) {
+                break;
+            }
+        } else if (merged.type == HostUpdate::CommitUpdate
+                   and last.type == HostUpdate::CommitUpdate
+                   and merged.isPlainCommit() and last.isPlainCommit()) {
+            merged.text.prepend(last.text);
+        } else if (merged.type == HostUpdate::CommitUpdate
+                   and last.type == HostUpdate::PreeditUpdate) {
+            // Committing clears the preedit, so it never needs to be shown:
+            if (last.replacement.length > 0 or last.replacement.start != 0) {
+                break;
+            }
+        } else {
+            break;
+        }
+
+        m_pending_updates.removeLast();
+        ++m_saved_host_calls;
+    }
+
+    m_pending_updates.append(merged);
+
+    if (not m_flush_timer.isActive()) {
+        m_flush_timer.start();
+    }
+}
+
+void Editor::sendHostUpdate(const HostUpdate &update)
 {
+    MALIIT_TRACE_SCOPE("Editor::sendHostUpdate");
+
     if (not m_host) {
         qWarning() << __PRETTY_FUNCTION__
                    << "Host not set, ignoring.";
+        return;
     }
 
-    m_host->sendCommitString(commit);
+    ++m_host_calls;
+
+    switch (update.type) {
+    case HostUpdate::PreeditUpdate: {
+        QList<Maliit::PreeditTextFormat> format_list;
+        const int start (0);
+        const int length (update.text.length());
+
+        format_list.append(Maliit::PreeditTextFormat(start,
+                                                     length,
+                                                     static_cast< ::Maliit::PreeditFace>(update.face)));
+
+        m_host->sendPreeditString(update.text, format_list, update.replacement.start,
+                                  update.replacement.length, update.replacement.cursor_position);
+    } break;
+
+    case HostUpdate::CommitUpdate:
+        m_host->sendCommitString(update.text, update.replacement.start,
+                                 update.replacement.length, update.replacement.cursor_position);
+        break;
+
+    case HostUpdate::KeyUpdate:
+        m_host->sendKeyEvent(QKeyEvent(toQEventType(update.state), update.key, update.modifier));
+        break;
+
+    case HostUpdate::ActionUpdate:
+        m_host->invokeAction(update.text, QKeySequence::fromString(update.key_sequence));
+        break;
+    }
+}
+
+void Editor::sendPreeditString(const QString &preedit,
+                               Model::Text::PreeditFace face,
+                               const Replacement &replacement)
+{
+    MALIIT_TRACE_SCOPE("Editor::sendPreeditString");
+
+    HostUpdate update(HostUpdate::PreeditUpdate, preedit);
+    update.face = face;
+    update.replacement = replacement;
+
+    queueHostUpdate(update);
+}
+
+void Editor::sendCommitString(const QString &commit)
+{
+    MALIIT_TRACE_SCOPE("Editor::sendCommitString");
+    queueHostUpdate(HostUpdate(HostUpdate::CommitUpdate, commit));
 }
 
 void Editor::sendKeyEvent(KeyState state,
                           Qt::Key key,
                           Qt::KeyboardModifier modifier)
 {
-    if (not m_host) {
-        qWarning() << __PRETTY_FUNCTION__
-                     << "Host not set, ignoring.";
-    }
+    MALIIT_TRACE_SCOPE("Editor::sendKeyEvent");
+
+    HostUpdate update(HostUpdate::KeyUpdate);
+    update.state = state;
+    update.key = key;
+    update.modifier = modifier;
 
-    m_host->sendKeyEvent(QKeyEvent(toQEventType(state), key, modifier));
+    queueHostUpdate(update);
 }
 
 void Editor::invokeAction(const QString &action,
                           const QString &key_sequence)
 {
-    if (not m_host) {
-        qWarning() << __PRETTY_FUNCTION__
-                     << "Host not set, ignoring.";
-    }
+    HostUpdate update(HostUpdate::ActionUpdate, action);
+    update.key_sequence = key_sequence;
+
+    queueHostUpdate(update);
+}
+
+void Editor::deleteSurroundingText(int length)
+{
+    // An empty commit replacing the text left of the cursor:
+    HostUpdate update(HostUpdate::CommitUpdate);
+    update.replacement = Replacement(-length, length, -1);
+
+    queueHostUpdate(update);
+}
+
+void Editor::moveCursor(int steps)
+{
+    // An empty commit at an offset of steps from the cursor, with the
+    // cursor placed at the start of that commit:
+    HostUpdate update(HostUpdate::CommitUpdate);
+    update.replacement = Replacement(steps, 0, 0);
 
-    m_host->invokeAction(action, QKeySequence::fromString(key_sequence));
+    queueHostUpdate(update);
 }
 
 } // namespace MaliitKeyboard
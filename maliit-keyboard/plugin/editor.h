@@ -49,7 +49,53 @@ class Editor
     Q_DISABLE_COPY(Editor)
 
 private:
+    //! A host call that has not been made yet.
+    struct HostUpdate
+    {
+        enum Type {
+            PreeditUpdate,
+            CommitUpdate,
+            KeyUpdate,
+            ActionUpdate
+        };
+
+        explicit HostUpdate(Type new_type,
+                            const QString &new_text = QString())
+            : type(new_type)
+            , text(new_text)
+            , key_sequence()
+            , face(Model::Text::PreeditDefault)
+            , replacement()
+            , state(KeyStatePressed)
+            , key(Qt::Key_unknown)
+            , modifier(Qt::NoModifier)
+        {}
+
+        //! Whether this is a commit that neither replaces text nor moves the cursor.
+        bool isPlainCommit() const
+        {
+            return (type == CommitUpdate
+                    and replacement.start == 0
+                    and replacement.length == 0
+                    and replacement.cursor_position < 0);
+        }
+
+        Type type;
+        QString text; //!< Preedit, commit string or action.
+        QString key_sequence;
+        Model::Text::PreeditFace face;
+        Replacement replacement;
+        KeyState state;
+        Qt::Key key;
+        Qt::KeyboardModifier modifier;
+    };
+
     MAbstractInputMethodHost *m_host;
+    bool m_coalescing_enabled;
+    QList<HostUpdate> m_pending_updates;
+    QTimer m_flush_timer;
+    int m_saved_host_calls;
+    int m_host_calls;
 
 public:
     explicit Editor(Model::Text *text,
@@ -60,7 +106,16 @@ public:
 
     void setHost(MAbstractInputMethodHost *host);
 
+    bool isCoalescingEnabled() const;
+    void setCoalescingEnabled(bool enabled);
+    int savedHostCalls() const;
+    int hostCalls() const;
+    Q_SLOT void flushHostUpdates();
+
 private:
+    void queueHostUpdate(const HostUpdate &update);
+    void sendHostUpdate(const HostUpdate &update);
+
     //! \reimp
     virtual void sendPreeditString(const QString &preedit,
                                    Model::Text::PreeditFace face,
@@ -71,6 +126,8 @@ private:
                               Qt::KeyboardModifier modifier);
     virtual void invokeAction(const QString &action,
                               const QString &key_sequence);
+    virtual void deleteSurroundingText(int length);
+    virtual void moveCursor(int steps);
     //! \reimp_end
 };
 
@@ -34,11 +34,13 @@
 #include "editor.h"
 #include "updatenotifier.h"
 #include "maliitcontext.h"
+#include "styleimageprovider.h"
 
 #include "models/key.h"
 #include "models/keyarea.h"
 #include "models/wordribbon.h"
 #include "models/layout.h"
+#include "models/ribbon.h"
 
 #include "logic/layouthelper.h"
 #include "logic/layoutupdater.h"
@@ -46,8 +48,19 @@
 #include "logic/style.h"
 #include "logic/languagefeatures.h"
 #include "logic/eventhandler.h"
+#include "logic/sessionrecorder.h"
 
-#ifdef HAVE_QT_MOBILITY
+#include "view/imagecache.h"
+
+#include "coreutils.h"
+#include "memoryusage.h"
+#include "tracer.h"
+
+#if defined(HAVE_PCM_FEEDBACK)
+#include "view/pcmfeedback.h"
+#include "view/deviceaudiosink.h"
+typedef MaliitKeyboard::PcmFeedback DefaultFeedback;
+#elif defined(HAVE_QT_MOBILITY)
 #include "view/soundfeedback.h"
 typedef MaliitKeyboard::SoundFeedback DefaultFeedback;
 #else
@@ -125,6 +138,19 @@ Key overrideToKey(const SharedOverride &override)
     return key;
 }
 
+int qmlObjectCount(const QQuickView *view)
+{
+    const QObject *const root(view ? view->rootObject() : 0);
+    return (root ? root->findChildren<QObject *>().count() + 1 : 0);
+}
+
+qreal hitRate(int hits,
+              int misses)
+{
+    const int lookups(hits + misses);
+    return (lookups > 0 ? qreal(hits) / lookups : 0.0);
+}
+
 } // unnamed namespace
 
 class Settings
@@ -137,6 +163,11 @@ public:
     ScopedSetting word_engine;
     ScopedSetting hide_word_ribbon_in_portrait_mode;
     ScopedSetting auto_repeat_behaviour;
+    ScopedSetting gesture_typing;
+    ScopedSetting next_word_prediction;
+    ScopedSetting tracing;
+    ScopedSetting performance_counters;
+    ScopedSetting memory_report;
 };
 
 class LayoutGroup
@@ -161,6 +192,7 @@ LayoutGroup::LayoutGroup()
 class InputMethodPrivate
 {
 public:
+    ImageCache image_cache;
     QScopedPointer<QQuickView> surface;
     QScopedPointer<QQuickView> extended_surface;
     QScopedPointer<QQuickView> magnifier_surface;
@@ -173,7 +205,10 @@ public:
     LayoutGroup layout;
     LayoutGroup extended_layout;
     Model::Layout magnifier_layout;
+    Model::Ribbon word_ribbon;
     MaliitContext context;
+    Logic::SessionRecorder recorder;
+    QTimer performance_counters_timer;
 
     explicit InputMethodPrivate(InputMethod * const q,
                                 MAbstractInputMethodHost *host);
@@ -187,11 +222,16 @@ public:
 
 InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
                                        MAbstractInputMethodHost *host)
-    : surface(getSurface(host))
+    : image_cache()
+    , surface(getSurface(host))
     , extended_surface(getOverlaySurface(host, surface.data()))
     , magnifier_surface(getOverlaySurface(host, surface.data()))
     , editor(new Model::Text, new Logic::WordEngine, new Logic::LanguageFeatures)
+#if defined(HAVE_PCM_FEEDBACK)
+    , feedback(new DeviceAudioSink)
+#else
     , feedback()
+#endif
     , style(new Style)
     , notifier()
     , key_overrides()
@@ -199,14 +239,22 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
     , layout()
     , extended_layout()
     , magnifier_layout()
+    , word_ribbon()
     , context(q, style)
+    , recorder()
+    , performance_counters_timer()
 {
     editor.setHost(host);
+    editor.setCoalescingEnabled(true);
+    editor.setAutoRepeatAccelerated(true);
 
 #ifndef DISABLE_PREEDIT
     editor.setPreeditEnabled(true);
 #endif
 
+    // Both layout groups read from the same parsed layouts:
+    extended_layout.updater.setKeyboardRepository(layout.updater.keyboardRepository());
+
     layout.updater.setLayout(&layout.helper);
     extended_layout.updater.setLayout(&extended_layout.helper);
 
@@ -214,6 +262,10 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
     extended_layout.updater.setStyle(style);
     feedback.setStyle(style);
 
+    // Decode style images on a worker thread before announcing a profile
+    // change, see InputMethod::onStyleProfileChanged:
+    style->setImagePreloadingEnabled(true);
+
     const QSize &screen_size(QGuiApplication::primaryScreen()->availableSize());
     layout.helper.setScreenSize(screen_size);
     layout.helper.setAlignment(Logic::LayoutHelper::Bottom);
@@ -228,18 +280,21 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
     // TODO: Figure out whether two views can share one engine.
     QQmlEngine *const engine(surface->engine());
     engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
+    engine->addImageProvider(g_style_image_provider_id, new StyleImageProvider(&image_cache));
     setContextProperties(engine->rootContext());
 
     surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_qml));
 
     QQmlEngine *const extended_engine(extended_surface->engine());
     extended_engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
+    extended_engine->addImageProvider(g_style_image_provider_id, new StyleImageProvider(&image_cache));
     setContextProperties(extended_engine->rootContext());
 
     extended_surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_extended_qml));
 
     QQmlEngine *const magnifier_engine(magnifier_surface->engine());
     magnifier_engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
+    magnifier_engine->addImageProvider(g_style_image_provider_id, new StyleImageProvider(&image_cache));
     setContextProperties(magnifier_engine->rootContext());
 
     magnifier_surface->setSource(QUrl::fromLocalFile(g_maliit_magnifier_qml));
@@ -248,6 +303,7 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
 
 void InputMethodPrivate::setLayoutOrientation(Logic::LayoutHelper::Orientation orientation)
 {
+    recorder.recordOrientationChanged(orientation);
     syncWordEngine(orientation);
     layout.updater.setOrientation(orientation);
     extended_layout.updater.setOrientation(orientation);
@@ -287,6 +343,7 @@ void InputMethodPrivate::setContextProperties(QQmlContext *qml_context)
     qml_context->setContextProperty("maliit_extended_layout", &extended_layout.model);
     qml_context->setContextProperty("maliit_extended_event_handler", &extended_layout.event_handler);
     qml_context->setContextProperty("maliit_magnifier_layout", &magnifier_layout);
+    qml_context->setContextProperty("maliit_word_ribbon", &word_ribbon);
 }
 
 InputMethod::InputMethod(MAbstractInputMethodHost *host)
@@ -303,7 +360,10 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     Logic::connectLayoutUpdaterToTextEditor(&d->extended_layout.updater, &d->editor);
 
     connect(&d->layout.helper, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)),
-            &d->layout.model, SLOT(setKeyArea(KeyArea)));
+            &d->layout.model, SLOT(setKeyArea(KeyArea,Logic::KeyOverrides)));
+
+    connect(&d->layout.helper, SIGNAL(centerKeysOverriden(QVector<int>,Logic::KeyOverrides)),
+            &d->layout.model, SLOT(applyKeyOverrides(QVector<int>,Logic::KeyOverrides)));
 
     connect(&d->extended_layout.helper, SIGNAL(extendedPanelChanged(KeyArea,Logic::KeyOverrides)),
             &d->extended_layout.model, SLOT(setKeyArea(KeyArea)));
@@ -311,6 +371,15 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     connect(&d->layout.helper,    SIGNAL(magnifierChanged(KeyArea)),
             &d->magnifier_layout, SLOT(setKeyArea(KeyArea)));
 
+    connect(&d->layout.helper, SIGNAL(wordRibbonChanged(WordRibbon)),
+            &d->word_ribbon,   SLOT(setWordRibbon(WordRibbon)));
+
+    connect(&d->layout.helper, SIGNAL(wordCandidateCountChanged(int)),
+            &d->word_ribbon,   SLOT(setCandidateCount(int)));
+
+    connect(&d->layout.helper, SIGNAL(wordCandidateChanged(int,WordCandidate)),
+            &d->word_ribbon,   SLOT(setCandidate(int,WordCandidate)));
+
     connect(&d->layout.model, SIGNAL(widthChanged(int)),
             this,             SLOT(onLayoutWidthChanged(int)));
 
@@ -320,6 +389,9 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     connect(&d->layout.updater, SIGNAL(keyboardTitleChanged(QString)),
             &d->layout.model,   SLOT(setTitle(QString)));
 
+    connect(&d->layout.updater,      SIGNAL(keyboardLanguageChanged(QString)),
+            d->editor.wordEngine(), SLOT(setLanguage(QString)));
+
     connect(&d->extended_layout.model, SIGNAL(widthChanged(int)),
             this,                      SLOT(onExtendedLayoutWidthChanged(int)));
 
@@ -347,6 +419,15 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     connect(QGuiApplication::primaryScreen(), SIGNAL(geometryChanged(QRect)),
             this,               SLOT(onScreenSizeChange(QRect)));
 
+    connect(d->style.data(), SIGNAL(imagePreloadRequested(QString,QStringList)),
+            &d->image_cache, SLOT(preload(QString,QStringList)));
+
+    connect(&d->image_cache, SIGNAL(preloaded(QString)),
+            d->style.data(), SLOT(onImagesPreloaded(QString)));
+
+    connect(d->style.data(), SIGNAL(profileChanged()),
+            this,            SLOT(onStyleProfileChanged()));
+
     registerStyleSetting(host);
     registerFeedbackSetting(host);
     registerAutoCorrectSetting(host);
@@ -354,6 +435,23 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     registerWordEngineSetting(host);
     registerHideWordRibbonInPortraitModeSetting(host);
     registerAutoRepeatBehaviour(host);
+    registerGestureTypingSetting(host);
+    registerNextWordPredictionSetting(host);
+    registerTracingSetting(host);
+    registerPerformanceCountersSetting(host);
+    registerMemoryReportSetting(host);
+
+    // Opt-in recording of input sessions, for replaying them later on:
+    const QByteArray trace_file(qgetenv("MALIIT_KEYBOARD_SESSION_TRACE"));
+    if (not trace_file.isEmpty() && d->recorder.start(QString::fromLocal8Bit(trace_file.constData()))) {
+        d->layout.event_handler.setSessionRecorder(&d->recorder);
+        connect(&d->notifier, SIGNAL(cursorPositionChanged(int, QString)),
+                &d->recorder, SLOT(recordCursorPositionChanged(int, QString)));
+
+        d->recorder.recordScreenSizeChanged(QGuiApplication::primaryScreen()->availableSize());
+        d->recorder.recordKeyboardChanged(d->layout.updater.activeKeyboardId());
+        d->recorder.recordGestureTypingChanged(d->settings.gesture_typing->value().toBool());
+    }
 
     // Setting layout orientation depends on word engine and hide word ribbon
     // settings to be initialized first:
@@ -363,7 +461,11 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
 }
 
 InputMethod::~InputMethod()
-{}
+{
+    if (Tracer::isEnabled()) {
+        Tracer::writeChromeTrace(traceFileName());
+    }
+}
 
 void InputMethod::show()
 {
@@ -430,7 +532,10 @@ void InputMethod::setActiveSubView(const QString &id,
     Q_UNUSED(state)
     Q_D(InputMethod);
 
-    // FIXME: Perhaps better to let both LayoutUpdater share the same KeyboardLoader instance?
+    d->recorder.recordKeyboardChanged(id);
+
+    // Both LayoutUpdater instances share one KeyboardRepository, so the
+    // layout only gets parsed once:
     d->layout.updater.setActiveKeyboardId(id);
     d->extended_layout.updater.setActiveKeyboardId(id);
 }
@@ -547,6 +652,45 @@ void InputMethod::registerAutoCapsSetting(MAbstractInputMethodHost *host)
 }
 
 
+void InputMethod::registerGestureTypingSetting(MAbstractInputMethodHost *host)
+{
+    Q_D(InputMethod);
+
+    QVariantMap attributes;
+    attributes[Maliit::SettingEntryAttributes::defaultValue] = false;
+
+    d->settings.gesture_typing.reset(host->registerPluginSetting("gesture_typing_enabled",
+                                                                 QT_TR_NOOP("Gesture typing enabled"),
+                                                                 Maliit::BoolType,
+                                                                 attributes));
+
+    connect(d->settings.gesture_typing.data(), SIGNAL(valueChanged()),
+            this,                              SLOT(onGestureTypingSettingChanged()));
+
+    d->layout.event_handler.setGestureTypingEnabled(d->settings.gesture_typing->value().toBool());
+    d->editor.wordEngine()->setGestureTypingEnabled(d->settings.gesture_typing->value().toBool());
+}
+
+
+void InputMethod::registerNextWordPredictionSetting(MAbstractInputMethodHost *host)
+{
+    Q_D(InputMethod);
+
+    QVariantMap attributes;
+    attributes[Maliit::SettingEntryAttributes::defaultValue] = true;
+
+    d->settings.next_word_prediction.reset(host->registerPluginSetting("next_word_prediction_enabled",
+                                                                       QT_TR_NOOP("Next word prediction enabled"),
+                                                                       Maliit::BoolType,
+                                                                       attributes));
+
+    connect(d->settings.next_word_prediction.data(), SIGNAL(valueChanged()),
+            this,                                    SLOT(onNextWordPredictionSettingChanged()));
+
+    d->editor.wordEngine()->setNextWordPredictionEnabled(d->settings.next_word_prediction->value().toBool());
+}
+
+
 void InputMethod::registerWordEngineSetting(MAbstractInputMethodHost *host)
 {
     Q_D(InputMethod);
@@ -608,6 +752,88 @@ void InputMethod::registerAutoRepeatBehaviour(MAbstractInputMethodHost *host)
     onAutoRepeatBehaviourChanged();
 }
 
+//! Only available in builds with CONFIG+=enable-tracing. Disabling the
+//! setting writes the recorded trace, see traceFileName().
+void InputMethod::registerTracingSetting(MAbstractInputMethodHost *host)
+{
+#ifdef MALIIT_KEYBOARD_TRACING
+    Q_D(InputMethod);
+
+    QVariantMap attributes;
+    attributes[Maliit::SettingEntryAttributes::defaultValue] = false;
+
+    d->settings.tracing.reset(host->registerPluginSetting("tracing_enabled",
+                                                          QT_TR_NOOP("Record keystroke latency trace"),
+                                                          Maliit::BoolType,
+                                                          attributes));
+
+    connect(d->settings.tracing.data(), SIGNAL(valueChanged()),
+            this,                       SLOT(onTracingSettingChanged()));
+
+    onTracingSettingChanged();
+#else
+    Q_UNUSED(host)
+#endif
+}
+
+//! Debug setting: while enabled, the counters are logged and QML gets
+//! notified about changes once per second.
+void InputMethod::registerPerformanceCountersSetting(MAbstractInputMethodHost *host)
+{
+    Q_D(InputMethod);
+
+    QVariantMap attributes;
+    attributes[Maliit::SettingEntryAttributes::defaultValue] = false;
+
+    d->settings.performance_counters.reset(host->registerPluginSetting("performance_counters_enabled",
+                                                                       QT_TR_NOOP("Show performance counters"),
+                                                                       Maliit::BoolType,
+                                                                       attributes));
+
+    d->performance_counters_timer.setInterval(1000);
+    connect(&d->performance_counters_timer, SIGNAL(timeout()),
+            this,                           SLOT(onPerformanceCountersTimeout()));
+
+    connect(d->settings.performance_counters.data(), SIGNAL(valueChanged()),
+            this,                                    SLOT(onPerformanceCountersSettingChanged()));
+
+    onPerformanceCountersSettingChanged();
+}
+
+//! Debug setting: switching it on writes a memory report, see
+//! writeMemoryReport().
+void InputMethod::registerMemoryReportSetting(MAbstractInputMethodHost *host)
+{
+    Q_D(InputMethod);
+
+    QVariantMap attributes;
+    attributes[Maliit::SettingEntryAttributes::defaultValue] = false;
+
+    d->settings.memory_report.reset(host->registerPluginSetting("memory_report_enabled",
+                                                                QT_TR_NOOP("Write memory report"),
+                                                                Maliit::BoolType,
+                                                                attributes));
+
+    connect(d->settings.memory_report.data(), SIGNAL(valueChanged()),
+            this,                             SLOT(onMemoryReportSettingChanged()));
+}
+
+//! Returns MALIIT_KEYBOARD_TRACE_FILE if set, otherwise a file in the
+//! cache directory.
+QString InputMethod::traceFileName()
+{
+    const QByteArray trace_file(qgetenv("MALIIT_KEYBOARD_TRACE_FILE"));
+
+    if (not trace_file.isEmpty()) {
+        return QString::fromLocal8Bit(trace_file.constData());
+    }
+
+    const QString directory(CoreUtils::maliitKeyboardCacheDirectory());
+    QDir().mkpath(directory);
+
+    return directory + "/keystroke-trace.json";
+}
+
 
 void InputMethod::onLeftLayoutSelected()
 {
@@ -631,12 +857,114 @@ void InputMethod::onRightLayoutSelected()
     }
 }
 
+//! Aggregates the counters of all keyboard components. The counters are
+//! always maintained and cheap to read. Durations are in microseconds.
+QVariantMap InputMethod::performanceCounters() const
+{
+    Q_D(const InputMethod);
+
+    const SharedKeyboardRepository repository(d->layout.updater.keyboardRepository());
+    const Logic::AbstractWordEngine *const word_engine(d->editor.wordEngine());
+    QVariantMap counters;
+
+    if (repository) {
+        counters.insert("layout_parses", repository->parseCount());
+        counters.insert("layout_cache_hit_rate", hitRate(repository->cacheHitCount(),
+                                                         repository->cacheMissCount()));
+    }
+
+    counters.insert("geometry_rebuilds", d->layout.updater.rebuildCount()
+                                         + d->extended_layout.updater.rebuildCount());
+    counters.insert("model_resets", d->layout.model.resetCount()
+                                    + d->extended_layout.model.resetCount()
+                                    + d->magnifier_layout.resetCount());
+    counters.insert("row_insertions", d->layout.model.rowInsertionCount()
+                                      + d->extended_layout.model.rowInsertionCount()
+                                      + d->magnifier_layout.rowInsertionCount()
+                                      + d->word_ribbon.rowInsertionCount());
+    counters.insert("hit_tests", d->layout.event_handler.hitTestCount()
+                                 + d->extended_layout.event_handler.hitTestCount());
+
+    if (word_engine) {
+        counters.insert("candidate_computations", word_engine->candidateComputationCount());
+        counters.insert("candidate_computation_time", word_engine->candidateComputationTime());
+        counters.insert("candidate_computation_max_time", word_engine->maxCandidateComputationTime());
+    }
+
+    counters.insert("image_cache_hit_rate", hitRate(d->image_cache.hitCount(),
+                                                    d->image_cache.missCount()));
+    counters.insert("host_calls", d->editor.hostCalls());
+    counters.insert("saved_host_calls", d->editor.savedHostCalls());
+
+    return counters;
+}
+
+//! Estimates the memory held by each subsystem, in bytes. See
+//! MemoryUsage for what the estimates cover. QML object trees are reported
+//! as object counts, as their memory cannot be attributed from here.
+QVariantMap InputMethod::memoryReport() const
+{
+    Q_D(const InputMethod);
+
+    const SharedKeyboardRepository repository(d->layout.updater.keyboardRepository());
+    const Logic::AbstractWordEngine *const word_engine(d->editor.wordEngine());
+
+    QVariantMap layouts;
+    layouts.insert("repository", repository ? repository->memoryUsage() : 0);
+    layouts.insert("key_areas", MemoryUsage::ofKeyArea(d->layout.model.keyArea())
+                                + MemoryUsage::ofKeyArea(d->extended_layout.model.keyArea())
+                                + MemoryUsage::ofKeyArea(d->magnifier_layout.keyArea()));
+
+    QVariantMap style;
+    style.insert("attributes", d->style->memoryUsage());
+    style.insert("images", d->image_cache.memoryUsage());
+    style.insert("image_count", d->image_cache.count());
+
+    QVariantMap word_engine_usage;
+    word_engine_usage.insert("dictionaries", word_engine ? word_engine->memoryUsage() : 0);
+
+    QVariantMap qml;
+    qml.insert("keyboard_objects", qmlObjectCount(d->surface.data()));
+    qml.insert("extended_keys_objects", qmlObjectCount(d->extended_surface.data()));
+    qml.insert("magnifier_objects", qmlObjectCount(d->magnifier_surface.data()));
+
+    QVariantMap report;
+    report.insert("layouts", layouts);
+    report.insert("style", style);
+    report.insert("word_engine", word_engine_usage);
+    report.insert("qml", qml);
+    report.insert("total", (layouts.value("repository").toLongLong()
+                            + layouts.value("key_areas").toLongLong()
+                            + style.value("attributes").toLongLong()
+                            + style.value("images").toLongLong()
+                            + word_engine_usage.value("dictionaries").toLongLong()));
+    report.insert("process_resident", MemoryUsage::residentSetSize());
+
+    return report;
+}
+
+//! Writes memoryReport() as JSON document.
+bool InputMethod::writeMemoryReport(const QString &file_name) const
+{
+    QFile file(file_name);
+
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Could not open memory report file:" << file_name;
+        return false;
+    }
+
+    file.write(QJsonDocument::fromVariant(memoryReport()).toJson());
+    return true;
+}
+
 void InputMethod::onScreenSizeChange(const QRect &)
 {
     Q_D(InputMethod);
 
     const QSize &size(QGuiApplication::primaryScreen()->availableSize());
 
+    d->recorder.recordScreenSizeChanged(size);
     d->layout.helper.setScreenSize(size);
     d->extended_layout.helper.setScreenSize(d->layout.helper.screenSize());
 
@@ -648,9 +976,21 @@ void InputMethod::onStyleSettingChanged()
 {
     Q_D(InputMethod);
     d->style->setProfile(d->settings.style->value().toString());
-    d->layout.model.setImageDirectory(d->style->directory(Style::Images));
-    d->extended_layout.model.setImageDirectory(d->style->directory(Style::Images));
-    d->magnifier_layout.setImageDirectory(d->style->directory(Style::Images));
+}
+
+void InputMethod::onStyleProfileChanged()
+{
+    Q_D(InputMethod);
+
+    // Images are served from the preloaded ImageCache:
+    const QString image_directory(d->style->profile().isEmpty()
+                                  ? QString()
+                                  : QString("image://%1/%2").arg(g_style_image_provider_id)
+                                                            .arg(d->style->profile()));
+
+    d->layout.model.setImageDirectory(image_directory);
+    d->extended_layout.model.setImageDirectory(image_directory);
+    d->magnifier_layout.setImageDirectory(image_directory);
 }
 
 void InputMethod::onKeyboardClosed()
@@ -677,6 +1017,20 @@ void InputMethod::onAutoCapsSettingChanged()
     d->editor.setAutoCapsEnabled(d->settings.auto_caps->value().toBool());
 }
 
+void InputMethod::onGestureTypingSettingChanged()
+{
+    Q_D(InputMethod);
+    d->layout.event_handler.setGestureTypingEnabled(d->settings.gesture_typing->value().toBool());
+    d->editor.wordEngine()->setGestureTypingEnabled(d->settings.gesture_typing->value().toBool());
+    d->recorder.recordGestureTypingChanged(d->settings.gesture_typing->value().toBool());
+}
+
+void InputMethod::onNextWordPredictionSettingChanged()
+{
+    Q_D(InputMethod);
+    d->editor.wordEngine()->setNextWordPredictionEnabled(d->settings.next_word_prediction->value().toBool());
+}
+
 void InputMethod::onWordEngineSettingChanged()
 {
     // FIXME: Renderer doesn't seem to update graphics properly. Word ribbon
@@ -691,6 +1045,64 @@ void InputMethod::onHideWordRibbonInPortraitModeSettingChanged()
     d->setLayoutOrientation(d->layout.helper.orientation());
 }
 
+void InputMethod::onTracingSettingChanged()
+{
+    Q_D(InputMethod);
+    const bool enabled(d->settings.tracing->value().toBool());
+
+    if (enabled == Tracer::isEnabled()) {
+        return;
+    }
+
+    if (enabled) {
+        Tracer::clear();
+        Tracer::setEnabled(true);
+    } else {
+        Tracer::setEnabled(false);
+        Tracer::writeChromeTrace(traceFileName());
+    }
+}
+
+void InputMethod::onPerformanceCountersSettingChanged()
+{
+    Q_D(InputMethod);
+
+    if (d->settings.performance_counters->value().toBool()) {
+        d->performance_counters_timer.start();
+    } else {
+        d->performance_counters_timer.stop();
+    }
+}
+
+void InputMethod::onPerformanceCountersTimeout()
+{
+    Q_D(InputMethod);
+
+    qDebug() << "Performance counters:" << performanceCounters();
+    Q_EMIT d->context.performanceCountersChanged();
+}
+
+void InputMethod::onMemoryReportSettingChanged()
+{
+    Q_D(InputMethod);
+
+    if (not d->settings.memory_report->value().toBool()) {
+        return;
+    }
+
+    const QByteArray report_file(qgetenv("MALIIT_KEYBOARD_MEMORY_REPORT_FILE"));
+    QString file_name(QString::fromLocal8Bit(report_file.constData()));
+
+    if (file_name.isEmpty()) {
+        QDir().mkpath(CoreUtils::maliitKeyboardCacheDirectory());
+        file_name = CoreUtils::maliitKeyboardCacheDirectory() + "/memory-report.json";
+    }
+
+    if (writeMemoryReport(file_name)) {
+        qDebug() << "Memory report written to" << file_name;
+    }
+}
+
 void InputMethod::onAutoRepeatBehaviourChanged()
 {
     Q_D(InputMethod);
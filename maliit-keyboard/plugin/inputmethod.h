@@ -73,24 +73,41 @@ public:
     Q_SLOT void onLeftLayoutSelected();
     Q_SLOT void onRightLayoutSelected();
 
+    QVariantMap performanceCounters() const;
+    QVariantMap memoryReport() const;
+    bool writeMemoryReport(const QString &file_name) const;
+
 private:
     void registerStyleSetting(MAbstractInputMethodHost *host);
     void registerFeedbackSetting(MAbstractInputMethodHost *host);
     void registerAutoCorrectSetting(MAbstractInputMethodHost *host);
     void registerAutoCapsSetting(MAbstractInputMethodHost *host);
+    void registerGestureTypingSetting(MAbstractInputMethodHost *host);
+    void registerNextWordPredictionSetting(MAbstractInputMethodHost *host);
     void registerWordEngineSetting(MAbstractInputMethodHost *host);
     void registerHideWordRibbonInPortraitModeSetting(MAbstractInputMethodHost *host);
     void registerAutoRepeatBehaviour(MAbstractInputMethodHost *host);
+    void registerTracingSetting(MAbstractInputMethodHost *host);
+    void registerPerformanceCountersSetting(MAbstractInputMethodHost *host);
+    void registerMemoryReportSetting(MAbstractInputMethodHost *host);
+    static QString traceFileName();
 
     Q_SLOT void onScreenSizeChange(const QRect &rect);
     Q_SLOT void onStyleSettingChanged();
+    Q_SLOT void onStyleProfileChanged();
     Q_SLOT void onKeyboardClosed();
     Q_SLOT void onFeedbackSettingChanged();
     Q_SLOT void onAutoCorrectSettingChanged();
     Q_SLOT void onAutoCapsSettingChanged();
+    Q_SLOT void onGestureTypingSettingChanged();
+    Q_SLOT void onNextWordPredictionSettingChanged();
     Q_SLOT void onWordEngineSettingChanged();
     Q_SLOT void onHideWordRibbonInPortraitModeSettingChanged();
     Q_SLOT void onAutoRepeatBehaviourChanged();
+    Q_SLOT void onTracingSettingChanged();
+    Q_SLOT void onPerformanceCountersSettingChanged();
+    Q_SLOT void onPerformanceCountersTimeout();
+    Q_SLOT void onMemoryReportSettingChanged();
     Q_SLOT void updateKey(const QString &key_id,
                           const MKeyOverride::KeyOverrideAttributes changed_attributes);
 
@@ -106,4 +106,22 @@ void MaliitContext::selectRightLayout()
     d->input_method->onRightLayoutSelected();
 }
 
+
+//! \brief Returns the runtime counters of the keyboard.
+//! \sa InputMethod::performanceCounters()
+QVariantMap MaliitContext::performanceCounters() const
+{
+    Q_D(const MaliitContext);
+    return d->input_method->performanceCounters();
+}
+
+
+//! \brief Returns the estimated memory usage of the keyboard.
+//! \sa InputMethod::memoryReport()
+QVariantMap MaliitContext::memoryReport() const
+{
+    Q_D(const MaliitContext);
+    return d->input_method->memoryReport();
+}
+
 } // namespace MaliitKeyboard
@@ -46,6 +46,8 @@ class MaliitContext
     Q_OBJECT
     Q_DISABLE_COPY(MaliitContext)
     Q_DECLARE_PRIVATE(MaliitContext)
+    Q_PROPERTY(QVariantMap performanceCounters READ performanceCounters
+                                               NOTIFY performanceCountersChanged)
 
 public:
     explicit MaliitContext(InputMethod *input_method,
@@ -58,6 +60,10 @@ public:
     Q_INVOKABLE void selectLeftLayout();
     Q_INVOKABLE void selectRightLayout();
 
+    QVariantMap performanceCounters() const;
+    Q_INVOKABLE QVariantMap memoryReport() const;
+    Q_SIGNAL void performanceCountersChanged();
+
 private:
     const QScopedPointer<MaliitContextPrivate> d_ptr;
 };
@@ -16,6 +16,8 @@ contains(QT_MAJOR_VERSION, 4) {
     QT = core gui widgets quick qml
 }
 
+enable-pcm-feedback: QT += multimedia
+
 CONFIG += \
     plugin \
 
@@ -25,6 +27,7 @@ HEADERS += \
     editor.h \
     updatenotifier.h \
     maliitcontext.h \
+    styleimageprovider.h \
 
 SOURCES += \
     plugin.cpp \
@@ -32,6 +35,7 @@ SOURCES += \
     editor.cpp \
     updatenotifier.cpp \
     maliitcontext.cpp \
+    styleimageprovider.cpp \
 
 target.path += $${MALIIT_PLUGINS_DIR}
 INSTALLS += target
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "styleimageprovider.h"
+#include "coreutils.h"
+#include "view/imagecache.h"
+
+namespace MaliitKeyboard {
+
+//! \class StyleImageProvider
+//! \brief Serves style images to QML from the shared ImageCache.
+//!
+//! Image ids take the form "<profile>/<file name>", so that QML does not
+//! mix up equally named images of different profiles.
+
+const char *const g_style_image_provider_id = "maliit";
+
+StyleImageProvider::StyleImageProvider(ImageCache *cache)
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_cache(cache)
+{
+    Q_ASSERT(m_cache != 0);
+}
+
+StyleImageProvider::~StyleImageProvider()
+{}
+
+QImage StyleImageProvider::requestImage(const QString &id,
+                                        QSize *size,
+                                        const QSize &requested_size)
+{
+    const int separator(id.indexOf('/'));
+
+    if (separator <= 0) {
+        return QImage();
+    }
+
+    const QString file_name(CoreUtils::maliitKeyboardStyleProfilesDirectory()
+                            + "/" + id.left(separator)
+                            + "/images/" + id.mid(separator + 1));
+    QImage image(m_cache->image(file_name));
+
+    if (size) {
+        *size = image.size();
+    }
+
+    if (requested_size.isValid() && not image.isNull()) {
+        image = image.scaled(requested_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    return image;
+}
+
+} // namespace MaliitKeyboard
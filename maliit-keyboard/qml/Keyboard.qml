@@ -132,16 +132,24 @@ Item {
                 // TODO: Move logic into EventHandler because gestures should depend on style?
                 // Hide keyboard on flick-down gesture (but only if there is an event_handler)
                 // or switch to left/right layout:
+                // Horizontal flicks are ambiguous with gesture typing, so
+                // they only switch layouts when gesture typing is off:
                 onPositionChanged: {
+                    if (event_handler) {
+                        event_handler.onMoved(index, mouse.x, mouse.y)
+                    }
+
                     if (event_handler
                         && gesture_timeout.running
                         && (mouse.y - start_y > (layout.height * 0.3))) {
                         maliit.hide()
                     } else if (event_handler
+                               && !event_handler.gestureTypingEnabled
                                && gesture_timeout.running
                                && (mouse.x - start_x > (layout.width * 0.2))) {
                         maliit.selectLeftLayout()
                     } else if (event_handler
+                               && !event_handler.gestureTypingEnabled
                                && gesture_timeout.running
                                && (start_x - mouse.x > (layout.width * 0.2))) {
                         maliit.selectRightLayout()
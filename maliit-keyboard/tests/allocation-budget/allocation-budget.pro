@@ -0,0 +1,29 @@
+include(../../config.pri)
+include(../common-check.pri)
+include(../../config-plugin.pri)
+
+TOP_BUILDDIR = $${OUT_PWD}/../../..
+TARGET = allocation-budget
+TEMPLATE = app
+QT = core testlib gui
+
+!contains(QT_MAJOR_VERSION, 4) {
+    QT += widgets
+}
+
+DEFINES += TEST_DATADIR=\\\"$$PWD\\\" TEST_BUILDDIR=\\\"$$OUT_PWD\\\"
+
+INCLUDEPATH += ../ ../../lib ../../
+LIBS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_PLUGIN_LIB} $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_VIEW_LIB} $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+PRE_TARGETDEPS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_PLUGIN_LIB} $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_VIEW_LIB} $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+
+HEADERS += \
+    wordengineprobe.h \
+
+SOURCES += \
+    wordengineprobe.cpp \
+    main.cpp \
+
+include(../common/allocationhooks.pri)
+
+include(../../word-prediction.pri)
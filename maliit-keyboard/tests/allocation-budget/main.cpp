@@ -0,0 +1,258 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "allocationhooks.h"
+#include "wordengineprobe.h"
+#include "utils.h"
+#include "common/inputmethodhostprobe.h"
+
+#include "plugin/editor.h"
+#include "models/layout.h"
+#include "models/ribbon.h"
+#include "models/text.h"
+#include "logic/eventhandler.h"
+#include "logic/languagefeatures.h"
+#include "logic/layouthelper.h"
+#include "logic/layoutupdater.h"
+#include "logic/style.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+//! Cycles run before measuring, so that lazily built caches and one-time
+//! registrations do not count against the budgets.
+const int WarmUpCycles = 3;
+const int MeasuredCycles = 10;
+
+//! When set, the measured values (plus headroom) are written to a budget
+//! file in the build directory instead of being checked against the one in
+//! the source tree. Copy it over budgets.ini to update the budgets.
+const char *const UpdateBudgetsVariable = "MALIIT_KEYBOARD_UPDATE_ALLOCATION_BUDGETS";
+const qreal UpdateHeadroom = 1.2;
+
+enum Stage {
+    StagePress,             //!< EventHandler::onPressed, incl. LayoutUpdater and editor.
+    StageRelease,           //!< EventHandler::onReleased, incl. preedit and word candidates.
+    StageCandidateSelect    //!< LayoutUpdater::onWordCandidateReleased, commits the preedit.
+};
+
+QString budgetFileName()
+{
+    return QString(TEST_DATADIR) + "/budgets.ini";
+}
+
+QString recordedBudgetFileName()
+{
+    return QString(TEST_BUILDDIR) + "/budgets.ini";
+}
+
+// The per-keystroke path as set up by the plugin, minus the views. Host
+// calls are not coalesced, so that their cost is part of the stage that
+// causes them.
+class KeystrokePipeline
+{
+public:
+    Model::Layout model;
+    Model::Ribbon ribbon;
+    Logic::LayoutHelper helper;
+    Logic::LayoutUpdater updater;
+    Logic::EventHandler event_handler;
+    Editor editor;
+    InputMethodHostProbe host;
+    SharedStyle style;
+    int key_index;
+
+    explicit KeystrokePipeline()
+        : model()
+        , ribbon()
+        , helper()
+        , updater()
+        , event_handler(&model, &updater)
+        , editor(new Model::Text, new Logic::WordEngineProbe, new Logic::LanguageFeatures)
+        , host()
+        , style(new Style)
+        , key_index(-1)
+    {
+        style->setProfile("nokia-n9");
+        editor.setHost(&host);
+
+        Logic::connectEventHandlerToTextEditor(&event_handler, &editor);
+        Logic::connectLayoutUpdaterToTextEditor(&updater, &editor);
+
+        QObject::connect(&helper, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)),
+                         &model,  SLOT(setKeyArea(KeyArea,Logic::KeyOverrides)));
+        QObject::connect(&helper, SIGNAL(wordRibbonChanged(WordRibbon)),
+                         &ribbon, SLOT(setWordRibbon(WordRibbon)));
+        QObject::connect(&helper, SIGNAL(wordCandidateCountChanged(int)),
+                         &ribbon, SLOT(setCandidateCount(int)));
+        QObject::connect(&helper, SIGNAL(wordCandidateChanged(int,WordCandidate)),
+                         &ribbon, SLOT(setCandidate(int,WordCandidate)));
+
+        helper.setScreenSize(QSize(854, 480));
+        helper.setAlignment(Logic::LayoutHelper::Bottom);
+        updater.setLayout(&helper);
+        updater.setStyle(style);
+        updater.setActiveKeyboardId("en_gb");
+        TestUtils::waitForSignal(&helper, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+
+        editor.wordEngine()->setEnabled(true);
+
+        const QVector<Key> keys(model.keyArea().keys());
+        for (int index = 0; index < keys.count(); ++index) {
+            if (keys.at(index).label().text() == "q") {
+                key_index = index;
+                break;
+            }
+        }
+    }
+
+    void run(Stage stage)
+    {
+        switch (stage) {
+        case StagePress:
+            event_handler.onPressed(key_index);
+            break;
+
+        case StageRelease:
+            event_handler.onReleased(key_index);
+            break;
+
+        case StageCandidateSelect:
+            updater.onWordCandidateReleased(0);
+            break;
+        }
+    }
+};
+
+} // unnamed namespace
+
+Q_DECLARE_METATYPE(Stage)
+
+class TestAllocationBudget
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase()
+    {
+        if (not AllocationHooks::interposesMalloc()) {
+            qWarning() << "Only operator new is counted on this platform.";
+        }
+    }
+
+    Q_SLOT void testStage_data()
+    {
+        QTest::addColumn<Stage>("stage");
+
+        QTest::newRow("press") << StagePress;
+        QTest::newRow("release") << StageRelease;
+        QTest::newRow("candidate_select") << StageCandidateSelect;
+    }
+
+    Q_SLOT void testStage()
+    {
+        QFETCH(Stage, stage);
+
+        KeystrokePipeline pipeline;
+        QVERIFY(pipeline.key_index >= 0);
+
+        // Every cycle goes through all stages, so that each stage starts
+        // from the state a real keystroke leaves behind. Only the given
+        // stage is measured, the worst cycle is kept:
+        AllocationHooks::Statistics worst;
+        const Stage stages[] = { StagePress, StageRelease, StageCandidateSelect };
+
+        for (int cycle = 0; cycle < WarmUpCycles + MeasuredCycles; ++cycle) {
+            for (unsigned int index = 0; index < sizeof(stages) / sizeof(stages[0]); ++index) {
+                const bool measured(stages[index] == stage && cycle >= WarmUpCycles);
+
+                if (measured) {
+                    AllocationHooks::startRecording();
+                }
+
+                pipeline.run(stages[index]);
+
+                if (measured) {
+                    const AllocationHooks::Statistics statistics(AllocationHooks::stopRecording());
+                    worst.allocations = qMax(worst.allocations, statistics.allocations);
+                    worst.frees = qMax(worst.frees, statistics.frees);
+                    worst.bytes = qMax(worst.bytes, statistics.bytes);
+                }
+            }
+        }
+
+        // Sanity check that the cycle did what it should:
+        QCOMPARE(pipeline.host.commitStringHistory().toLower(),
+                 QString("q ").repeated(WarmUpCycles + MeasuredCycles));
+
+        const QString name(QTest::currentDataTag());
+
+        if (not qgetenv(UpdateBudgetsVariable).isEmpty()) {
+            QSettings recorded(recordedBudgetFileName(), QSettings::IniFormat);
+            recorded.beginGroup(name);
+            recorded.setValue("allocations", qCeil(worst.allocations * UpdateHeadroom));
+            recorded.setValue("bytes", qCeil(worst.bytes * UpdateHeadroom));
+            qWarning() << "Recorded budget for" << name << "in" << recordedBudgetFileName()
+                       << "allocations:" << worst.allocations
+                       << "frees:" << worst.frees
+                       << "bytes:" << worst.bytes;
+            return;
+        }
+
+        QSettings budgets(budgetFileName(), QSettings::IniFormat);
+        budgets.beginGroup(name);
+
+        if (not budgets.contains("allocations") || not budgets.contains("bytes")) {
+            QFAIL(qPrintable(QString("No budget for %1 in %2, run with %3=1 to record one")
+                             .arg(name).arg(budgetFileName()).arg(UpdateBudgetsVariable)));
+        }
+
+        const qint64 allowed_allocations(budgets.value("allocations").toLongLong());
+        const qint64 allowed_bytes(budgets.value("bytes").toLongLong());
+
+        // Details only matter when over budget:
+        QVERIFY2(worst.allocations <= allowed_allocations,
+                 qPrintable(QString("%1 allocations (%2 frees, %3 bytes), budget is %4")
+                            .arg(worst.allocations).arg(worst.frees).arg(worst.bytes)
+                            .arg(allowed_allocations)));
+        QVERIFY2(worst.bytes <= allowed_bytes,
+                 qPrintable(QString("%1 bytes (%2 allocations), budget is %3")
+                            .arg(worst.bytes).arg(worst.allocations).arg(allowed_bytes)));
+    }
+};
+
+QTEST_MAIN(TestAllocationBudget)
+#include "main.moc"
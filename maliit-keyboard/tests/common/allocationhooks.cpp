@@ -0,0 +1,218 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "allocationhooks.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Thread local, so that recording needs no locking and is not disturbed by
+// worker threads. Initial-exec TLS of the executable, which is safe to
+// access from within malloc.
+__thread bool t_recording = false;
+__thread qint64 t_allocations = 0;
+__thread qint64 t_frees = 0;
+__thread qint64 t_bytes = 0;
+
+QAtomicInt g_total_allocations;
+
+inline void recordAllocation(std::size_t size)
+{
+    g_total_allocations.fetchAndAddRelaxed(1);
+
+    if (t_recording) {
+        ++t_allocations;
+        t_bytes += size;
+    }
+}
+
+inline void recordFree(void *memory)
+{
+    if (t_recording && memory) {
+        ++t_frees;
+    }
+}
+
+} // unnamed namespace
+
+#if defined(__GLIBC__)
+
+// Defining malloc and friends in the executable interposes them for all
+// shared libraries, including QtCore. glibc exports its implementation
+// under the __libc_ prefix. Functions not interposed here (memalign,
+// posix_memalign, ...) still use the same heap, so freeing their memory
+// through __libc_free is fine.
+extern "C" {
+
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *memory, std::size_t size);
+void __libc_free(void *memory);
+
+void *malloc(std::size_t size) throw()
+{
+    recordAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count,
+             std::size_t size) throw()
+{
+    recordAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *memory,
+              std::size_t size) throw()
+{
+    // Counted as free and allocation, as a moving realloc is both:
+    recordFree(memory);
+    recordAllocation(size);
+    return __libc_realloc(memory, size);
+}
+
+void free(void *memory) throw()
+{
+    recordFree(memory);
+    __libc_free(memory);
+}
+
+} // extern "C"
+
+#else
+
+// Without glibc, fall back to replacing global operator new and delete:
+
+namespace {
+
+void *countedAllocation(std::size_t size)
+{
+    recordAllocation(size);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+} // unnamed namespace
+
+void *operator new(std::size_t size)
+{
+    void *const memory(countedAllocation(size));
+
+    if (not memory) {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size,
+                   const std::nothrow_t &) throw()
+{
+    return countedAllocation(size);
+}
+
+void *operator new[](std::size_t size,
+                     const std::nothrow_t &) throw()
+{
+    return countedAllocation(size);
+}
+
+void operator delete(void *memory) throw()
+{
+    recordFree(memory);
+    std::free(memory);
+}
+
+void operator delete[](void *memory) throw()
+{
+    recordFree(memory);
+    std::free(memory);
+}
+
+void operator delete(void *memory,
+                     const std::nothrow_t &) throw()
+{
+    recordFree(memory);
+    std::free(memory);
+}
+
+void operator delete[](void *memory,
+                       const std::nothrow_t &) throw()
+{
+    recordFree(memory);
+    std::free(memory);
+}
+
+#endif
+
+namespace AllocationHooks {
+
+bool interposesMalloc()
+{
+#if defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void startRecording()
+{
+    t_allocations = 0;
+    t_frees = 0;
+    t_bytes = 0;
+    t_recording = true;
+}
+
+Statistics stopRecording()
+{
+    t_recording = false;
+
+    Statistics result;
+    result.allocations = t_allocations;
+    result.frees = t_frees;
+    result.bytes = t_bytes;
+
+    return result;
+}
+
+qint64 totalAllocations()
+{
+    return g_total_allocations.fetchAndAddRelaxed(0);
+}
+
+} // namespace AllocationHooks
@@ -0,0 +1,68 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_ALLOCATIONHOOKS_H
+#define MALIIT_KEYBOARD_ALLOCATIONHOOKS_H
+
+#include <QtCore>
+
+namespace AllocationHooks {
+
+struct Statistics
+{
+    qint64 allocations;
+    qint64 frees;
+    qint64 bytes; //!< Requested bytes, without allocator overhead.
+
+    Statistics()
+        : allocations(0)
+        , frees(0)
+        , bytes(0)
+    {}
+};
+
+//! Whether malloc and friends are interposed. If not, only global operator
+//! new is counted, which misses Qt's containers and strings.
+bool interposesMalloc();
+
+//! Starts counting heap operations of the calling thread. Allocations from
+//! other threads are never counted.
+void startRecording();
+
+//! Stops counting and returns what was counted since startRecording().
+Statistics stopRecording();
+
+//! Number of heap allocations since the process started, from all threads.
+qint64 totalAllocations();
+
+} // namespace AllocationHooks
+
+#endif // MALIIT_KEYBOARD_ALLOCATIONHOOKS_H
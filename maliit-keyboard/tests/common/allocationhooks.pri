@@ -0,0 +1,10 @@
+# Interposes malloc and friends to count heap operations. Only include this
+# into applications: the hooks affect the whole process, so they must not
+# end up in a library other targets link against.
+INCLUDEPATH += $$PWD
+
+HEADERS += \
+    $$PWD/allocationhooks.h \
+
+SOURCES += \
+    $$PWD/allocationhooks.cpp \
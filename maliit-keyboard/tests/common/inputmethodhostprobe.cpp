@@ -35,6 +35,10 @@
 
 InputMethodHostProbe::InputMethodHostProbe()
     : m_commit_string_history()
+    , m_commit_string_count(0)
+    , m_last_commit_replace_start(0)
+    , m_last_commit_replace_length(0)
+    , m_last_commit_cursor_pos(-1)
     , m_last_preedit_string()
     , m_last_key_event(QEvent::None, 0, Qt::NoModifier)
     , m_key_event_count(0)
@@ -50,16 +54,36 @@ QString InputMethodHostProbe::commitStringHistory() const
     return m_commit_string_history;
 }
 
+int InputMethodHostProbe::commitStringCount() const
+{
+    return m_commit_string_count;
+}
+
+int InputMethodHostProbe::lastCommitReplaceStart() const
+{
+    return m_last_commit_replace_start;
+}
+
+int InputMethodHostProbe::lastCommitReplaceLength() const
+{
+    return m_last_commit_replace_length;
+}
+
+int InputMethodHostProbe::lastCommitCursorPos() const
+{
+    return m_last_commit_cursor_pos;
+}
+
 void InputMethodHostProbe::sendCommitString(const QString &string,
                                             int replace_start,
                                             int replace_length,
                                             int cursor_pos)
 {
-    Q_UNUSED(replace_start)
-    Q_UNUSED(replace_length)
-    Q_UNUSED(cursor_pos)
-
     m_commit_string_history.append(string);
+    ++m_commit_string_count;
+    m_last_commit_replace_start = replace_start;
+    m_last_commit_replace_length = replace_length;
+    m_last_commit_cursor_pos = cursor_pos;
 }
 
 QString InputMethodHostProbe::lastPreeditString() const
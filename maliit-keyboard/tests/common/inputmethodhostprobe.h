@@ -45,6 +45,10 @@ class InputMethodHostProbe
 
 private:
     QString m_commit_string_history;
+    int m_commit_string_count;
+    int m_last_commit_replace_start;
+    int m_last_commit_replace_length;
+    int m_last_commit_cursor_pos;
     QString m_last_preedit_string;
     QKeyEvent m_last_key_event;
     int m_key_event_count;
@@ -58,6 +62,10 @@ public:
     InputMethodHostProbe();
 
     QString commitStringHistory() const;
+    int commitStringCount() const;
+    int lastCommitReplaceStart() const;
+    int lastCommitReplaceLength() const;
+    int lastCommitCursorPos() const;
     void sendCommitString(const QString &string,
                           int replace_start,
                           int replace_length,
@@ -133,6 +133,60 @@ private:
         QCOMPARE(host.commitStringHistory(), expected_commit_history);
     }
 
+    Q_SLOT void testCoalescing()
+    {
+        // The editor flushes queued updates on destruction, so the host
+        // has to outlive it:
+        InputMethodHostProbe host;
+        Logic::WordEngineProbe *word_engine = new Logic::WordEngineProbe;
+        Editor editor(new Model::Text, word_engine, new Logic::LanguageFeatures);
+
+        editor.setHost(&host);
+        editor.setCoalescingEnabled(true);
+
+        initializeWordEngine(word_engine);
+
+        editor.wordEngine()->setEnabled(true);
+        editor.setAutoCorrectEnabled(true);
+        editor.setPreeditEnabled(true);
+
+        appendInput(&editor, "Helol Wordl! ");
+
+        // Nothing reaches the host before the event loop runs:
+        QVERIFY(not host.preeditStringSent());
+        QCOMPARE(host.commitStringHistory(), QString());
+
+        editor.flushHostUpdates();
+
+        QCOMPARE(host.commitStringHistory(), QString("Hello World! "));
+        QVERIFY(editor.savedHostCalls() > 0);
+        QVERIFY(editor.hostCalls() > 0);
+    }
+
+    Q_SLOT void testCoalescingFlushOnDestruction()
+    {
+        InputMethodHostProbe host;
+
+        {
+            Logic::WordEngineProbe *word_engine = new Logic::WordEngineProbe;
+            Editor editor(new Model::Text, word_engine, new Logic::LanguageFeatures);
+
+            editor.setHost(&host);
+            editor.setCoalescingEnabled(true);
+
+            initializeWordEngine(word_engine);
+
+            editor.wordEngine()->setEnabled(true);
+            editor.setAutoCorrectEnabled(true);
+            editor.setPreeditEnabled(true);
+
+            appendInput(&editor, "Helol Wordl! ");
+            QCOMPARE(host.commitStringHistory(), QString());
+        }
+
+        QCOMPARE(host.commitStringHistory(), QString("Hello World! "));
+    }
+
     Q_SLOT void testAutoCaps_data()
     {
         QTest::addColumn<bool>("enable_auto_correct");
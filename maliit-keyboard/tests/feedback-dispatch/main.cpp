@@ -0,0 +1,206 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "view/abstractfeedback.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+enum Played
+{
+    Press,
+    Release,
+    LayoutChange,
+    KeyboardHide
+};
+}
+
+class RecordingFeedback
+    : public AbstractFeedback
+{
+public:
+    QMutex mutex;
+    QList<int> played;
+    QSet<QThread *> threads;
+    QSemaphore *blocker; //!< Blocks layout change feedback, if set.
+
+    explicit RecordingFeedback()
+        : AbstractFeedback()
+        , blocker(0)
+    {
+        setEnabled(true);
+    }
+
+    virtual ~RecordingFeedback()
+    {
+        setDispatchMode(DispatchDirectly);
+    }
+
+    virtual void setStyle(const SharedStyle &)
+    {}
+
+    int playedCount()
+    {
+        QMutexLocker locker(&mutex);
+        return played.count();
+    }
+
+private:
+    void record(Played effect)
+    {
+        QMutexLocker locker(&mutex);
+        played.append(effect);
+        threads.insert(QThread::currentThread());
+    }
+
+    virtual void playPressFeedback()
+    {
+        record(Press);
+    }
+
+    virtual void playReleaseFeedback()
+    {
+        record(Release);
+    }
+
+    virtual void playLayoutChangeFeedback()
+    {
+        if (blocker) {
+            blocker->acquire();
+        }
+
+        record(LayoutChange);
+    }
+
+    virtual void playKeyboardHideFeedback()
+    {
+        record(KeyboardHide);
+    }
+};
+
+class TestFeedbackDispatch
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    bool waitForPlayed(RecordingFeedback *feedback,
+                       int count)
+    {
+        for (int attempts = 0; attempts < 500; ++attempts) {
+            if (feedback->playedCount() >= count) {
+                return true;
+            }
+
+            QTest::qWait(10);
+        }
+
+        return false;
+    }
+
+    Q_SLOT void testDirectDispatch()
+    {
+        RecordingFeedback feedback;
+        QCOMPARE(feedback.dispatchMode(), AbstractFeedback::DispatchDirectly);
+
+        feedback.onKeyPressed();
+        feedback.onKeyReleased();
+        QCOMPARE(feedback.played, QList<int>() << Press << Release);
+        QCOMPARE(feedback.threads.count(), 1);
+        QVERIFY(feedback.threads.contains(QThread::currentThread()));
+
+        feedback.setEnabled(false);
+        feedback.onKeyboardHidden();
+        QCOMPARE(feedback.playedCount(), 2);
+    }
+
+    Q_SLOT void testWorkerDispatch()
+    {
+        RecordingFeedback feedback;
+        feedback.setDispatchMode(AbstractFeedback::DispatchFromWorker);
+
+        feedback.onKeyboardHidden();
+        QVERIFY(waitForPlayed(&feedback, 1));
+
+        feedback.onLayoutChanged();
+        QVERIFY(waitForPlayed(&feedback, 2));
+
+        QCOMPARE(feedback.played, QList<int>() << KeyboardHide << LayoutChange);
+        QCOMPARE(feedback.threads.count(), 1);
+        QVERIFY(not feedback.threads.contains(QThread::currentThread()));
+        QCOMPARE(feedback.droppedEffectCount(), 0);
+    }
+
+    Q_SLOT void testStalePressDropped()
+    {
+        QSemaphore blocker;
+        RecordingFeedback feedback;
+        feedback.blocker = &blocker;
+        feedback.setDispatchMode(AbstractFeedback::DispatchFromWorker);
+
+        // Keeps the worker busy while the key gets pressed and released:
+        feedback.onLayoutChanged();
+        feedback.onKeyPressed();
+        feedback.onKeyReleased();
+        blocker.release();
+
+        QVERIFY(waitForPlayed(&feedback, 2));
+        QTest::qWait(50);
+
+        QCOMPARE(feedback.played, QList<int>() << LayoutChange << Release);
+        QCOMPARE(feedback.droppedEffectCount(), 1);
+    }
+
+    Q_SLOT void testQueuedEffectsDroppedOnStop()
+    {
+        QSemaphore blocker;
+        RecordingFeedback feedback;
+        feedback.blocker = &blocker;
+        feedback.setDispatchMode(AbstractFeedback::DispatchFromWorker);
+
+        feedback.onLayoutChanged();
+        feedback.onKeyboardHidden();
+        blocker.release();
+        QVERIFY(waitForPlayed(&feedback, 1));
+
+        feedback.setDispatchMode(AbstractFeedback::DispatchDirectly);
+        QCOMPARE(feedback.playedCount() + feedback.droppedEffectCount(), 2);
+
+        feedback.onKeyPressed();
+        QCOMPARE(feedback.played.last(), int(Press));
+    }
+};
+
+QTEST_MAIN(TestFeedbackDispatch)
+#include "main.moc"
@@ -0,0 +1,220 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "models/key.h"
+#include "models/keyarea.h"
+#include "logic/gesturedecoder.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+const int KeyWidth = 40;
+const int KeyHeight = 50;
+
+// QWERTY letter rows, each row shifted by half a key to the right.
+KeyArea createKeyArea()
+{
+    const char * const rows[] = { "qwertyuiop", "asdfghjkl", "zxcvbnm" };
+    QVector<Key> keys;
+
+    for (int row = 0; row < 3; ++row) {
+        const QString letters(rows[row]);
+
+        for (int column = 0; column < letters.length(); ++column) {
+            Key key;
+            key.setAction(Key::ActionInsert);
+            key.rLabel().setText(letters.mid(column, 1));
+            key.setOrigin(QPoint(column * KeyWidth + row * KeyWidth / 2, row * KeyHeight));
+            key.rArea().setSize(QSize(KeyWidth, KeyHeight));
+            keys.append(key);
+        }
+    }
+
+    KeyArea key_area;
+    key_area.setKeys(keys);
+    return key_area;
+}
+
+// Draws a trajectory through the key centers of a word, with a touch
+// point every few pixels, like a finger would.
+QVector<QPoint> trajectoryForWord(const KeyArea &key_area,
+                                  const QString &word)
+{
+    QVector<QPoint> trajectory;
+
+    Q_FOREACH (const QChar &letter, word) {
+        Q_FOREACH (const Key &key, key_area.keys()) {
+            if (key.label().text() != QString(letter)) {
+                continue;
+            }
+
+            const QPoint target(key.rect().center());
+
+            if (not trajectory.isEmpty()) {
+                const QPoint from(trajectory.last());
+                for (int step = 1; step < 8; ++step) {
+                    trajectory.append(from + (target - from) * step / 8);
+                }
+            }
+
+            trajectory.append(target);
+        }
+    }
+
+    return trajectory;
+}
+
+const QStringList lexicon(QStringList()
+                          << "hello" << "help" << "hell" << "jello"
+                          << "world" << "word" << "would"
+                          << "test" << "text" << "tent"
+                          << "keyboard" << "Quick");
+
+// Size of a typical Hunspell dictionary.
+const int LargeLexiconSize = 100000;
+
+// Decoding has to keep up with the display, even for large lexicons, so
+// pruning must skip nearly all of the trie. Such a lexicon has several
+// nodes per word, "keyboard" visits about 4400 of them.
+const int MaxVisitedNodes = LargeLexiconSize / 10;
+
+// Adds pseudo-random words to the lexicon until it has the given size.
+QStringList largeLexicon(int size)
+{
+    const QString letters("qwertyuiopasdfghjklzxcvbnm");
+    QStringList words(lexicon);
+    QSet<QString> known;
+    quint32 seed = 1;
+
+    Q_FOREACH (const QString &word, lexicon) {
+        known.insert(word.toLower());
+    }
+
+    while (words.count() < size) {
+        seed = seed * 1103515245 + 12345;
+        const int length(3 + (seed >> 16) % 8);
+        QString word;
+
+        for (int index = 0; index < length; ++index) {
+            seed = seed * 1103515245 + 12345;
+            word.append(letters.at((seed >> 16) % letters.length()));
+        }
+
+        if (not known.contains(word)) {
+            known.insert(word);
+            words.append(word);
+        }
+    }
+
+    return words;
+}
+
+} // unnamed namespace
+
+class TestGestureDecoder
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void testDecode_data()
+    {
+        QTest::addColumn<QString>("word");
+        QTest::addColumn<QString>("expected");
+
+        QTest::newRow("simple") << "hello" << "hello";
+        QTest::newRow("prefix of other word") << "word" << "word";
+        QTest::newRow("longer word") << "world" << "world";
+        QTest::newRow("double letters") << "test" << "test";
+        QTest::newRow("long word") << "keyboard" << "keyboard";
+        QTest::newRow("lexicon casing is kept") << "quick" << "Quick";
+    }
+
+    Q_SLOT void testDecode()
+    {
+        QFETCH(QString, word);
+        QFETCH(QString, expected);
+
+        const KeyArea key_area(createKeyArea());
+        Logic::GestureDecoder decoder;
+        decoder.setLexicon(lexicon);
+
+        const QStringList result(decoder.decode(trajectoryForWord(key_area, word), key_area, 3));
+
+        QVERIFY(not result.isEmpty());
+        QCOMPARE(result.first(), expected);
+        QVERIFY(result.count() <= 3);
+    }
+
+    Q_SLOT void testUnreachableWords()
+    {
+        const KeyArea key_area(createKeyArea());
+        Logic::GestureDecoder decoder;
+        decoder.setLexicon(QStringList() << "zebra" << "mnop");
+
+        // Neither word starts near "h", so the whole trie gets pruned:
+        QVERIFY(decoder.decode(trajectoryForWord(key_area, "hello"), key_area).isEmpty());
+        QCOMPARE(decoder.lexiconSize(), 2);
+    }
+
+    Q_SLOT void testLargeLexicon()
+    {
+        const KeyArea key_area(createKeyArea());
+        Logic::GestureDecoder decoder;
+        decoder.setLexicon(largeLexicon(LargeLexiconSize));
+        QCOMPARE(decoder.lexiconSize(), LargeLexiconSize);
+
+        int visited_nodes = 0;
+        const QStringList result(decoder.decode(trajectoryForWord(key_area, "keyboard"),
+                                                key_area, 5, &visited_nodes));
+
+        QVERIFY(not result.isEmpty());
+        QCOMPARE(result.first(), QString("keyboard"));
+        QVERIFY(visited_nodes > 0);
+        QVERIFY2(visited_nodes < MaxVisitedNodes,
+                 qPrintable(QString("Decoding visited %1 trie nodes").arg(visited_nodes)));
+    }
+
+    Q_SLOT void testIsGesture()
+    {
+        const QRect key(0, 0, KeyWidth, KeyHeight);
+
+        QVERIFY(not Logic::GestureDecoder::isGesture(QVector<QPoint>() << QPoint(20, 25) << QPoint(45, 30), key));
+        QVERIFY(Logic::GestureDecoder::isGesture(QVector<QPoint>() << QPoint(20, 25) << QPoint(90, 30), key));
+    }
+};
+
+QTEST_MAIN(TestGestureDecoder)
+#include "main.moc"
@@ -245,6 +245,8 @@ private:
     {
         QVERIFY(qputenv("MALIIT_PLUGINS_DATADIR", TEST_DATADIR));
         QVERIFY(qputenv("MALIIT_KEYBOARD_DATADIR", TEST_MALIIT_KEYBOARD_DATADIR));
+        QVERIFY(qputenv("MALIIT_KEYBOARD_CACHEDIR",
+                        QString(QDir::tempPath() + "/maliit-keyboard-tests").toLocal8Bit()));
     }
 
     Q_SLOT void testSanity_data()
@@ -579,6 +581,48 @@ private:
         QCOMPARE(style.directory(Style::Sounds), test_profile_dir + "/sounds");
     }
 
+    Q_SLOT void testCompiledStylingProfile()
+    {
+        const Logic::LayoutHelper::Orientation orientation(Logic::LayoutHelper::Landscape);
+        const QString compiled_file_name(CoreUtils::maliitKeyboardCacheDirectory()
+                                         + "/styles/test-profile/main.blob");
+        QFile::remove(compiled_file_name);
+
+        {
+            Style style;
+            style.setProfile("test-profile");
+            QVERIFY(QFile::exists(compiled_file_name));
+            QCOMPARE(style.attributes()->fontSize(orientation), 10.0);
+        }
+
+        // Second load reads the compiled blob:
+        Style style;
+        style.setProfile("test-profile");
+        QCOMPARE(style.attributes()->fontSize(orientation), 10.0);
+        QCOMPARE(style.extendedKeysAttributes()->fontSize(orientation), 0.0);
+    }
+
+    Q_SLOT void testImagePreloading()
+    {
+        Style style;
+        style.setImagePreloadingEnabled(true);
+
+        QSignalSpy preload_spy(&style, SIGNAL(imagePreloadRequested(QString,QStringList)));
+        QSignalSpy profile_changed_spy(&style, SIGNAL(profileChanged()));
+
+        style.setProfile("test-profile");
+        QCOMPARE(preload_spy.count(), 1);
+        QCOMPARE(profile_changed_spy.count(), 0);
+        QCOMPARE(preload_spy.first().at(0).toString(), style.directory(Style::Images));
+
+        // Results for other profiles are ignored:
+        style.onImagesPreloaded("/some/other/profile/images");
+        QCOMPARE(profile_changed_spy.count(), 0);
+
+        style.onImagesPreloaded(style.directory(Style::Images));
+        QCOMPARE(profile_changed_spy.count(), 1);
+    }
+
     Q_SLOT void testKeyGeometryStyling_data()
     {
         QTest::addColumn<int>("key_index");
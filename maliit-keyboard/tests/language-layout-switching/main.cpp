@@ -33,17 +33,51 @@
 #include "utils.h"
 #include "models/key.h"
 #include "models/keyarea.h"
+#include "models/layout.h"
 #include "logic/layouthelper.h"
 #include "plugin/editor.h"
 #include "logic/layoutupdater.h"
+#include "logic/keyboardrepository.h"
 #include "logic/style.h"
 #include "inputmethodhostprobe.h"
+#include "memoryusage.h"
 
 #include <QtCore>
 #include <QtTest>
 
 using namespace MaliitKeyboard;
 
+namespace {
+
+//! Layout updater driving its own layout helper, with default style.
+class TestLayout
+{
+    Q_DISABLE_COPY(TestLayout)
+
+public:
+    Logic::LayoutHelper layout;
+    Logic::LayoutUpdater updater;
+    SharedStyle style;
+
+    explicit TestLayout()
+        : layout()
+        , updater()
+        , style(new Style)
+    {
+        updater.setLayout(&layout);
+        updater.setStyle(style);
+    }
+
+    //! Switches to given keyboard and waits for the new center panel.
+    void load(const QString &id = "en_gb")
+    {
+        updater.setActiveKeyboardId(id);
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+    }
+};
+
+} // unnamed namespace
+
 class TestLanguageLayoutSwitching
     : public QObject
 {
@@ -85,6 +119,256 @@ private:
         QCOMPARE(layout.activeKeyArea().keys().count(), expected_key_count);
     }
 
+    Q_SLOT void testSingleRebuild()
+    {
+        TestLayout test;
+
+        // Initial setup and keyboard change happen in same main loop
+        // iteration, expect one rebuild:
+        test.load();
+        QCOMPARE(test.updater.rebuildCount(), 1);
+
+        // Several keyboard and orientation changes, still one rebuild:
+        QSignalSpy spy(&test.layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        test.updater.setActiveKeyboardId("de");
+        test.updater.setOrientation(Logic::LayoutHelper::Portrait);
+        test.updater.setActiveKeyboardId("en_gb");
+        QCOMPARE(test.updater.rebuildCount(), 1);
+        QCOMPARE(spy.count(), 0);
+
+        TestUtils::waitForSignal(&test.layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        QCOMPARE(test.updater.rebuildCount(), 2);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(test.layout.activeKeyArea().keys().count(), 33);
+    }
+
+    Q_SLOT void testSharedRepository()
+    {
+        TestLayout main_layout;
+        TestLayout extended_layout;
+        extended_layout.updater.setKeyboardRepository(main_layout.updater.keyboardRepository());
+
+        const SharedKeyboardRepository repository(main_layout.updater.keyboardRepository());
+        QCOMPARE(repository, extended_layout.updater.keyboardRepository());
+
+        main_layout.load();
+        const int parse_count(repository->parseCount());
+        const int cache_hit_count(repository->cacheHitCount());
+        QVERIFY(parse_count > 0);
+        QVERIFY(repository->cacheMissCount() > 0);
+
+        // Second group gets its layout without parsing again:
+        extended_layout.load();
+        QCOMPARE(repository->parseCount(), parse_count);
+        QVERIFY(repository->cacheHitCount() > cache_hit_count);
+        QCOMPARE(extended_layout.layout.activeKeyArea().keys().count(),
+                 main_layout.layout.activeKeyArea().keys().count());
+    }
+
+    Q_SLOT void testRepositoryMemoryUsage()
+    {
+        TestLayout test;
+
+        const SharedKeyboardRepository repository(test.updater.keyboardRepository());
+        const qint64 initial_usage(repository->memoryUsage());
+
+        test.load();
+
+        // Parsed tag tree and converted keys are accounted for:
+        const qint64 loaded_usage(repository->memoryUsage());
+        QVERIFY(loaded_usage > initial_usage);
+        QVERIFY(MemoryUsage::ofKeyArea(test.layout.activeKeyArea()) > 0);
+
+        repository->clear();
+        QVERIFY(repository->memoryUsage() < loaded_usage);
+    }
+
+    Q_SLOT void testRepositoryImports()
+    {
+        KeyboardRepository repository;
+        KeyboardImports imports;
+
+        QVERIFY(repository.lookupImports("en_gb", &imports));
+        QCOMPARE(imports.symviews, QStringList() << "symbols_en.xml");
+        QCOMPARE(repository.parseCount(), 1);
+
+        // Imports and tag tree come from the same parse:
+        QVERIFY(not repository.tagKeyboard("en_gb").isNull());
+        QCOMPARE(repository.parseCount(), 1);
+
+        QVERIFY(not repository.lookupImports("does_not_exist", &imports));
+    }
+
+    Q_SLOT void testKeyboardCacheSize()
+    {
+        KeyboardRepository repository;
+        const qint64 initial_usage(repository.memoryUsage());
+
+        Keyboard keyboard;
+        keyboard.keys.resize(10);
+        keyboard.key_descriptions.resize(10);
+
+        repository.storeKeyboard("en_gb/0", keyboard);
+        const qint64 cost(repository.memoryUsage() - initial_usage);
+        QVERIFY(cost > 0);
+
+        // Room for three keyboards, older ones get dropped:
+        repository.setKeyboardCacheSize(static_cast<int>(3 * cost));
+
+        for (int index = 1; index < 10; ++index) {
+            repository.storeKeyboard(QString("en_gb/%1").arg(index), keyboard);
+            QVERIFY(repository.memoryUsage() - initial_usage <= repository.keyboardCacheSize());
+        }
+
+        QVERIFY(not repository.lookupKeyboard("en_gb/0", 0));
+        QVERIFY(not repository.lookupKeyboard("en_gb/6", 0));
+        QVERIFY(repository.lookupKeyboard("en_gb/7", 0));
+        QVERIFY(repository.lookupKeyboard("en_gb/9", &keyboard));
+        QCOMPARE(keyboard.keys.count(), 10);
+    }
+
+    Q_SLOT void testIncrementalKeyOverrides()
+    {
+        TestLayout test;
+        Logic::LayoutHelper &layout(test.layout);
+        test.load();
+
+        Model::Layout model;
+        model.setKeyArea(layout.centerPanel());
+        QObject::connect(&layout, SIGNAL(centerKeysOverriden(QVector<int>,Logic::KeyOverrides)),
+                         &model,  SLOT(applyKeyOverrides(QVector<int>,Logic::KeyOverrides)));
+
+        const KeyArea center(layout.centerPanel());
+        int return_index = -1;
+
+        for (int index = 0; index < center.keys().count(); ++index) {
+            if (center.keys().at(index).action() == Key::ActionReturn) {
+                return_index = index;
+            }
+        }
+
+        QVERIFY(return_index != -1);
+        const QString original_text(model.data(return_index, "key_text").toString());
+
+        QSignalSpy panel_spy(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        QSignalSpy reset_spy(&model, SIGNAL(modelReset()));
+        QSignalSpy data_spy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+        Key go;
+        go.rLabel().setText("Go");
+        Logic::KeyOverrides overrides;
+        overrides.insert("actionKey", go);
+
+        layout.onKeysOverriden(overrides, false);
+        QCOMPARE(data_spy.count(), 1);
+        QCOMPARE(data_spy.first().first().value<QModelIndex>().row(), return_index);
+        QCOMPARE(model.data(return_index, "key_text").toString(), QString("Go"));
+
+        // Apps updating the action key on every keystroke only touch its row:
+        go.rLabel().setText("Send");
+        overrides.insert("actionKey", go);
+        layout.onKeysOverriden(overrides, true);
+        QCOMPARE(data_spy.count(), 2);
+        QCOMPARE(model.data(return_index, "key_text").toString(), QString("Send"));
+
+        layout.onKeysOverriden(overrides, true);
+        QCOMPARE(data_spy.count(), 2);
+
+        layout.onKeysOverriden(Logic::KeyOverrides(), false);
+        QCOMPARE(data_spy.count(), 3);
+        QCOMPARE(model.data(return_index, "key_text").toString(), original_text);
+
+        QCOMPARE(panel_spy.count(), 0);
+        QCOMPARE(reset_spy.count(), 0);
+    }
+
+    Q_SLOT void testKeyAreaSharing()
+    {
+        TestLayout test;
+        Logic::LayoutHelper &layout(test.layout);
+
+        Model::Layout model;
+        QObject::connect(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)),
+                         &model,  SLOT(setKeyArea(KeyArea,Logic::KeyOverrides)));
+
+        test.load();
+
+        // Keys reach the model without being copied:
+        QVERIFY(model.keyArea().hasKeys());
+        QCOMPARE(&model.keyArea().keys().at(0), &layout.centerPanel().keys().at(0));
+        QCOMPARE(model.keyArea().generation(), layout.centerPanel().generation());
+
+        // Setting an unmodified copy is a no-op:
+        QSignalSpy panel_spy(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        KeyArea center(layout.centerPanel());
+        layout.setCenterPanel(center);
+        QCOMPARE(panel_spy.count(), 0);
+
+        // Mutable access assigns a new generation, content is still
+        // compared then:
+        const uint generation(center.generation());
+        const QString text(center.keys().at(0).label().text());
+        center.rKeys()[0].rLabel().setText(text);
+        QVERIFY(center.generation() != generation);
+
+        layout.setCenterPanel(center);
+        QCOMPARE(panel_spy.count(), 0);
+
+        center.rKeys()[0].rLabel().setText("modified");
+        layout.setCenterPanel(center);
+        QCOMPARE(panel_spy.count(), 1);
+        QCOMPARE(model.keyArea().keys().at(0).label().text(), QString("modified"));
+    }
+
+    Q_SLOT void testKeyColumns()
+    {
+        TestLayout test;
+        test.load();
+
+        KeyArea center(test.layout.centerPanel());
+        const int count(center.keys().count());
+        QVERIFY(count > 1);
+
+        // One entry per key, in key order:
+        QCOMPARE(center.keyRects().count(), count);
+        QCOMPARE(center.keyActions().count(), count);
+
+        for (int index = 0; index < count; ++index) {
+            QCOMPARE(center.keyRects().at(index), center.keys().at(index).rect());
+            QCOMPARE(Key::Action(center.keyActions().at(index)), center.keys().at(index).action());
+        }
+
+        // Rebuilt after mutable access:
+        center.rKeys()[0].setOrigin(QPoint(3, 4));
+        QCOMPARE(center.keyRects().at(0).topLeft(), QPoint(3, 4));
+
+        // Updated in place by replaceKey, without touching copies:
+        const KeyArea copy(center);
+        Key key(center.keys().at(1));
+        key.setOrigin(QPoint(5, 6));
+        key.setAction(Key::ActionBackspace);
+        center.replaceKey(1, key);
+
+        QVERIFY(center.generation() != copy.generation());
+        QCOMPARE(center.keyRects().at(1).topLeft(), QPoint(5, 6));
+        QCOMPARE(Key::Action(center.keyActions().at(1)), Key::ActionBackspace);
+        QCOMPARE(copy.keyRects().at(1), copy.keys().at(1).rect());
+        QCOMPARE(Key::Action(copy.keyActions().at(1)), copy.keys().at(1).action());
+
+        // Columns built after the replacement agree with the keys:
+        KeyArea rebuilt;
+        rebuilt.setKeys(center.keys());
+        QCOMPARE(rebuilt.keyRects(), center.keyRects());
+        QCOMPARE(rebuilt.keyActions(), center.keyActions());
+
+        // Model::Layout replaces pressed keys the same way:
+        Model::Layout model;
+        model.setKeyArea(center);
+        model.replaceKey(0, key);
+        QCOMPARE(model.keyArea().keyRects().at(0).topLeft(), QPoint(5, 6));
+        QCOMPARE(model.keyArea().keyRects().count(), count);
+    }
+
     // This test is very trivial. It's required however because none of the
     // current mainline layouts feature layout switch keys, thus making
     // regressions impossible to spot.
@@ -0,0 +1,362 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "logic/hitlogic.h"
+#include "logic/keyboardloader.h"
+#include "logic/keyboardrepository.h"
+#include "logic/keyareaconverter.h"
+#include "logic/abstracttexteditor.h"
+#include "logic/style.h"
+#include "models/keyarea.h"
+#include "models/styleattributes.h"
+#include "models/text.h"
+#include "parser/layoutparser.h"
+#include "tracer.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+Q_DECLARE_METATYPE(MaliitKeyboard::Logic::LayoutHelper::Orientation)
+
+namespace {
+
+//! Distance between touch points of the hit test grid, in pixels.
+const int TouchGridStep = 4;
+
+enum TraceScopeMode {
+    TraceScopeNone,
+    TraceScopeMacro,
+    TraceScopeDisabled,
+    TraceScopeEnabled
+};
+
+KeyArea styledKeyArea(const QString &layout,
+                      Logic::LayoutHelper::Orientation orientation)
+{
+    Style style;
+    style.setProfile(MALIIT_DEFAULT_PROFILE);
+
+    KeyboardLoader loader;
+    loader.setActiveId(layout);
+
+    Logic::KeyAreaConverter converter(style.attributes(), &loader);
+    converter.setLayoutOrientation(orientation);
+
+    return converter.keyArea();
+}
+
+QString longText(int length)
+{
+    const QString sentence("The quick brown fox jumps over the lazy dog. ");
+    QString text;
+    text.reserve(length + sentence.length());
+
+    while (text.length() < length) {
+        text.append(sentence);
+    }
+
+    text.truncate(length);
+    return text;
+}
+
+} // unnamed namespace
+
+//! Microbenchmarks for hot paths. Run with e.g. -tickcounter or
+//! -iterations N for stable numbers; by default each benchmark runs
+//! only once as part of the test suite.
+class TestMicrobenchmarks
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void benchmarkKeyHit_data()
+    {
+        QTest::addColumn<QString>("layout");
+        QTest::addColumn<Logic::LayoutHelper::Orientation>("orientation");
+
+        QTest::newRow("en_gb, landscape") << "en_gb" << Logic::LayoutHelper::Landscape;
+        QTest::newRow("en_gb, portrait") << "en_gb" << Logic::LayoutHelper::Portrait;
+        QTest::newRow("ar, landscape") << "ar" << Logic::LayoutHelper::Landscape;
+        QTest::newRow("de, landscape") << "de" << Logic::LayoutHelper::Landscape;
+    }
+
+    Q_SLOT void benchmarkKeyHit()
+    {
+        QFETCH(QString, layout);
+        QFETCH(Logic::LayoutHelper::Orientation, orientation);
+
+        const KeyArea key_area(styledKeyArea(layout, orientation));
+        const QVector<Key> keys(key_area.keys());
+        const QRect geometry(key_area.rect());
+
+        QVERIFY(not keys.isEmpty());
+
+        // Dense touch grid over the whole key area, hits and misses:
+        QVector<QPoint> touches;
+        for (int y = geometry.top(); y <= geometry.bottom(); y += TouchGridStep) {
+            for (int x = geometry.left(); x <= geometry.right(); x += TouchGridStep) {
+                touches.append(QPoint(x, y));
+            }
+        }
+
+        int hits(0);
+        QBENCHMARK {
+            hits = 0;
+            Q_FOREACH (const QPoint &touch, touches) {
+                if (Logic::keyHit(keys, geometry, touch).valid()) {
+                    ++hits;
+                }
+            }
+        }
+
+        QVERIFY(hits > 0);
+    }
+
+    Q_SLOT void benchmarkKeyBackground()
+    {
+        Style style;
+        style.setProfile(MALIIT_DEFAULT_PROFILE);
+        const StyleAttributes *const attributes(style.attributes());
+
+        QByteArray background;
+        QBENCHMARK {
+            for (int key_style = Key::StyleNormalKey; key_style <= Key::StyleActivated; ++key_style) {
+                for (int state = KeyDescription::NormalState; state <= KeyDescription::HighlightedState; ++state) {
+                    background = attributes->keyBackground(Key::Style(key_style),
+                                                           KeyDescription::State(state));
+                }
+            }
+        }
+
+        QVERIFY(not background.isEmpty());
+    }
+
+    Q_SLOT void benchmarkKeyWidth()
+    {
+        Style style;
+        style.setProfile(MALIIT_DEFAULT_PROFILE);
+        const StyleAttributes *const attributes(style.attributes());
+
+        qreal width(0);
+        QBENCHMARK {
+            for (int orientation = Logic::LayoutHelper::Landscape;
+                 orientation <= Logic::LayoutHelper::Portrait;
+                 ++orientation) {
+                for (int key_width = KeyDescription::XXSmall; key_width <= KeyDescription::Stretched; ++key_width) {
+                    width = attributes->keyWidth(Logic::LayoutHelper::Orientation(orientation),
+                                                 KeyDescription::Width(key_width));
+                }
+            }
+        }
+
+        QVERIFY(width >= 0);
+    }
+
+    Q_SLOT void benchmarkIcon()
+    {
+        Style style;
+        style.setProfile(MALIIT_DEFAULT_PROFILE);
+        const StyleAttributes *const attributes(style.attributes());
+
+        QByteArray icon;
+        QBENCHMARK {
+            for (int icon_type = KeyDescription::LeftIcon; icon_type < KeyDescription::CustomIcon; ++icon_type) {
+                for (int state = KeyDescription::NormalState; state <= KeyDescription::HighlightedState; ++state) {
+                    icon = attributes->icon(KeyDescription::Icon(icon_type),
+                                            KeyDescription::State(state));
+                }
+            }
+        }
+    }
+
+    Q_SLOT void benchmarkLayoutParser_data()
+    {
+        QTest::addColumn<QByteArray>("contents");
+
+        const QDir languages(KeyboardRepository::languagesDirectory(), "*.xml");
+
+        Q_FOREACH (const QFileInfo &file_info, languages.entryInfoList(QDir::Files)) {
+            QFile file(file_info.filePath());
+
+            if (file.open(QIODevice::ReadOnly)) {
+                QTest::newRow(file_info.fileName().toLatin1().constData()) << file.readAll();
+            }
+        }
+    }
+
+    Q_SLOT void benchmarkLayoutParser()
+    {
+        QFETCH(QByteArray, contents);
+
+        // Parses from memory, to leave out file I/O:
+        bool result(false);
+        QBENCHMARK {
+            QBuffer buffer(&contents);
+            buffer.open(QIODevice::ReadOnly);
+            LayoutParser parser(&buffer);
+            result = parser.parse();
+        }
+
+        QVERIFY(result);
+    }
+
+    Q_SLOT void benchmarkWordBoundaries_data()
+    {
+        QTest::addColumn<int>("length");
+        QTest::addColumn<int>("cursor_position");
+
+        QTest::newRow("1k, in word") << 1024 << 500;
+        QTest::newRow("64k, in word") << 65536 << 32002;
+        QTest::newRow("64k, at end") << 65536 << 65536;
+        QTest::newRow("1M, in word") << 1048576 << 524290;
+    }
+
+    Q_SLOT void benchmarkWordBoundaries()
+    {
+        QFETCH(int, length);
+        QFETCH(int, cursor_position);
+
+        Model::Text text;
+        text.setSurrounding(longText(length));
+        text.setSurroundingOffset(cursor_position);
+
+        Logic::AbstractTextEditor::Replacement replacement;
+        bool result(false);
+        QBENCHMARK {
+            result = Logic::extractWordBoundariesAtCursor(text, &replacement);
+        }
+
+        QVERIFY(result);
+    }
+
+    Q_SLOT void benchmarkKeyCopy()
+    {
+        const KeyArea key_area(styledKeyArea("en_gb", Logic::LayoutHelper::Landscape));
+        const QVector<Key> keys(key_area.keys());
+
+        QVERIFY(not keys.isEmpty());
+
+        Key copy;
+        QBENCHMARK {
+            Q_FOREACH (const Key &key, keys) {
+                copy = key;
+            }
+        }
+
+        QCOMPARE(copy.label().text(), keys.last().label().text());
+    }
+
+    Q_SLOT void benchmarkKeyAreaCopy_data()
+    {
+        QTest::addColumn<bool>("detach");
+
+        QTest::newRow("shared") << false;
+        QTest::newRow("detached") << true;
+    }
+
+    Q_SLOT void benchmarkKeyAreaCopy()
+    {
+        QFETCH(bool, detach);
+
+        const KeyArea key_area(styledKeyArea("en_gb", Logic::LayoutHelper::Landscape));
+
+        QVERIFY(key_area.hasKeys());
+
+        int count(0);
+        QBENCHMARK {
+            KeyArea copy(key_area);
+
+            // Modifying a key forces a deep copy, like EventHandler does
+            // when replacing keys on press:
+            if (detach) {
+                copy.rKeys()[0].setOrigin(QPoint(1, 1));
+            }
+
+            count = copy.keys().count();
+        }
+
+        QCOMPARE(count, key_area.keys().count());
+    }
+
+    Q_SLOT void benchmarkTraceScope_data()
+    {
+        QTest::addColumn<int>("mode");
+
+        // Tracepoints are meant to cost less than 1% of a keystroke, so
+        // compare them against an empty scope. MALIIT_TRACE_SCOPE is empty
+        // too unless built with CONFIG+=enable-tracing:
+        QTest::newRow("empty scope") << static_cast<int>(TraceScopeNone);
+        QTest::newRow("MALIIT_TRACE_SCOPE") << static_cast<int>(TraceScopeMacro);
+        QTest::newRow("tracer disabled") << static_cast<int>(TraceScopeDisabled);
+        QTest::newRow("tracer enabled") << static_cast<int>(TraceScopeEnabled);
+    }
+
+    Q_SLOT void benchmarkTraceScope()
+    {
+        QFETCH(int, mode);
+
+        Tracer::setEnabled(mode == TraceScopeEnabled or mode == TraceScopeMacro);
+        volatile int count(0);
+
+        switch (mode) {
+        case TraceScopeNone:
+            QBENCHMARK {
+                ++count;
+            }
+            break;
+
+        case TraceScopeMacro:
+            QBENCHMARK {
+                MALIIT_TRACE_SCOPE("benchmarkTraceScope");
+                ++count;
+            }
+            break;
+
+        default:
+            QBENCHMARK {
+                const Tracer::Scope scope("benchmarkTraceScope");
+                ++count;
+            }
+            break;
+        }
+
+        Tracer::setEnabled(false);
+        Tracer::clear();
+
+        QVERIFY(count > 0);
+    }
+};
+
+QTEST_MAIN(TestMicrobenchmarks)
+#include "main.moc"
@@ -0,0 +1,122 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "view/pcmfeedback.h"
+#include "view/audiosink.h"
+#include "logic/style.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+// Length of typewriter.wav in the nokia-n9 profile.
+const int ClipFrames = 44032;
+
+bool waitForIdle(const PcmFeedback &feedback,
+                 const FileAudioSink *sink,
+                 int played)
+{
+    for (int attempts = 0; attempts < 500; ++attempts) {
+        if (feedback.playedEffectCount() == played
+            && feedback.activeVoiceCount() == 0
+            && sink->framesWritten() >= ClipFrames) {
+            return true;
+        }
+
+        QTest::qWait(10);
+    }
+
+    return false;
+}
+}
+
+class TestPcmFeedback
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString outputFileName() const
+    {
+        return QDir(QDir::tempPath()).filePath("maliit-keyboard-pcm-feedback-test.raw");
+    }
+
+    Q_SLOT void cleanup()
+    {
+        QFile::remove(outputFileName());
+    }
+
+    Q_SLOT void testOverlappingEffects()
+    {
+        SharedStyle style(new Style);
+        style->setProfile("nokia-n9");
+
+        FileAudioSink *sink(new FileAudioSink(outputFileName()));
+        QScopedPointer<PcmFeedback> feedback(new PcmFeedback(sink));
+        feedback->setStyle(style);
+        QCOMPARE(feedback->dispatchMode(), AbstractFeedback::DispatchFromWorker);
+
+        // The worker would drop the press if it sees the release already:
+        feedback->setDispatchMode(AbstractFeedback::DispatchDirectly);
+
+        // Layout change has no sound in this profile:
+        feedback->onLayoutChanged();
+
+        feedback->onKeyPressed();
+        feedback->onKeyReleased();
+        QVERIFY(waitForIdle(*feedback, sink, 2));
+
+        // Both clicks were mixed into the same stream, not played back to back
+        // with each cutting off the other. Sequential playback would need at
+        // least two full clips:
+        const int frames(sink->framesWritten());
+        QVERIFY(frames >= ClipFrames);
+        QVERIFY2(frames < 2 * ClipFrames,
+                 qPrintable(QString("%1 frames written, clips did not overlap").arg(frames)));
+        QVERIFY(feedback->lastLatencyUsecs() >= 0);
+        QVERIFY(feedback->maxLatencyUsecs() >= feedback->lastLatencyUsecs());
+
+        // Disabled feedback does not reach the mixer:
+        feedback->setEnabled(false);
+        feedback->onKeyPressed();
+        QCOMPARE(feedback->playedEffectCount(), 2);
+
+        // Stops the audio thread, which closes the sink:
+        feedback.reset();
+        QCOMPARE(QFileInfo(outputFileName()).size(),
+                 qint64(frames) * 2 * sizeof(qint16));
+    }
+};
+
+QTEST_MAIN(TestPcmFeedback)
+#include "main.moc"
@@ -212,6 +212,77 @@ private:
         QCOMPARE(host->keyEventCount(), 2);
     }
 
+    /*
+     * testAcceleratedRepeat verifies accelerated auto-repeat:
+     * 1) press backspace key and keep holding it
+     * 2) first repeats delete one character each, through key events
+     * 3) after a while, each repeat deletes several characters, through a
+     *    single commit replacing text left of the cursor
+     * 4) after a longer while, each repeat deletes a whole word
+     */
+    Q_SLOT void testAcceleratedRepeat()
+    {
+        editor->setAutoRepeatAccelerated(true);
+        const QString surrounding(QString("abcd ").repeated(200));
+        editor->text()->setSurrounding(surrounding);
+        editor->text()->setSurroundingOffset(surrounding.length());
+
+        Key backspace;
+        backspace.setAction(Key::ActionBackspace);
+
+        editor->onKeyPressed(backspace);
+
+        QTest::qWait(auto_repeat_delay + 10);
+
+        QCOMPARE(host->keyEventCount(), 1);
+        QCOMPARE(host->lastKeyEvent().key(), int(Qt::Key_Backspace));
+        QCOMPARE(host->commitStringCount(), 0);
+
+        QTest::qWait(1500);
+
+        QVERIFY(host->commitStringCount() > 0);
+        QCOMPARE(host->lastCommitReplaceStart(), -host->lastCommitReplaceLength());
+        QVERIFY(host->lastCommitReplaceLength() > 1);
+
+        QTest::qWait(1500);
+
+        // Each repeat deletes a word together with the space after it:
+        QCOMPARE(host->lastCommitReplaceLength(), 5);
+
+        editor->onKeyReleased(backspace);
+        const int commit_string_count(host->commitStringCount());
+
+        QTest::qWait(delay);
+
+        QCOMPARE(host->commitStringCount(), commit_string_count);
+        QCOMPARE(editor->text()->surroundingLength(),
+                 static_cast<int>(editor->text()->surroundingOffset()));
+        QVERIFY(editor->text()->surroundingLength() < surrounding.length());
+    }
+
+    /*
+     * testAcceleratedRepeatWithoutSurroundingText verifies that hosts which
+     * do not report surrounding text, like terminals, keep getting one key
+     * event per repeat, even when auto-repeat is accelerated.
+     */
+    Q_SLOT void testAcceleratedRepeatWithoutSurroundingText()
+    {
+        editor->setAutoRepeatAccelerated(true);
+
+        Key backspace;
+        backspace.setAction(Key::ActionBackspace);
+
+        editor->onKeyPressed(backspace);
+
+        QTest::qWait(1500);
+
+        editor->onKeyReleased(backspace);
+
+        QVERIFY(host->keyEventCount() > 1);
+        QCOMPARE(host->lastKeyEvent().key(), int(Qt::Key_Backspace));
+        QCOMPARE(host->commitStringCount(), 0);
+    }
+
 };
 
 QTEST_MAIN(TestRepeatBackspace)
@@ -0,0 +1,145 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "logic/sessionrecorder.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+class TestSessionRecorder
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString traceFileName() const
+    {
+        return QDir(QDir::tempPath()).filePath("maliit-keyboard-session-recorder-test.trace");
+    }
+
+    Q_SLOT void cleanup()
+    {
+        QFile::remove(traceFileName());
+    }
+
+    Q_SLOT void testRoundTrip()
+    {
+        Logic::SessionRecorder recorder;
+
+        // Nothing gets recorded before start:
+        recorder.recordKeyEvent(Logic::SessionRecorder::EventPressed, 1);
+        QVERIFY(not recorder.isRecording());
+
+        QVERIFY(recorder.start(traceFileName()));
+        QVERIFY(recorder.isRecording());
+
+        recorder.recordScreenSizeChanged(QSize(480, 854));
+        recorder.recordKeyboardChanged("de");
+        recorder.recordOrientationChanged(1);
+        recorder.recordKeyEvent(Logic::SessionRecorder::EventPressed, 12);
+        recorder.recordMoved(12, 5, -3);
+        QTest::qWait(20);
+        recorder.recordKeyEvent(Logic::SessionRecorder::EventReleased, 12);
+        recorder.recordCursorPositionChanged(4, QString::fromUtf8("Grüße, 2 Leute."));
+        recorder.recordGestureTypingChanged(true);
+        recorder.stop();
+
+        QVector<Logic::SessionRecorder::Event> events;
+        QVERIFY(Logic::SessionRecorder::readTrace(traceFileName(), &events));
+        QCOMPARE(events.count(), 8);
+
+        QCOMPARE(events.at(0).type, Logic::SessionRecorder::EventScreenSizeChanged);
+        QCOMPARE(events.at(0).position, QPoint(480, 854));
+        QCOMPARE(events.at(1).type, Logic::SessionRecorder::EventKeyboardChanged);
+        QCOMPARE(events.at(1).text, QString("de"));
+        QCOMPARE(events.at(2).type, Logic::SessionRecorder::EventOrientationChanged);
+        QCOMPARE(events.at(2).index, 1);
+        QCOMPARE(events.at(3).type, Logic::SessionRecorder::EventPressed);
+        QCOMPARE(events.at(3).index, 12);
+        QCOMPARE(events.at(4).type, Logic::SessionRecorder::EventMoved);
+        QCOMPARE(events.at(4).position, QPoint(5, -3));
+        QCOMPARE(events.at(5).type, Logic::SessionRecorder::EventReleased);
+        QVERIFY(events.at(5).time - events.at(4).time >= 15);
+        QCOMPARE(events.at(6).type, Logic::SessionRecorder::EventCursorPositionChanged);
+        QCOMPARE(events.at(6).index, 4);
+        QCOMPARE(events.at(6).text, QString("aaaaa, 0 aaaaa."));
+        QCOMPARE(events.at(7).type, Logic::SessionRecorder::EventGestureTypingChanged);
+        QCOMPARE(events.at(7).index, 1);
+    }
+
+    Q_SLOT void testSurroundingTextNotRecorded()
+    {
+        const QString password("hunter2-secret");
+
+        Logic::SessionRecorder recorder;
+        QVERIFY(recorder.start(traceFileName()));
+        recorder.recordCursorPositionChanged(password.length(), password);
+        recorder.stop();
+
+        QFile file(traceFileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray trace(file.readAll());
+        QVERIFY(not trace.contains(password.toUtf8()));
+        QVERIFY(not trace.contains(password.toLatin1()));
+        QVERIFY(not trace.contains("hunter2"));
+
+        QVector<Logic::SessionRecorder::Event> events;
+        QVERIFY(Logic::SessionRecorder::readTrace(traceFileName(), &events));
+        QCOMPARE(events.count(), 1);
+        QCOMPARE(events.at(0).index, password.length());
+        QCOMPARE(events.at(0).text, QString("aaaaaa0-aaaaaa"));
+    }
+
+    Q_SLOT void testTruncatedTrace()
+    {
+        Logic::SessionRecorder recorder;
+        QVERIFY(recorder.start(traceFileName()));
+        recorder.recordKeyEvent(Logic::SessionRecorder::EventPressed, 3);
+        recorder.recordCursorPositionChanged(10, "some surrounding text");
+        recorder.stop();
+
+        QFile file(traceFileName());
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.resize(file.size() - 4));
+        file.close();
+
+        // Events before the damage are still available:
+        QVector<Logic::SessionRecorder::Event> events;
+        QVERIFY(not Logic::SessionRecorder::readTrace(traceFileName(), &events));
+        QCOMPARE(events.count(), 1);
+        QCOMPARE(events.at(0).index, 3);
+    }
+};
+
+QTEST_MAIN(TestSessionRecorder)
+#include "main.moc"
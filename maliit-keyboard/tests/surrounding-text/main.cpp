@@ -0,0 +1,183 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "models/text.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+class TestSurroundingText
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void testReplaceSurrounding_data()
+    {
+        QTest::addColumn<QString>("surrounding");
+        QTest::addColumn<int>("offset");
+        QTest::addColumn<int>("position");
+        QTest::addColumn<int>("length");
+        QTest::addColumn<QString>("replacement");
+        QTest::addColumn<QString>("expected_surrounding");
+        QTest::addColumn<int>("expected_offset");
+
+        QTest::newRow("insert at cursor")
+            << "aaa bbb" << 4 << 4 << 0 << "ccc " << "aaa ccc bbb" << 8;
+        QTest::newRow("remove word before cursor")
+            << "aaa bbb ccc" << 11 << 4 << 4 << "" << "aaa ccc" << 7;
+        QTest::newRow("replace word with cursor inside")
+            << "aaa bbb ccc" << 5 << 4 << 3 << "dddd" << "aaa dddd ccc" << 8;
+        QTest::newRow("edit behind cursor")
+            << "aaa bbb" << 1 << 4 << 3 << "c" << "aaa c" << 1;
+        QTest::newRow("clipped")
+            << "aaa" << 3 << 2 << 10 << "b" << "aab" << 3;
+    }
+
+    Q_SLOT void testReplaceSurrounding()
+    {
+        QFETCH(QString, surrounding);
+        QFETCH(int, offset);
+        QFETCH(int, position);
+        QFETCH(int, length);
+        QFETCH(QString, replacement);
+        QFETCH(QString, expected_surrounding);
+        QFETCH(int, expected_offset);
+
+        Model::Text text;
+        text.setSurrounding(surrounding);
+        text.setSurroundingOffset(offset);
+        text.replaceSurrounding(position, length, replacement);
+
+        QCOMPARE(text.surrounding(), expected_surrounding);
+        QCOMPARE(text.surroundingLength(), expected_surrounding.length());
+        QCOMPARE(static_cast<int>(text.surroundingOffset()), expected_offset);
+        QCOMPARE(text.surroundingLeft(), expected_surrounding.left(expected_offset));
+        QCOMPARE(text.surroundingRight(), expected_surrounding.mid(expected_offset));
+
+        for (int index = 0; index < expected_surrounding.length(); ++index) {
+            QCOMPARE(text.surroundingAt(index), expected_surrounding.at(index));
+        }
+    }
+
+    Q_SLOT void testSequentialEdits()
+    {
+        Model::Text text;
+        QString expected;
+
+        // Moves the gap back and forth and makes it grow:
+        for (int round = 0; round < 100; ++round) {
+            const int position((round * 7) % (expected.length() + 1));
+            const QString word(QString("w%1 ").arg(round));
+
+            text.replaceSurrounding(position, 2, word);
+            expected.replace(position, 2, word);
+
+            QCOMPARE(text.surrounding(), expected);
+        }
+
+        QCOMPARE(text.surroundingMid(10, 20), expected.mid(10, 20));
+        QCOMPARE(text.surroundingMid(-5, 10), expected.left(5));
+    }
+
+    Q_SLOT void testCommitPreedit()
+    {
+        Model::Text text;
+        text.setSurrounding("Hello  world");
+        text.setSurroundingOffset(6);
+        text.setPreedit("dear");
+        text.commitPreedit();
+
+        QCOMPARE(text.surrounding(), QString("Hello dear world"));
+        QCOMPARE(text.surroundingLeft(), QString("Hello dear"));
+        QVERIFY(text.preedit().isEmpty());
+    }
+
+    Q_SLOT void testLargeDocument()
+    {
+        const int length(1024 * 1024);
+        const int cursor(length / 2);
+        const int edits(10000);
+
+        QString document(length, QChar('a'));
+        Model::Text text;
+        text.setSurroundingOffset(cursor);
+        text.setSurrounding(document);
+        QCOMPARE(text.surroundingLength(), length);
+
+        // Host updates echoing the model's own edits, each followed by a
+        // commit at the cursor, must not copy the document again:
+        qint64 copied(text.copiedCharacters());
+
+        for (int round = 0; round < 3; ++round) {
+            text.setSurrounding(document);
+            text.setPreedit("b");
+            text.commitPreedit();
+            document.insert(cursor + round, QChar('b'));
+            text.setSurroundingOffset(cursor + round + 1);
+
+            QCOMPARE(text.surroundingLength(), document.length());
+            QCOMPARE(text.surroundingMid(cursor - 2, round + 4), document.mid(cursor - 2, round + 4));
+        }
+
+        QVERIFY2(text.copiedCharacters() - copied < 100,
+                 qPrintable(QString("Host updates copied %1 characters").arg(text.copiedCharacters() - copied)));
+
+        // Edits next to the cursor must not touch the rest of the document:
+        copied = text.copiedCharacters();
+
+        for (int edit = 0; edit < edits; ++edit) {
+            text.setPreedit("c");
+            text.commitPreedit();
+        }
+
+        QVERIFY2(text.copiedCharacters() - copied < 2 * edits,
+                 qPrintable(QString("%1 edits copied %2 characters").arg(edits).arg(text.copiedCharacters() - copied)));
+
+        document.insert(cursor + 3, QString(edits, QChar('c')));
+        QCOMPARE(text.surroundingLength(), document.length());
+        QCOMPARE(text.surrounding(), document);
+
+        // Host side changes elsewhere only copy the changed part:
+        copied = text.copiedCharacters();
+        document.replace(cursor + edits, 3, QString("xyzw"));
+        text.setSurrounding(document);
+
+        QCOMPARE(text.surrounding(), document);
+        QCOMPARE(text.surroundingOffset(), uint(cursor + 3 + edits));
+        QVERIFY(text.copiedCharacters() - copied < 100);
+    }
+};
+
+QTEST_MAIN(TestSurroundingText)
+#include "main.moc"
@@ -7,6 +7,15 @@ SUBDIRS = \
     repeat-backspace \
     word-candidates \
     language-layout-loading \
+    gesture-decoder \
+    surrounding-text \
+    session-recorder \
+    pcm-feedback \
+    feedback-dispatch \
+    tracer \
+    microbenchmarks \
+    allocation-budget \
+    word-engine \
 
 CONFIG += ordered
 QMAKE_EXTRA_TARGETS += check
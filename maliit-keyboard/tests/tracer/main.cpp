@@ -0,0 +1,151 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "tracer.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+class TracingThread
+    : public QThread
+{
+protected:
+    void run()
+    {
+        const Tracer::Scope scope("worker-scope");
+        Tracer::recordInstant("worker-instant");
+    }
+};
+
+}
+
+class TestTracer
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString traceFileName() const
+    {
+        return QDir(QDir::tempPath()).filePath("maliit-keyboard-tracer-test.json");
+    }
+
+    Q_SLOT void init()
+    {
+        Tracer::setEnabled(false);
+        Tracer::clear();
+    }
+
+    Q_SLOT void cleanup()
+    {
+        QFile::remove(traceFileName());
+    }
+
+    Q_SLOT void testDisabled()
+    {
+        {
+            const Tracer::Scope scope("disabled-scope");
+        }
+        Tracer::recordInstant("disabled-instant");
+
+        QCOMPARE(Tracer::eventCount(), 0);
+    }
+
+    Q_SLOT void testRecording()
+    {
+        Tracer::setEnabled(true);
+        QVERIFY(Tracer::isEnabled());
+
+        {
+            const Tracer::Scope scope("main-scope");
+        }
+        Tracer::recordInstant("main-instant");
+
+        TracingThread thread;
+        thread.start();
+        QVERIFY(thread.wait(5000));
+
+        Tracer::setEnabled(false);
+        QCOMPARE(Tracer::eventCount(), 4);
+
+        QVERIFY(Tracer::writeChromeTrace(traceFileName()));
+
+        QFile file(traceFileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray trace(file.readAll());
+
+        QVERIFY(trace.contains("\"traceEvents\""));
+        QVERIFY(trace.contains("\"main-scope\""));
+        QVERIFY(trace.contains("\"main-instant\""));
+        QVERIFY(trace.contains("\"worker-scope\""));
+        QVERIFY(trace.contains("\"worker-instant\""));
+
+        Tracer::clear();
+        QCOMPARE(Tracer::eventCount(), 0);
+    }
+
+    Q_SLOT void testThreadBufferReuse()
+    {
+        Tracer::setEnabled(true);
+
+        // Like a thread pool replacing expired threads:
+        for (int round = 0; round < 20; ++round) {
+            TracingThread thread;
+            thread.start();
+            QVERIFY(thread.wait(5000));
+        }
+
+        const int buffer_count(Tracer::bufferCount());
+
+        for (int round = 0; round < 20; ++round) {
+            TracingThread thread;
+            thread.start();
+            QVERIFY(thread.wait(5000));
+        }
+
+        Tracer::setEnabled(false);
+        QCOMPARE(Tracer::bufferCount(), buffer_count);
+
+        // Events of the last exited thread are still there for dumps:
+        QVERIFY(Tracer::writeChromeTrace(traceFileName()));
+
+        QFile file(traceFileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QVERIFY(file.readAll().contains("\"worker-instant\""));
+    }
+};
+
+QTEST_MAIN(TestTracer)
+#include "main.moc"
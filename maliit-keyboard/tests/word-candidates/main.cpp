@@ -36,6 +36,7 @@
 #include "plugin/editor.h"
 #include "models/key.h"
 #include "models/text.h"
+#include "models/ribbon.h"
 #include "logic/languagefeatures.h"
 #include "logic/layouthelper.h"
 #include "logic/layoutupdater.h"
@@ -237,6 +238,85 @@ private:
         QCOMPARE(updater.isWordRibbonVisible(), false);
         QCOMPARE(layout.wordRibbon().candidates().isEmpty(), true);
     }
+
+    Q_SLOT void testWordRibbonModel()
+    {
+        Editor editor(new Model::Text, new Logic::WordEngineProbe, new Logic::LanguageFeatures);
+        InputMethodHostProbe host;
+        editor.setHost(&host);
+
+        Logic::LayoutUpdater updater;
+        Logic::LayoutHelper layout;
+        updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        style->setProfile("nokia-n9");
+        updater.setStyle(style);
+
+        Model::Ribbon ribbon;
+        QObject::connect(&layout, SIGNAL(wordRibbonChanged(WordRibbon)),
+                         &ribbon, SLOT(setWordRibbon(WordRibbon)));
+        QObject::connect(&layout, SIGNAL(wordCandidateCountChanged(int)),
+                         &ribbon, SLOT(setCandidateCount(int)));
+        QObject::connect(&layout, SIGNAL(wordCandidateChanged(int,WordCandidate)),
+                         &ribbon, SLOT(setCandidate(int,WordCandidate)));
+
+        Logic::connectLayoutUpdaterToTextEditor(&updater, &editor);
+        editor.wordEngine()->setEnabled(true);
+        QCOMPARE(ribbon.height(), 40);
+        QCOMPARE(ribbon.isVisible(), false);
+
+        appendToPreedit(&editor, "a");
+        QVERIFY(ribbon.rowCount() > 0);
+        QCOMPARE(ribbon.rowCount(), layout.wordCandidateCount());
+        QCOMPARE(ribbon.isVisible(), true);
+        QCOMPARE(ribbon.data(0, "candidate_text").toString(), QString("a"));
+
+        // Further keystrokes update the existing slots in place:
+        const int row_count(ribbon.rowCount());
+        QSignalSpy reset_spy(&ribbon, SIGNAL(modelReset()));
+        QSignalSpy insert_spy(&ribbon, SIGNAL(rowsInserted(QModelIndex,int,int)));
+        QSignalSpy remove_spy(&ribbon, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+        QSignalSpy data_spy(&ribbon, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+        appendToPreedit(&editor, "bc");
+        QCOMPARE(ribbon.rowCount(), row_count);
+        QCOMPARE(ribbon.data(0, "candidate_text").toString(), QString("cba"));
+        QVERIFY(data_spy.count() > 0);
+        QCOMPARE(reset_spy.count(), 0);
+        QCOMPARE(insert_spy.count(), 0);
+        QCOMPARE(remove_spy.count(), 0);
+
+        // Same candidates again leave all slots alone:
+        data_spy.clear();
+        updater.onWordCandidatesChanged(layout.wordRibbon().candidates().toList());
+        QCOMPARE(data_spy.count(), 0);
+
+        // Pressing highlights by index, touching one row only:
+        QSignalSpy selected_spy(&updater, SIGNAL(wordCandidateSelected(QString)));
+        data_spy.clear();
+        updater.onWordCandidatePressed(0);
+        QCOMPARE(data_spy.count(), 1);
+        QCOMPARE(data_spy.first().first().value<QModelIndex>().row(), 0);
+        QCOMPARE(ribbon.data(0, "candidate_font_color").toString(), QString("#fff"));
+
+        // Selecting commits the candidate, which updates the ribbon again:
+        updater.onWordCandidateReleased(0);
+        QVERIFY(data_spy.count() >= 2);
+        QCOMPARE(data_spy.at(1).first().value<QModelIndex>().row(), 0);
+        QCOMPARE(selected_spy.count(), 1);
+        QCOMPARE(selected_spy.first().first().toString(), QString("cba"));
+
+        // Invalid slots are ignored:
+        data_spy.clear();
+        updater.onWordCandidatePressed(ribbon.rowCount());
+        QCOMPARE(data_spy.count(), 0);
+
+        editor.wordEngine()->setEnabled(false);
+        QCOMPARE(ribbon.rowCount(), 0);
+        QCOMPARE(ribbon.isVisible(), false);
+        QCOMPARE(reset_spy.count(), 0);
+    }
 };
 
 QTEST_MAIN(TestWordCandidates)
@@ -0,0 +1,246 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "utils.h"
+#include "logic/wordengine.h"
+#include "logic/candidatefusion.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+Q_DECLARE_METATYPE(WordCandidateList)
+
+namespace {
+
+// Answers with a fixed list of words, after a delay.
+class FakeJob
+    : public Logic::CandidateFusion::Job
+{
+public:
+    explicit FakeJob(const QStringList &words,
+                     int delay = 0,
+                     bool misspelled = false)
+        : Logic::CandidateFusion::Job()
+        , m_words(words)
+        , m_delay(delay)
+        , m_misspelled(misspelled)
+    {}
+
+private:
+    QStringList run(bool *misspelled)
+    {
+        if (m_delay > 0) {
+            QTest::qSleep(m_delay);
+        }
+
+        *misspelled = m_misspelled;
+        return m_words;
+    }
+
+    const QStringList m_words;
+    const int m_delay;
+    const bool m_misspelled;
+};
+
+QStringList fusedWords(const QList<Logic::CandidateFusion::Candidate> &candidates)
+{
+    QStringList words;
+
+    Q_FOREACH (const Logic::CandidateFusion::Candidate &candidate, candidates) {
+        words.append(candidate.word);
+    }
+
+    return words;
+}
+
+} // unnamed namespace
+
+class TestWordEngine
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase()
+    {
+        QVERIFY(qputenv("MALIIT_KEYBOARD_HUNSPELL_DICT_PATH", TEST_DATADIR "/dictionaries"));
+        qRegisterMetaType<WordCandidateList>("WordCandidateList");
+    }
+
+    Q_SLOT void testDictionaryCache()
+    {
+        Logic::WordEngine engine;
+        QSignalSpy loaded(&engine, SIGNAL(dictionaryLoaded(QString)));
+
+        // The default dictionary is available right away:
+        QCOMPARE(engine.loadedLanguages(), QStringList() << "en_gb");
+
+        engine.setLanguage("de");
+        QCOMPARE(engine.loadedLanguages(), QStringList() << "en_gb");
+        TestUtils::waitForSignal(&engine, SIGNAL(dictionaryLoaded(QString)));
+        QCOMPARE(loaded.count(), 1);
+        QCOMPARE(engine.loadedLanguages(), QStringList() << "de" << "en_gb");
+
+        // Switching back and forth does not load again:
+        engine.setLanguage("en_gb");
+        QCOMPARE(engine.loadedLanguages(), QStringList() << "en_gb" << "de");
+        engine.setLanguage("de");
+        QCOMPARE(engine.loadedLanguages(), QStringList() << "de" << "en_gb");
+        QCOMPARE(loaded.count(), 1);
+
+        // Failed loads are not cached, but tried again next time:
+        engine.setLanguage("xx");
+        TestUtils::waitForSignal(&engine, SIGNAL(dictionaryLoaded(QString)));
+        QCOMPARE(loaded.count(), 2);
+        QCOMPARE(engine.loadedLanguages(), QStringList() << "de" << "en_gb");
+
+        engine.setLanguage("de");
+        engine.setLanguage("xx");
+        TestUtils::waitForSignal(&engine, SIGNAL(dictionaryLoaded(QString)));
+        QCOMPARE(loaded.count(), 3);
+
+        // The least recently used dictionary gets dropped:
+        engine.setLanguage("fr");
+        TestUtils::waitForSignal(&engine, SIGNAL(dictionaryLoaded(QString)));
+        QCOMPARE(engine.loadedLanguages(), QStringList() << "fr" << "de" << "en_gb");
+
+        engine.setLanguage("ru");
+        TestUtils::waitForSignal(&engine, SIGNAL(dictionaryLoaded(QString)));
+        QCOMPARE(engine.loadedLanguages(), QStringList() << "ru" << "fr" << "de");
+        QCOMPARE(loaded.count(), 5);
+    }
+
+#ifdef HAVE_PRESAGE
+    Q_SLOT void testNextWordCache()
+    {
+        Logic::WordEngine engine;
+        engine.setEnabled(true);
+        engine.setNextWordPredictionEnabled(true);
+        QSignalSpy candidates(&engine, SIGNAL(candidatesChanged(WordCandidateList)));
+
+        Model::Text text;
+        text.setSurrounding("Hello world ");
+        text.setSurroundingOffset(12);
+
+        const qint64 usage_without_cache(engine.memoryUsage());
+
+        // Nothing cached yet, Presage runs in the background:
+        engine.computeNextWordCandidates(&text);
+        QCOMPARE(candidates.count(), 0);
+
+        for (int wait = 0; wait < 100 && engine.memoryUsage() == usage_without_cache; ++wait) {
+            QTest::qWait(10);
+        }
+
+        QVERIFY(engine.memoryUsage() > usage_without_cache);
+        const int predicted(candidates.count());
+
+        // Cached now, so candidates are shown right away:
+        engine.computeNextWordCandidates(&text);
+        QCOMPARE(candidates.count(), 2 * predicted);
+
+        // Predictions for another language are not reused:
+        engine.setLanguage("xx");
+        QCOMPARE(engine.memoryUsage(), usage_without_cache);
+
+        candidates.clear();
+        engine.computeNextWordCandidates(&text);
+        QCOMPARE(candidates.count(), 0);
+    }
+#endif
+
+    Q_SLOT void testFusion()
+    {
+        Logic::CandidateFusion fusion(1000);
+        bool misspelled = false;
+
+        fusion.begin("hel");
+        QVERIFY(fusion.start(Logic::CandidateFusion::BackendPresage,
+                             new FakeJob(QStringList() << "hello" << "help")));
+        QVERIFY(fusion.start(Logic::CandidateFusion::BackendSpellChecker,
+                             new FakeJob(QStringList() << "help" << "held", 0, true)));
+        QVERIFY(fusion.start(Logic::CandidateFusion::BackendUserDictionary,
+                             new FakeJob(QStringList() << "helpful")));
+
+        const QList<Logic::CandidateFusion::Candidate> candidates(fusion.finish(&misspelled));
+
+        // Words suggested by several backends accumulate their scores:
+        QCOMPARE(fusedWords(candidates), QStringList() << "help" << "helpful" << "hello" << "held");
+        QCOMPARE(candidates.at(0).source, WordCandidate::SourceSpellChecking);
+        QCOMPARE(candidates.at(1).source, WordCandidate::SourceUserDictionary);
+        QCOMPARE(candidates.at(2).source, WordCandidate::SourcePrediction);
+        QVERIFY(misspelled);
+    }
+
+    Q_SLOT void testTimeBudget()
+    {
+        const int budget = 20;
+        const int slow = 200;
+        Logic::CandidateFusion fusion(budget);
+        QElapsedTimer timer;
+
+        timer.start();
+        fusion.begin("he");
+        fusion.start(Logic::CandidateFusion::BackendUserDictionary, new FakeJob(QStringList() << "fast"));
+        fusion.start(Logic::CandidateFusion::BackendPresage, new FakeJob(QStringList() << "slow", slow));
+
+        QCOMPARE(fusedWords(fusion.finish()), QStringList() << "fast");
+        QVERIFY(timer.elapsed() < slow);
+
+        // The slow backend is still busy, so it gets skipped:
+        fusion.begin("hel");
+        fusion.start(Logic::CandidateFusion::BackendUserDictionary, new FakeJob(QStringList() << "fast"));
+        QVERIFY(not fusion.start(Logic::CandidateFusion::BackendPresage,
+                                 new FakeJob(QStringList() << "slow", slow)));
+        QCOMPARE(fusedWords(fusion.finish()), QStringList() << "fast");
+
+        fusion.waitForDone();
+
+        // Once done, its late result is used for the next keystroke of the
+        // same word, while it works on the current one:
+        fusion.begin("hell");
+        fusion.start(Logic::CandidateFusion::BackendUserDictionary, new FakeJob(QStringList() << "fast"));
+        QVERIFY(fusion.start(Logic::CandidateFusion::BackendPresage,
+                             new FakeJob(QStringList() << "slower", slow)));
+        QCOMPARE(fusedWords(fusion.finish()), QStringList() << "fast" << "slow");
+
+        // ... but not for another word:
+        fusion.begin("wo");
+        fusion.start(Logic::CandidateFusion::BackendUserDictionary, new FakeJob(QStringList() << "fast"));
+        fusion.start(Logic::CandidateFusion::BackendPresage, new FakeJob(QStringList() << "slow", slow));
+        QCOMPARE(fusedWords(fusion.finish()), QStringList() << "fast");
+    }
+};
+
+QTEST_MAIN(TestWordEngine)
+#include "main.moc"
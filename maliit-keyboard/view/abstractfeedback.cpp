@@ -31,6 +31,7 @@
  */
 
 #include "abstractfeedback.h"
+#include "spscqueue.h"
 
 namespace MaliitKeyboard
 {
@@ -43,6 +44,13 @@ namespace MaliitKeyboard
 //! functionality. They need to implement (but never call) the private
 //! virtual playSomething methods. A setStyle() method has to be
 //! implemented as well.
+//!
+//! With DispatchFromWorker, the onSomething slots only enqueue the effect
+//! together with a timestamp, and the playSomething methods get called
+//! from a worker thread. Backends that are slow to start their effects
+//! then no longer delay the visual response to a key press. Effects that
+//! became stale while waiting in the queue are dropped, see
+//! droppedEffectCount().
 
 //! \fn AbstractFeedback::setStyle
 //! \brief Sets the shared Style instance.
@@ -72,29 +80,219 @@ namespace MaliitKeyboard
 //! \param enabled Whether feedback provider is enabled.
 //! \sa AbstractFeedback::enabled
 
+namespace {
+
+enum Effect
+{
+    PressEffect,
+    ReleaseEffect,
+    LayoutChangeEffect,
+    KeyboardHideEffect
+};
+
+struct QueuedEffect
+{
+    Effect effect;
+    qint64 timestamp; //!< Microseconds, from AbstractFeedbackPrivate::clock.
+};
+
+const int QueueCapacity = 64;
+// Feedback reaching the user later than this feels detached from the touch:
+const qint64 StaleEffectUsecs = 100000;
+
+typedef SpscQueue<QueuedEffect, QueueCapacity> EffectQueue;
+
+}
+
+class FeedbackWorker;
+
 class AbstractFeedbackPrivate
 {
 public:
-    AbstractFeedbackPrivate();
-
+    AbstractFeedback *const q_ptr;
     bool enabled;
+    AbstractFeedback::DispatchMode mode;
+    QElapsedTimer clock;
+    EffectQueue queue;
+    QScopedPointer<FeedbackWorker> worker;
+    QSemaphore wake;
+    QAtomicInt sleeping; //!< Whether the worker waits, or is about to wait, for wake.
+    QAtomicInt quit;
+    QAtomicInt dropped;
+
+    explicit AbstractFeedbackPrivate(AbstractFeedback *q);
+
+    void trigger(Effect effect);
+    void play(Effect effect);
+    void runWorker();
+    void stopWorker();
 };
 
-AbstractFeedbackPrivate::AbstractFeedbackPrivate()
-    : enabled(false)
-{}
+class FeedbackWorker
+    : public QThread
+{
+public:
+    explicit FeedbackWorker(AbstractFeedbackPrivate *d)
+        : QThread()
+        , m_d(d)
+    {}
+
+protected:
+    virtual void run()
+    {
+        m_d->runWorker();
+    }
+
+private:
+    AbstractFeedbackPrivate *const m_d;
+};
+
+namespace {
+
+//! A press that was already followed by its release would click after
+//! the finger has left the key, so only the release gets played.
+bool isStale(const QueuedEffect *batch,
+             int count,
+             int index,
+             qint64 now)
+{
+    if (now - batch[index].timestamp > StaleEffectUsecs) {
+        return true;
+    }
+
+    if (batch[index].effect == PressEffect) {
+        for (int later = index + 1; later < count; ++later) {
+            if (batch[later].effect == ReleaseEffect) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+}
+
+AbstractFeedbackPrivate::AbstractFeedbackPrivate(AbstractFeedback *q)
+    : q_ptr(q)
+    , enabled(false)
+    , mode(AbstractFeedback::DispatchDirectly)
+    , clock()
+    , queue()
+    , worker()
+    , wake()
+    , sleeping(0)
+    , quit(0)
+    , dropped(0)
+{
+    clock.start();
+}
+
+//! Only touches the queue and the sleeping flag when dispatching from
+//! the worker; never blocks.
+void AbstractFeedbackPrivate::trigger(Effect effect)
+{
+    if (mode == AbstractFeedback::DispatchDirectly) {
+        play(effect);
+        return;
+    }
+
+    const QueuedEffect queued = { effect, clock.nsecsElapsed() / 1000 };
+
+    if (not queue.push(queued)) {
+        dropped.ref();
+        return;
+    }
+
+    if (sleeping.testAndSetOrdered(1, 0)) {
+        wake.release();
+    }
+}
+
+void AbstractFeedbackPrivate::play(Effect effect)
+{
+    switch (effect) {
+    case PressEffect: q_ptr->playPressFeedback(); break;
+    case ReleaseEffect: q_ptr->playReleaseFeedback(); break;
+    case LayoutChangeEffect: q_ptr->playLayoutChangeFeedback(); break;
+    case KeyboardHideEffect: q_ptr->playKeyboardHideFeedback(); break;
+    }
+}
+
+void AbstractFeedbackPrivate::runWorker()
+{
+    QueuedEffect batch[QueueCapacity];
+
+    Q_FOREVER {
+        if (quit.loadAcquire()) {
+            break;
+        }
+
+        int count = 0;
+        while (count < QueueCapacity && queue.pop(&batch[count])) {
+            ++count;
+        }
+
+        const qint64 now(clock.nsecsElapsed() / 1000);
+
+        for (int index = 0; index < count; ++index) {
+            if (isStale(batch, count, index, now)) {
+                dropped.ref();
+            } else {
+                play(batch[index].effect);
+            }
+        }
+
+        // Whoever resets the sleeping flag first decides whether the
+        // semaphore gets released, so that no wake up can get lost:
+        sleeping.fetchAndStoreOrdered(1);
+
+        if ((not queue.isEmpty() || quit.loadAcquire())
+            && sleeping.testAndSetOrdered(1, 0)) {
+            continue;
+        }
+
+        wake.acquire();
+    }
+}
+
+//! Joins the worker. Effects still queued are dropped.
+void AbstractFeedbackPrivate::stopWorker()
+{
+    if (worker.isNull()) {
+        return;
+    }
+
+    quit.storeRelease(1);
+
+    if (sleeping.testAndSetOrdered(1, 0)) {
+        wake.release();
+    }
+
+    worker->wait();
+    worker.reset();
+    quit.storeRelease(0);
+
+    QueuedEffect queued;
+    while (queue.pop(&queued)) {
+        dropped.ref();
+    }
+}
 
 //! \brief Constructor.
 //! \param parent The owner of this instance. Can be 0, in case QObject
 //!               ownership is not required.
 AbstractFeedback::AbstractFeedback(QObject *parent)
     : QObject(parent)
-    , d_ptr(new AbstractFeedbackPrivate)
+    , d_ptr(new AbstractFeedbackPrivate(this))
 {}
 
 //! \brief Destructor.
 AbstractFeedback::~AbstractFeedback()
-{}
+{
+    Q_D(AbstractFeedback);
+    d->stopWorker();
+}
 
 //! \brief Set whether the feedback provider is enabled.
 //! \param enabled Whether to enable feedback provider.
@@ -120,43 +318,85 @@ bool AbstractFeedback::isEnabled() const
     return d->enabled;
 }
 
-//! \brief Triggers feedback by calling playPressFeedback().
+//! \brief Sets the thread the playSomething methods get called from.
+//! \param mode The new dispatch mode. Default is DispatchDirectly.
+//!
+//! Only use DispatchFromWorker if the playSomething methods of the
+//! derived class are thread-safe. Such a class has to switch back to
+//! DispatchDirectly in its destructor, as the worker could otherwise
+//! call into a partially destroyed instance.
+void AbstractFeedback::setDispatchMode(DispatchMode mode)
+{
+    Q_D(AbstractFeedback);
+
+    if (d->mode == mode) {
+        return;
+    }
+
+    d->mode = mode;
+
+    if (mode == DispatchFromWorker) {
+        d->worker.reset(new FeedbackWorker(d));
+        d->worker->start(QThread::HighPriority);
+    } else {
+        d->stopWorker();
+    }
+}
+
+//! \brief Returns the thread the playSomething methods get called from.
+AbstractFeedback::DispatchMode AbstractFeedback::dispatchMode() const
+{
+    Q_D(const AbstractFeedback);
+
+    return d->mode;
+}
+
+//! \brief Returns the number of effects that were never played, either
+//! because they became stale or because the queue was full.
+int AbstractFeedback::droppedEffectCount() const
+{
+    Q_D(const AbstractFeedback);
+
+    return d->dropped.load();
+}
+
+//! \brief Triggers feedback, which calls playPressFeedback().
 void AbstractFeedback::onKeyPressed()
 {
     Q_D(AbstractFeedback);
 
     if (d->enabled) {
-        playPressFeedback();
+        d->trigger(PressEffect);
     }
 }
 
-//! \brief Triggers feedback by calling playReleaseFeedback().
+//! \brief Triggers feedback, which calls playReleaseFeedback().
 void AbstractFeedback::onKeyReleased()
 {
     Q_D(AbstractFeedback);
 
     if (d->enabled) {
-        playReleaseFeedback();
+        d->trigger(ReleaseEffect);
     }
 }
 
-//! \brief Triggers feedback by calling playLayoutChangeFeedback().
+//! \brief Triggers feedback, which calls playLayoutChangeFeedback().
 void AbstractFeedback::onLayoutChanged()
 {
     Q_D(AbstractFeedback);
 
     if (d->enabled) {
-        playLayoutChangeFeedback();
+        d->trigger(LayoutChangeEffect);
     }
 }
 
-//! \brief Triggers feedback by calling playKeyboardHideFeedback().
+//! \brief Triggers feedback, which calls playKeyboardHideFeedback().
 void AbstractFeedback::onKeyboardHidden()
 {
     Q_D(AbstractFeedback);
 
     if (d->enabled) {
-        playKeyboardHideFeedback();
+        d->trigger(KeyboardHideEffect);
     }
 }
 
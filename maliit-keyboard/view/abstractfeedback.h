@@ -51,6 +51,11 @@ class AbstractFeedback
                             NOTIFY enabledChanged)
 
 public:
+    enum DispatchMode {
+        DispatchDirectly, //!< Plays feedback from the calling thread.
+        DispatchFromWorker //!< Plays feedback from a worker thread.
+    };
+
     explicit AbstractFeedback(QObject *parent = 0);
     virtual ~AbstractFeedback() = 0;
 
@@ -60,6 +65,10 @@ public:
     bool isEnabled() const;
     Q_SIGNAL void enabledChanged(bool enabled);
 
+    void setDispatchMode(DispatchMode mode);
+    DispatchMode dispatchMode() const;
+    int droppedEffectCount() const;
+
     Q_SLOT void onKeyPressed();
     Q_SLOT void onKeyReleased();
     Q_SLOT void onLayoutChanged();
@@ -68,6 +77,8 @@ public:
     // TODO: add slot for keyboard show feedback
 
 private:
+    friend class AbstractFeedbackPrivate;
+
     virtual void playPressFeedback() = 0;
     virtual void playReleaseFeedback() = 0;
     virtual void playLayoutChangeFeedback() = 0;
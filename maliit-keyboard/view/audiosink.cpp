@@ -0,0 +1,133 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "audiosink.h"
+
+namespace MaliitKeyboard {
+
+//! \class AbstractAudioSink
+//! Output of PcmFeedback's audio thread.
+
+AbstractAudioSink::AbstractAudioSink()
+{}
+
+AbstractAudioSink::~AbstractAudioSink()
+{}
+
+int AbstractAudioSink::latencyUsecs() const
+{
+    return 0;
+}
+
+
+NullAudioSink::NullAudioSink()
+    : AbstractAudioSink()
+    , m_frames_written(0)
+{}
+
+NullAudioSink::~NullAudioSink()
+{}
+
+bool NullAudioSink::start(int sample_rate,
+                          int channels)
+{
+    Q_UNUSED(sample_rate)
+    Q_UNUSED(channels)
+    return true;
+}
+
+void NullAudioSink::stop()
+{}
+
+void NullAudioSink::write(const qint16 *samples,
+                          int frame_count)
+{
+    Q_UNUSED(samples)
+    m_frames_written.fetchAndAddOrdered(frame_count);
+}
+
+//! Returns the number of frames written so far, from any thread.
+int NullAudioSink::framesWritten() const
+{
+    return m_frames_written.load();
+}
+
+
+//! \param file_name File to write raw PCM to. Gets truncated on start.
+FileAudioSink::FileAudioSink(const QString &file_name)
+    : AbstractAudioSink()
+    , m_file(file_name)
+    , m_channels(0)
+    , m_frames_written(0)
+{}
+
+FileAudioSink::~FileAudioSink()
+{}
+
+bool FileAudioSink::start(int sample_rate,
+                          int channels)
+{
+    Q_UNUSED(sample_rate)
+    m_channels = channels;
+
+    if (not m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Could not open file:" << m_file.fileName();
+        return false;
+    }
+
+    return true;
+}
+
+void FileAudioSink::stop()
+{
+    m_file.close();
+}
+
+void FileAudioSink::write(const qint16 *samples,
+                          int frame_count)
+{
+    if (m_file.isOpen()) {
+        m_file.write(reinterpret_cast<const char *>(samples),
+                     frame_count * m_channels * sizeof(qint16));
+        m_file.flush();
+    }
+
+    m_frames_written.fetchAndAddOrdered(frame_count);
+}
+
+//! Returns the number of frames written so far, from any thread.
+int FileAudioSink::framesWritten() const
+{
+    return m_frames_written.load();
+}
+
+} // namespace MaliitKeyboard
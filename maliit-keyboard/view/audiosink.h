@@ -0,0 +1,110 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_AUDIOSINK_H
+#define MALIIT_KEYBOARD_AUDIOSINK_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+//! \brief Destination for mixed PCM audio.
+//!
+//! Sinks are used from the audio thread only. Samples are interleaved,
+//! signed 16 bit, native endian.
+class AbstractAudioSink
+{
+public:
+    explicit AbstractAudioSink();
+    virtual ~AbstractAudioSink() = 0;
+
+    virtual bool start(int sample_rate,
+                       int channels) = 0;
+    virtual void stop() = 0;
+
+    //! Writes given frames. Real devices block until there is room in
+    //! their buffer, which paces the audio thread.
+    virtual void write(const qint16 *samples,
+                       int frame_count) = 0;
+
+    //! Returns the time it takes until a written frame gets audible.
+    virtual int latencyUsecs() const;
+};
+
+//! Discards all audio, for instance when running headless.
+class NullAudioSink
+    : public AbstractAudioSink
+{
+public:
+    explicit NullAudioSink();
+    virtual ~NullAudioSink();
+
+    //! \reimp
+    virtual bool start(int sample_rate,
+                       int channels);
+    virtual void stop();
+    virtual void write(const qint16 *samples,
+                       int frame_count);
+    //! \reimp_end
+
+    int framesWritten() const;
+
+private:
+    QAtomicInt m_frames_written;
+};
+
+//! Appends raw PCM to a file, useful for inspecting mixer output.
+class FileAudioSink
+    : public AbstractAudioSink
+{
+public:
+    explicit FileAudioSink(const QString &file_name);
+    virtual ~FileAudioSink();
+
+    //! \reimp
+    virtual bool start(int sample_rate,
+                       int channels);
+    virtual void stop();
+    virtual void write(const qint16 *samples,
+                       int frame_count);
+    //! \reimp_end
+
+    int framesWritten() const;
+
+private:
+    QFile m_file;
+    int m_channels;
+    QAtomicInt m_frames_written;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_AUDIOSINK_H
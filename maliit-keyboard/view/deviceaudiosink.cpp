@@ -0,0 +1,138 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "deviceaudiosink.h"
+
+#include <QAudioOutput>
+
+namespace MaliitKeyboard {
+
+namespace {
+
+// Device buffer, in frames. At 44.1kHz this is about 12ms.
+const int DeviceBufferFrames = 512;
+// How long to sleep while waiting for room in the device buffer.
+const int WriteRetryUsecs = 500;
+
+} // unnamed namespace
+
+DeviceAudioSink::DeviceAudioSink()
+    : AbstractAudioSink()
+    , m_output()
+    , m_device(0)
+    , m_sample_rate(0)
+    , m_bytes_per_frame(0)
+{}
+
+DeviceAudioSink::~DeviceAudioSink()
+{}
+
+bool DeviceAudioSink::start(int sample_rate,
+                            int channels)
+{
+    QAudioFormat format;
+    format.setSampleRate(sample_rate);
+    format.setChannelCount(channels);
+    format.setSampleSize(16);
+    format.setCodec("audio/pcm");
+    format.setByteOrder(QSysInfo::ByteOrder == QSysInfo::LittleEndian
+                        ? QAudioFormat::LittleEndian : QAudioFormat::BigEndian);
+    format.setSampleType(QAudioFormat::SignedInt);
+
+    const QAudioDeviceInfo info(QAudioDeviceInfo::defaultOutputDevice());
+
+    if (not info.isFormatSupported(format)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Audio format not supported by" << info.deviceName();
+        return false;
+    }
+
+    m_sample_rate = sample_rate;
+    m_bytes_per_frame = channels * sizeof(qint16);
+
+    // Created here, so that the output lives in the audio thread:
+    m_output.reset(new QAudioOutput(info, format));
+    m_output->setBufferSize(DeviceBufferFrames * m_bytes_per_frame);
+    m_device = m_output->start();
+
+    return (m_device != 0);
+}
+
+void DeviceAudioSink::stop()
+{
+    if (m_output) {
+        m_output->stop();
+    }
+
+    m_device = 0;
+    m_output.reset();
+}
+
+void DeviceAudioSink::write(const qint16 *samples,
+                            int frame_count)
+{
+    if (not m_device) {
+        return;
+    }
+
+    const char *data(reinterpret_cast<const char *>(samples));
+    qint64 remaining(frame_count * m_bytes_per_frame);
+
+    while (remaining > 0) {
+        const qint64 free_bytes(qMin<qint64>(m_output->bytesFree(), remaining));
+
+        if (free_bytes <= 0) {
+            QThread::usleep(WriteRetryUsecs);
+            continue;
+        }
+
+        const qint64 written(m_device->write(data, free_bytes));
+
+        if (written < 0) {
+            return;
+        }
+
+        data += written;
+        remaining -= written;
+    }
+}
+
+int DeviceAudioSink::latencyUsecs() const
+{
+    if (not m_output || m_bytes_per_frame == 0 || m_sample_rate == 0) {
+        return 0;
+    }
+
+    const qint64 queued_frames((m_output->bufferSize() - m_output->bytesFree()) / m_bytes_per_frame);
+    return static_cast<int>(queued_frames * 1000000 / m_sample_rate);
+}
+
+} // namespace MaliitKeyboard
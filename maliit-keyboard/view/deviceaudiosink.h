@@ -0,0 +1,70 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_DEVICEAUDIOSINK_H
+#define MALIIT_KEYBOARD_DEVICEAUDIOSINK_H
+
+#include "audiosink.h"
+
+#include <QtCore>
+
+class QAudioOutput;
+
+namespace MaliitKeyboard {
+
+//! Plays audio through the default QtMultimedia output device, using a
+//! small fixed buffer to keep latency low.
+class DeviceAudioSink
+    : public AbstractAudioSink
+{
+public:
+    explicit DeviceAudioSink();
+    virtual ~DeviceAudioSink();
+
+    //! \reimp
+    virtual bool start(int sample_rate,
+                       int channels);
+    virtual void stop();
+    virtual void write(const qint16 *samples,
+                       int frame_count);
+    virtual int latencyUsecs() const;
+    //! \reimp_end
+
+private:
+    QScopedPointer<QAudioOutput> m_output;
+    QIODevice *m_device;
+    int m_sample_rate;
+    int m_bytes_per_frame;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_DEVICEAUDIOSINK_H
@@ -0,0 +1,249 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "imagecache.h"
+
+//! \class MaliitKeyboard::ImageCache
+//! Holds decoded style images, keyed by their file name. Images can be
+//! decoded ahead of time on a worker thread, so that the first keyboard
+//! show after a style profile change does not stall on image decoding.
+//! All methods are thread-safe.
+
+namespace MaliitKeyboard {
+
+namespace {
+
+typedef QHash<QString, QImage> ImageHash;
+
+struct ImageStore
+{
+    mutable QMutex mutex;
+    ImageHash images;
+    int hit_count; //!< Lookups through ImageCache::image() only.
+    int miss_count;
+
+    explicit ImageStore()
+        : mutex()
+        , images()
+        , hit_count(0)
+        , miss_count(0)
+    {}
+};
+
+class PreloadJob
+    : public QRunnable
+{
+private:
+    ImageStore *const m_store;
+    ImageCache *const m_cache;
+    const QString m_directory;
+    const QStringList m_file_names;
+
+public:
+    explicit PreloadJob(ImageStore *store,
+                        ImageCache *cache,
+                        const QString &directory,
+                        const QStringList &file_names)
+        : m_store(store)
+        , m_cache(cache)
+        , m_directory(directory)
+        , m_file_names(file_names)
+    {}
+
+    virtual void run()
+    {
+        Q_FOREACH (const QString &file_name, m_file_names) {
+            const QString path(m_directory + "/" + file_name);
+
+            {
+                QMutexLocker locker(&m_store->mutex);
+
+                if (m_store->images.contains(path)) {
+                    continue;
+                }
+            }
+
+            // Decode without holding the lock:
+            const QImage image(path);
+
+            if (image.isNull()) {
+                qWarning() << __PRETTY_FUNCTION__
+                           << "Could not decode image:" << path;
+                continue;
+            }
+
+            QMutexLocker locker(&m_store->mutex);
+            m_store->images.insert(path, image);
+        }
+
+        QMetaObject::invokeMethod(m_cache, "onPreloadFinished", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_directory));
+    }
+};
+
+} // unnamed namespace
+
+class ImageCachePrivate
+{
+public:
+    ImageStore store;
+    QThreadPool pool;
+
+    explicit ImageCachePrivate()
+        : store()
+        , pool()
+    {
+        // Preload requests are processed in order, one at a time:
+        pool.setMaxThreadCount(1);
+    }
+};
+
+//! @param parent The owner of this instance (optional).
+ImageCache::ImageCache(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new ImageCachePrivate)
+{}
+
+ImageCache::~ImageCache()
+{
+    Q_D(ImageCache);
+    d->pool.waitForDone();
+}
+
+//! \brief Returns the decoded image for the given file name.
+//!
+//! Decodes the image synchronously if it was not preloaded.
+//! \param file_name Absolute file name of the image.
+QImage ImageCache::image(const QString &file_name)
+{
+    Q_D(ImageCache);
+
+    {
+        QMutexLocker locker(&d->store.mutex);
+        const ImageHash::const_iterator it(d->store.images.constFind(file_name));
+
+        if (it != d->store.images.constEnd()) {
+            ++d->store.hit_count;
+            return it.value();
+        }
+
+        ++d->store.miss_count;
+    }
+
+    const QImage image(file_name);
+
+    if (not image.isNull()) {
+        QMutexLocker locker(&d->store.mutex);
+        d->store.images.insert(file_name, image);
+    }
+
+    return image;
+}
+
+//! \brief Returns the number of decoded images.
+int ImageCache::count() const
+{
+    Q_D(const ImageCache);
+    QMutexLocker locker(&d->store.mutex);
+    return d->store.images.count();
+}
+
+//! \brief Returns the number of image() calls served from the cache.
+int ImageCache::hitCount() const
+{
+    Q_D(const ImageCache);
+    QMutexLocker locker(&d->store.mutex);
+    return d->store.hit_count;
+}
+
+//! \brief Returns the number of image() calls that had to decode.
+int ImageCache::missCount() const
+{
+    Q_D(const ImageCache);
+    QMutexLocker locker(&d->store.mutex);
+    return d->store.miss_count;
+}
+
+//! \brief Returns the number of bytes held by decoded images.
+qint64 ImageCache::memoryUsage() const
+{
+    Q_D(const ImageCache);
+    QMutexLocker locker(&d->store.mutex);
+    qint64 usage(0);
+
+    Q_FOREACH (const QImage &image, d->store.images) {
+        usage += image.byteCount();
+    }
+
+    return usage;
+}
+
+//! \brief Drops all decoded images.
+void ImageCache::clear()
+{
+    Q_D(ImageCache);
+    QMutexLocker locker(&d->store.mutex);
+    d->store.images.clear();
+}
+
+//! \brief Decodes images on a worker thread.
+//!
+//! Images from other directories (i.e., previous style profiles) are
+//! dropped. Emits preloaded once all images are decoded.
+//! \param directory The image directory.
+//! \param file_names File names relative to directory.
+void ImageCache::preload(const QString &directory,
+                         const QStringList &file_names)
+{
+    Q_D(ImageCache);
+
+    {
+        QMutexLocker locker(&d->store.mutex);
+        const QString prefix(directory + "/");
+
+        for (ImageHash::iterator it = d->store.images.begin(); it != d->store.images.end();) {
+            if (it.key().startsWith(prefix)) {
+                ++it;
+            } else {
+                it = d->store.images.erase(it);
+            }
+        }
+    }
+
+    d->pool.start(new PreloadJob(&d->store, this, directory, file_names));
+}
+
+void ImageCache::onPreloadFinished(const QString &directory)
+{
+    Q_EMIT preloaded(directory);
+}
+
+} // namespace MaliitKeyboard
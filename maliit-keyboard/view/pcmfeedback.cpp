@@ -0,0 +1,468 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcmfeedback.h"
+#include "audiosink.h"
+
+#include "logic/style.h"
+#include "models/styleattributes.h"
+
+#include <QtEndian>
+
+//! \class MaliitKeyboard::PcmFeedback
+//! Provides a sound feedback backend that decodes the style profile's WAV
+//! files into memory once, in applyProfile(). Effects are mixed on a
+//! dedicated audio thread in small fixed-size periods, so that clicks of
+//! fast typing can overlap instead of cutting each other off. The time
+//! from triggering an effect until it reaches the audio output is
+//! measured, see lastLatencyUsecs().
+//!
+//! Triggering an effect is thread-safe, so effects get dispatched from
+//! the AbstractFeedback worker thread.
+
+namespace MaliitKeyboard {
+
+namespace {
+
+enum EffectIndex
+{
+    KeyPressEffect,
+    KeyReleaseEffect,
+    LayoutChangeEffect,
+    KeyboardHideEffect,
+
+    EffectsCount
+};
+
+const int SampleRate = 44100;
+const int Channels = 2;
+// About 6ms per period at 44.1kHz.
+const int PeriodFrames = 256;
+// Oldest voices get dropped if more effects overlap.
+const int MaxVoices = 8;
+
+typedef QVector<qint16> Clip;
+
+quint16 readLe16(const char *data)
+{
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar *>(data));
+}
+
+quint32 readLe32(const char *data)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data));
+}
+
+//! Decodes 8 or 16 bit PCM WAV data into interleaved stereo samples at
+//! the mixer's sample rate.
+bool decodeWav(const QByteArray &data,
+               Clip *clip)
+{
+    if (data.size() < 12 || not data.startsWith("RIFF") || data.mid(8, 4) != "WAVE") {
+        return false;
+    }
+
+    const char *const begin(data.constData());
+    int format(0);
+    int channels(0);
+    int rate(0);
+    int bits(0);
+    const char *pcm(0);
+    int pcm_size(0);
+
+    for (int pos = 12; pos + 8 <= data.size();) {
+        const QByteArray id(data.mid(pos, 4));
+        const int body(pos + 8);
+        const int chunk_size(qMin<qint64>(readLe32(begin + pos + 4), data.size() - body));
+
+        if (id == "fmt " && chunk_size >= 16) {
+            format = readLe16(begin + body);
+            channels = readLe16(begin + body + 2);
+            rate = readLe32(begin + body + 4);
+            bits = readLe16(begin + body + 14);
+        } else if (id == "data") {
+            pcm = begin + body;
+            pcm_size = chunk_size;
+        }
+
+        // Chunks are padded to even sizes:
+        pos = body + chunk_size + (chunk_size & 1);
+    }
+
+    if (format != 1 || (channels != 1 && channels != 2)
+        || (bits != 8 && bits != 16) || rate <= 0 || not pcm) {
+        return false;
+    }
+
+    const int bytes_per_sample(bits / 8);
+    const qint64 in_frames(pcm_size / (bytes_per_sample * channels));
+    const qint64 out_frames(in_frames * SampleRate / rate);
+
+    clip->resize(out_frames * Channels);
+    qint16 *out(clip->data());
+
+    for (qint64 frame = 0; frame < out_frames; ++frame) {
+        // Nearest neighbour resampling is good enough for clicks:
+        const qint64 source_frame(frame * rate / SampleRate);
+
+        for (int channel = 0; channel < Channels; ++channel) {
+            const int source_channel(qMin(channel, channels - 1));
+            const char *sample(pcm + (source_frame * channels + source_channel) * bytes_per_sample);
+
+            *out++ = (bits == 16 ? static_cast<qint16>(readLe16(sample))
+                                 : static_cast<qint16>((static_cast<uchar>(*sample) - 128) << 8));
+        }
+    }
+
+    return true;
+}
+
+struct Voice
+{
+    Clip clip;
+    int position;
+    qint64 trigger_time;
+    bool started;
+};
+
+class PcmMixer
+    : public QThread
+{
+private:
+    const QScopedPointer<AbstractAudioSink> m_sink;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    Clip m_clips[EffectsCount];
+    QVector<Voice> m_pending;
+    bool m_quit;
+    QElapsedTimer m_clock;
+
+public:
+    QAtomicInt played;
+    QAtomicInt active;
+    QAtomicInt last_latency;
+    QAtomicInt max_latency;
+
+    explicit PcmMixer(AbstractAudioSink *sink)
+        : QThread()
+        , m_sink(sink)
+        , m_mutex()
+        , m_wake()
+        , m_pending()
+        , m_quit(false)
+        , m_clock()
+        , played(0)
+        , active(0)
+        , last_latency(0)
+        , max_latency(0)
+    {
+        m_clock.start();
+    }
+
+    virtual ~PcmMixer()
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_quit = true;
+            m_wake.wakeOne();
+        }
+
+        wait();
+    }
+
+    void setClip(EffectIndex index,
+                 const Clip &clip)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_clips[index] = clip;
+    }
+
+    void trigger(EffectIndex index)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (m_clips[index].isEmpty()) {
+            return;
+        }
+
+        Voice voice;
+        voice.clip = m_clips[index]; // Implicitly shared, no copy.
+        voice.position = 0;
+        voice.trigger_time = m_clock.nsecsElapsed();
+        voice.started = false;
+
+        m_pending.append(voice);
+
+        if (m_pending.size() > MaxVoices) {
+            m_pending.remove(0);
+        }
+
+        played.ref();
+        m_wake.wakeOne();
+    }
+
+protected:
+    virtual void run()
+    {
+        if (not m_sink->start(SampleRate, Channels)) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Could not start audio sink, no sound feedback available.";
+            return;
+        }
+
+        QVector<Voice> voices;
+        QVector<qint32> mix(PeriodFrames * Channels);
+        QVector<qint16> out(PeriodFrames * Channels);
+
+        Q_FOREVER {
+            {
+                QMutexLocker locker(&m_mutex);
+
+                while (voices.isEmpty() && m_pending.isEmpty() && not m_quit) {
+                    m_wake.wait(&m_mutex);
+                }
+
+                if (m_quit) {
+                    break;
+                }
+
+                voices += m_pending;
+                m_pending.clear();
+            }
+
+            while (voices.size() > MaxVoices) {
+                voices.remove(0);
+            }
+
+            active.store(voices.size());
+            mix.fill(0);
+
+            const int sink_latency(m_sink->latencyUsecs());
+
+            for (int index = 0; index < voices.size();) {
+                Voice &voice(voices[index]);
+
+                if (not voice.started) {
+                    const int latency((m_clock.nsecsElapsed() - voice.trigger_time) / 1000
+                                      + sink_latency);
+                    last_latency.store(latency);
+
+                    for (int max = max_latency.load(); latency > max; max = max_latency.load()) {
+                        if (max_latency.testAndSetOrdered(max, latency)) {
+                            break;
+                        }
+                    }
+
+                    voice.started = true;
+                }
+
+                const int count(qMin(mix.size(), voice.clip.size() - voice.position));
+                const qint16 *source(voice.clip.constData() + voice.position);
+                qint32 *target(mix.data());
+
+                for (int sample = 0; sample < count; ++sample) {
+                    target[sample] += source[sample];
+                }
+
+                voice.position += count;
+
+                if (voice.position >= voice.clip.size()) {
+                    voices.remove(index);
+                } else {
+                    ++index;
+                }
+            }
+
+            for (int sample = 0; sample < out.size(); ++sample) {
+                out[sample] = static_cast<qint16>(qBound<qint32>(-32768, mix.at(sample), 32767));
+            }
+
+            m_sink->write(out.constData(), PeriodFrames);
+            active.store(voices.size());
+        }
+
+        m_sink->stop();
+    }
+};
+
+} // unnamed namespace
+
+class PcmFeedbackPrivate
+{
+public:
+    PcmMixer mixer;
+    SharedStyle style;
+
+    explicit PcmFeedbackPrivate(AbstractAudioSink *sink)
+        : mixer(sink ? sink : new NullAudioSink)
+        , style()
+    {
+        mixer.start(QThread::TimeCriticalPriority);
+    }
+
+    Clip loadClip(const QString &file_name)
+    {
+        QFile file(file_name);
+        Clip clip;
+
+        if (not file.open(QIODevice::ReadOnly)) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Could not open sound file:" << file_name;
+            return clip;
+        }
+
+        if (not decodeWav(file.readAll(), &clip)) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Unsupported sound file, expected PCM WAV:" << file_name;
+        }
+
+        return clip;
+    }
+};
+
+//! @param sink The audio output, owned by this instance.
+//! @param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+PcmFeedback::PcmFeedback(AbstractAudioSink *sink,
+                         QObject *parent)
+    : AbstractFeedback(parent)
+    , d_ptr(new PcmFeedbackPrivate(sink))
+{
+    setEnabled(true);
+    setDispatchMode(DispatchFromWorker);
+}
+
+PcmFeedback::~PcmFeedback()
+{
+    setDispatchMode(DispatchDirectly);
+}
+
+void PcmFeedback::setStyle(const SharedStyle &style)
+{
+    Q_D(PcmFeedback);
+    if (d->style != style) {
+        if (d->style) {
+            disconnect(d->style.data(), SIGNAL(profileChanged()),
+                       this,            SLOT(applyProfile()));
+        }
+        d->style = style;
+
+        if (d->style.isNull()) {
+            return;
+        }
+
+        connect(d->style.data(), SIGNAL(profileChanged()),
+                this,            SLOT(applyProfile()));
+        applyProfile();
+    }
+}
+
+//! Returns the number of effects triggered so far.
+int PcmFeedback::playedEffectCount() const
+{
+    Q_D(const PcmFeedback);
+    return d->mixer.played.load();
+}
+
+//! Returns the number of effects currently being mixed.
+int PcmFeedback::activeVoiceCount() const
+{
+    Q_D(const PcmFeedback);
+    return d->mixer.active.load();
+}
+
+//! Returns the press-to-audio latency of the most recent effect, in
+//! microseconds.
+int PcmFeedback::lastLatencyUsecs() const
+{
+    Q_D(const PcmFeedback);
+    return d->mixer.last_latency.load();
+}
+
+//! Returns the highest press-to-audio latency seen so far, in
+//! microseconds.
+int PcmFeedback::maxLatencyUsecs() const
+{
+    Q_D(const PcmFeedback);
+    return d->mixer.max_latency.load();
+}
+
+void PcmFeedback::applyProfile()
+{
+    Q_D(PcmFeedback);
+    const QString path(d->style->directory(Style::Sounds));
+    const StyleAttributes *attributes(d->style->attributes());
+    const QByteArray files[EffectsCount] = {
+        attributes->keyPressSound(),
+        attributes->keyReleaseSound(),
+        attributes->layoutChangeSound(),
+        attributes->keyboardHideSound()
+    };
+
+    // Profiles commonly use the same file for several effects:
+    QHash<QByteArray, Clip> decoded;
+
+    for (int index = 0; index < EffectsCount; ++index) {
+        const QByteArray &file(files[index]);
+
+        if (not file.isEmpty() && not decoded.contains(file)) {
+            decoded.insert(file, d->loadClip(path + "/" + file));
+        }
+
+        d->mixer.setClip(static_cast<EffectIndex>(index), decoded.value(file));
+    }
+}
+
+void PcmFeedback::playPressFeedback()
+{
+    Q_D(PcmFeedback);
+    d->mixer.trigger(KeyPressEffect);
+}
+
+void PcmFeedback::playReleaseFeedback()
+{
+    Q_D(PcmFeedback);
+    d->mixer.trigger(KeyReleaseEffect);
+}
+
+void PcmFeedback::playLayoutChangeFeedback()
+{
+    Q_D(PcmFeedback);
+    d->mixer.trigger(LayoutChangeEffect);
+}
+
+void PcmFeedback::playKeyboardHideFeedback()
+{
+    Q_D(PcmFeedback);
+    d->mixer.trigger(KeyboardHideEffect);
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,76 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_PCMFEEDBACK_H
+#define MALIIT_KEYBOARD_PCMFEEDBACK_H
+
+#include "abstractfeedback.h"
+
+namespace MaliitKeyboard {
+
+class AbstractAudioSink;
+class PcmFeedbackPrivate;
+
+class PcmFeedback
+    : public AbstractFeedback
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(PcmFeedback)
+    Q_DECLARE_PRIVATE(PcmFeedback)
+
+public:
+    //! \param sink Audio output, ownership is transferred. Uses a
+    //!             NullAudioSink if 0.
+    explicit PcmFeedback(AbstractAudioSink *sink = 0,
+                         QObject *parent = 0);
+    virtual ~PcmFeedback();
+
+    virtual void setStyle(const SharedStyle &style);
+
+    int playedEffectCount() const;
+    int activeVoiceCount() const;
+    int lastLatencyUsecs() const;
+    int maxLatencyUsecs() const;
+
+private:
+    const QScopedPointer<PcmFeedbackPrivate> d_ptr;
+
+    virtual void playPressFeedback();
+    virtual void playReleaseFeedback();
+    virtual void playLayoutChangeFeedback();
+    virtual void playKeyboardHideFeedback();
+
+    Q_SLOT void applyProfile();
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_PCMFEEDBACK_H
@@ -0,0 +1,101 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_SPSCQUEUE_H
+#define MALIIT_KEYBOARD_SPSCQUEUE_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+//! \brief Bounded, lock-free queue for exactly one producer and one
+//! consumer thread.
+//!
+//! push() must only be called from the producer thread, pop() only from
+//! the consumer thread. Holds up to Capacity - 1 items, as one slot is
+//! kept free to tell a full queue from an empty one. T needs to be cheap
+//! to copy; items are copied into a fixed array and are never allocated.
+template <typename T, int Capacity>
+class SpscQueue
+{
+    Q_DISABLE_COPY(SpscQueue)
+
+public:
+    explicit SpscQueue()
+        : m_head(0)
+        , m_tail(0)
+    {}
+
+    //! Appends item, returns false if the queue is full.
+    bool push(const T &item)
+    {
+        const int tail(m_tail.load());
+        const int next((tail + 1) % Capacity);
+
+        if (next == m_head.loadAcquire()) {
+            return false;
+        }
+
+        m_items[tail] = item;
+        m_tail.storeRelease(next);
+
+        return true;
+    }
+
+    //! Takes the oldest item, returns false if the queue is empty.
+    bool pop(T *item)
+    {
+        const int head(m_head.load());
+
+        if (head == m_tail.loadAcquire()) {
+            return false;
+        }
+
+        *item = m_items[head];
+        m_head.storeRelease((head + 1) % Capacity);
+
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return (m_head.loadAcquire() == m_tail.loadAcquire());
+    }
+
+private:
+    T m_items[Capacity];
+    QAtomicInt m_head; //!< Next item to pop, only written by the consumer.
+    QAtomicInt m_tail; //!< Next free slot, only written by the producer.
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_SPSCQUEUE_H
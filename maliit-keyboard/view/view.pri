@@ -5,3 +5,7 @@ enable-qt-mobility {
     MOBILITY += feedback
     DEFINES += HAVE_QT_MOBILITY
 }
+
+enable-pcm-feedback {
+    DEFINES += HAVE_PCM_FEEDBACK
+}
@@ -20,11 +20,18 @@ contains(QT_MAJOR_VERSION, 4) {
 HEADERS += \
     abstractfeedback.h \
     nullfeedback.h \
+    audiosink.h \
+    pcmfeedback.h \
+    spscqueue.h \
+    imagecache.h \
     surface.h \
 
 SOURCES += \
     abstractfeedback.cpp \
     nullfeedback.cpp \
+    audiosink.cpp \
+    pcmfeedback.cpp \
+    imagecache.cpp \
     surface.cpp \
 
 enable-qt-mobility {
@@ -32,6 +39,12 @@ enable-qt-mobility {
     SOURCES += soundfeedback.cpp
 }
 
+enable-pcm-feedback {
+    HEADERS += deviceaudiosink.h
+    SOURCES += deviceaudiosink.cpp
+    QT += multimedia
+}
+
 disable-background-translucency {
     DEFINES += DISABLE_TRANSLUCENT_BACKGROUND_HINT
 }
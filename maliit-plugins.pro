@@ -14,6 +14,8 @@ include(config.pri)
         \\n\\t enable-hunspell: Use hunspell for error correction (maliit-keyboard-plugin only) \
         \\n\\t disable-preedit: Always commit characters and never use preedit (maliit-keyboard-plugin only) \
         \\n\\t enable-qt-mobility: Enable use of QtMobility (enables sound and haptic feedback) \
+        \\n\\t enable-pcm-feedback: Play sound feedback from memory through QtMultimedia, with low latency \
+        \\n\\t enable-tracing: Compile in tracepoints for keystroke latency tracing (maliit-keyboard-plugin only) \
         \\n\\t notests: Do not attempt to build tests \
         \\n\\t nodoc: Do not build documentation \
         \\n\\t disable-maliit-keyboard: Do not build the C++ reference keyboard (Maliit Keyboard) \
@@ -73,6 +75,14 @@ enable-qt-mobility {
     COVERAGE_CONFIG_STRING += CONFIG+=enable-qt-mobility
 }
 
+enable-pcm-feedback {
+    COVERAGE_CONFIG_STRING += CONFIG+=enable-pcm-feedback
+}
+
+enable-tracing {
+    COVERAGE_CONFIG_STRING += CONFIG+=enable-tracing
+}
+
 COVERAGE_DIR = coverage-build
 
 QMAKE_EXTRA_TARGETS += coverage